@@ -0,0 +1,135 @@
+#include "Frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+// objects per SSE register
+const size_t LANES = 4;
+
+
+size_t CullBounds::add(glm::vec3 centre, float radius, glm::vec3 halfExtent) {
+    size_t index = count++;
+    // whole batches, the padding never counted as visible
+    size_t padded = (count + LANES - 1) / LANES * LANES;
+    for (std::vector<float>* values : { &x, &y, &z, &this->radius, &extentX, &extentY, &extentZ })
+        values->resize(padded, 0.0f);
+    set(index, centre, radius, halfExtent);
+    return index;
+}
+
+void CullBounds::set(size_t index, glm::vec3 centre, float radius, glm::vec3 halfExtent) {
+    x[index] = centre.x;
+    y[index] = centre.y;
+    z[index] = centre.z;
+    this->radius[index] = radius;
+    extentX[index] = halfExtent.x;
+    extentY[index] = halfExtent.y;
+    extentZ[index] = halfExtent.z;
+}
+
+void CullBounds::clear() {
+    count = 0;
+    for (std::vector<float>* values : { &x, &y, &z, &radius, &extentX, &extentY, &extentZ })
+        values->clear();
+}
+
+
+Frustum::Frustum() : Frustum(glm::mat4(1.0f)) {}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    update(viewProjection);
+}
+
+void Frustum::update(const glm::mat4& viewProjection) {
+    // a point is inside when -w <= x, y, z <= w after the transform, each of those being a row of
+    // the matrix dotted with the point. glm is column major, m[column][row]
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    planes[0] = row[3] + row[0];
+    planes[1] = row[3] - row[0];
+    planes[2] = row[3] + row[1];
+    planes[3] = row[3] - row[1];
+    planes[4] = row[3] + row[2];
+    planes[5] = row[3] - row[2];
+    // unit normals, so a plane gives real distances to compare radii with
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+size_t Frustum::cullSpheres(const CullBounds& bounds, std::vector<unsigned char>& visible) const {
+    return test(bounds, visible, true, false);
+}
+
+size_t Frustum::cullBoxes(const CullBounds& bounds, std::vector<unsigned char>& visible) const {
+    return test(bounds, visible, false, true);
+}
+
+size_t Frustum::cull(const CullBounds& bounds, std::vector<unsigned char>& visible) const {
+    return test(bounds, visible, true, true);
+}
+
+size_t Frustum::test(const CullBounds& bounds, std::vector<unsigned char>& visible, bool spheres, bool boxes) const {
+    __m128 normalX[6], normalY[6], normalZ[6], distance[6];
+    __m128 absX[6], absY[6], absZ[6];
+    for (int p = 0; p < 6; p++) {
+        normalX[p] = _mm_set1_ps(planes[p].x);
+        normalY[p] = _mm_set1_ps(planes[p].y);
+        normalZ[p] = _mm_set1_ps(planes[p].z);
+        distance[p] = _mm_set1_ps(planes[p].w);
+        absX[p] = _mm_set1_ps(std::fabs(planes[p].x));
+        absY[p] = _mm_set1_ps(std::fabs(planes[p].y));
+        absZ[p] = _mm_set1_ps(std::fabs(planes[p].z));
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    visible.assign(bounds.count, 0);
+    size_t inside = 0;
+    for (size_t i = 0; i < bounds.count; i += LANES) {
+        __m128 x = _mm_loadu_ps(&bounds.x[i]);
+        __m128 y = _mm_loadu_ps(&bounds.y[i]);
+        __m128 z = _mm_loadu_ps(&bounds.z[i]);
+        // a bit per object, cleared once it's behind a plane
+        int mask = 0xF;
+
+        if (spheres) {
+            __m128 reach = _mm_sub_ps(zero, _mm_loadu_ps(&bounds.radius[i]));
+            for (int p = 0; p < 6 && mask != 0; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], x), _mm_mul_ps(normalY[p], y)),
+                                      _mm_add_ps(_mm_mul_ps(normalZ[p], z), distance[p]));
+                mask &= _mm_movemask_ps(_mm_cmpge_ps(d, reach));
+            }
+        }
+        if (boxes && mask != 0) {
+            __m128 extentX = _mm_loadu_ps(&bounds.extentX[i]);
+            __m128 extentY = _mm_loadu_ps(&bounds.extentY[i]);
+            __m128 extentZ = _mm_loadu_ps(&bounds.extentZ[i]);
+            for (int p = 0; p < 6 && mask != 0; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], x), _mm_mul_ps(normalY[p], y)),
+                                      _mm_add_ps(_mm_mul_ps(normalZ[p], z), distance[p]));
+                // how far the box reaches along the normal from its centre
+                __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], extentX), _mm_mul_ps(absY[p], extentY)),
+                                          _mm_mul_ps(absZ[p], extentZ));
+                mask &= _mm_movemask_ps(_mm_cmpge_ps(d, _mm_sub_ps(zero, reach)));
+            }
+        }
+
+        size_t lanes = std::min(LANES, bounds.count - i);
+        for (size_t lane = 0; lane < lanes; lane++) {
+            visible[i + lane] = (mask >> lane) & 1;
+            inside += visible[i + lane];
+        }
+    }
+    return inside;
+}
+
+
+glm::vec3 transformedExtent(const glm::mat4& transform, glm::vec3 halfExtent) {
+    glm::vec3 extent(0.0f);
+    for (int column = 0; column < 3; column++)
+        for (int row = 0; row < 3; row++)
+            extent[row] += std::fabs(transform[column][row]) * halfExtent[column];
+    return extent;
+}
@@ -0,0 +1,67 @@
+#include "BarColumns.h"
+
+#include <algorithm>
+
+BarColumns::BarColumns(const std::vector<int>& values) : tree(values) {
+    resize(values.size());
+}
+
+void BarColumns::resize(size_t pixels) {
+    size_t count = std::max<size_t>(1, std::min(pixels, tree.size()));
+    if (count == bars.size())
+        return;
+
+    bars.assign(count, BarColumn());
+    isDirty.assign(count, true);
+    dirty.clear();
+    for (size_t column = 0; column < count; column++)
+        dirty.push_back(column);
+}
+
+void BarColumns::changed(size_t i, unsigned int thread) {
+    tree.changed(i, thread);
+    size_t column = columnOf(i);
+    if (!isDirty[column]) {
+        isDirty[column] = true;
+        dirty.push_back(column);
+    }
+}
+
+bool BarColumns::update() {
+    if (dirty.empty() || tree.size() == 0)
+        return false;
+
+    for (size_t column : dirty) {
+        size_t lo = columnStart(column), hi = columnStart(column + 1);
+        SegmentNode node = tree.query(lo, hi);
+        bars[column] = { (float) node.min, (float) node.sum / (hi - lo), (float) node.max, (float) node.thread, bars[column].heat };
+        isDirty[column] = false;
+    }
+    dirty.clear();
+    return true;
+}
+
+void BarColumns::heat(size_t i, float amount) {
+    bars[columnOf(i)].heat += amount;
+}
+
+bool BarColumns::cool(float factor) {
+    bool warm = false;
+    for (BarColumn& bar : bars) {
+        if (bar.heat == 0.0f)
+            continue;
+        // snap to zero so idle frames stop re-uploading the columns
+        bar.heat = bar.heat * factor < 0.01f ? 0.0f : bar.heat * factor;
+        warm = true;
+    }
+    return warm;
+}
+
+size_t BarColumns::columnStart(size_t column) const {
+    return (size_t) ((uint64_t) column * tree.size() / bars.size());
+}
+
+// the column c with columnStart(c) <= i < columnStart(c + 1)
+size_t BarColumns::columnOf(size_t i) const {
+    return (size_t) (((uint64_t) i + 1) * bars.size() - 1) / tree.size();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "SegmentTree.h"
+
+// Per-instance data of one drawn column
+struct BarColumn {
+    float low;     // smallest value in the column
+    float mean;
+    float high;    // largest value in the column
+    float thread;  // thread that last changed the column
+    float heat;    // recent cache misses in the column, see BarColumns::heat
+};
+
+// Folds the array into at most one column per pixel. Changes go into the segment tree and mark
+// their column dirty, update() only re-queries dirty columns, so a frame costs
+// O(width + changes * log n) no matter how large the array is.
+class BarColumns {
+public:
+    // values must outlive the columns, they are read back whenever a column is refreshed
+    BarColumns(const std::vector<int>& values);
+
+    // re-lays the columns for a framebuffer `pixels` wide
+    void resize(size_t pixels);
+
+    // values[i] was changed by `thread`
+    void changed(size_t i, unsigned int thread);
+
+    // refreshes the dirty columns. Returns false if nothing changed since the last call
+    bool update();
+
+    // adds `amount` to the heat of the column holding values[i]
+    void heat(size_t i, float amount);
+    // scales every column's heat by `factor`. Returns false if all columns were already cold
+    bool cool(float factor);
+
+    const std::vector<BarColumn>& columns() const { return bars; }
+    size_t count() const { return bars.size(); }
+
+private:
+    SegmentTree tree;
+    std::vector<BarColumn> bars;
+    std::vector<size_t> dirty;
+    std::vector<bool> isDirty;
+
+    // first element of a column
+    size_t columnStart(size_t column) const;
+    size_t columnOf(size_t i) const;
+};
@@ -0,0 +1,150 @@
+#include "CacheSimulator.h"
+
+#include <cstdlib>
+#include <sstream>
+
+CacheLevel::CacheLevel(const CacheConfig& config) {
+    ways = config.ways;
+    sets = config.sizeBytes / (config.lineBytes * config.ways);
+    if (sets == 0)
+        sets = 1;
+    lineShift = 0;
+    while (((size_t) 1 << lineShift) < config.lineBytes)
+        lineShift++;
+    tags.assign(sets * ways, 0);
+    lastUse.assign(sets * ways, 0);
+    dirty.assign(sets * ways, false);
+}
+
+bool CacheLevel::access(uint64_t address, bool write) {
+    uint64_t line = address >> lineShift;
+    size_t first = (size_t) (line % sets) * ways;
+    clock++;
+
+    size_t victim = first;
+    for (size_t way = first; way < first + ways; way++) {
+        if (tags[way] == line + 1) {
+            counters.hits++;
+            lastUse[way] = clock;
+            dirty[way] = dirty[way] || write;
+            return true;
+        }
+        if (lastUse[way] < lastUse[victim])
+            victim = way;
+    }
+
+    counters.misses++;
+    if (tags[victim] != 0) {
+        counters.evictions++;
+        if (dirty[victim])
+            counters.writebacks++;
+    }
+    tags[victim] = line + 1;
+    lastUse[victim] = clock;
+    dirty[victim] = write;
+    return false;
+}
+
+
+CacheSimulator::CacheSimulator(const std::vector<CacheConfig>& levels) : configs(levels), shared(levels.back()) {
+}
+
+void CacheSimulator::record(const SortEvent& event) {
+    std::lock_guard<std::mutex> guard(lock);
+    switch (event.type) {
+    case EVENT_READ:
+        cost = access(event.thread, arrayAddress(event.a), false);
+        break;
+    case EVENT_COMPARE:
+        cost = access(event.thread, arrayAddress(event.a), false) + access(event.thread, arrayAddress(event.b), false);
+        break;
+    case EVENT_SWAP:
+        cost = access(event.thread, arrayAddress(event.a), false) + access(event.thread, arrayAddress(event.b), false);
+        cost += access(event.thread, arrayAddress(event.a), true) + access(event.thread, arrayAddress(event.b), true);
+        break;
+    case EVENT_WRITE:
+        cost = access(event.thread, arrayAddress(event.a), true);
+        break;
+    case EVENT_COMPARE_VALUES:
+        cost = 0;
+        break;
+    case EVENT_SCRATCH_READ:
+        cost = access(event.thread, scratchAddress(event.b, event.a), false);
+        break;
+    case EVENT_SCRATCH_WRITE:
+        cost = access(event.thread, scratchAddress(event.b, event.a), true);
+        break;
+    }
+}
+
+size_t CacheSimulator::access(unsigned int thread, uint64_t address, bool write) {
+    if (thread >= privateLevels.size()) {
+        std::vector<CacheLevel> levels;
+        for (size_t level = 0; level + 1 < configs.size(); level++)
+            levels.emplace_back(configs[level]);
+        privateLevels.resize(thread + 1, levels);
+    }
+
+    std::vector<CacheLevel>& own = privateLevels[thread];
+    for (size_t level = 0; level < own.size(); level++) {
+        if (own[level].access(address, write))
+            return level;
+    }
+    return shared.access(address, write) ? own.size() : configs.size();
+}
+
+CacheCounters CacheSimulator::counters(size_t level) const {
+    if (level + 1 == configs.size())
+        return shared.counters;
+
+    CacheCounters total;
+    for (const std::vector<CacheLevel>& own : privateLevels) {
+        total.hits += own[level].counters.hits;
+        total.misses += own[level].counters.misses;
+        total.evictions += own[level].counters.evictions;
+        total.writebacks += own[level].counters.writebacks;
+    }
+    return total;
+}
+
+std::vector<CacheConfig> CacheSimulator::defaultLevels() {
+    return {
+        { "L1",  32 << 10, 8,  64 },
+        { "L2",  1 << 20,  16, 64 },
+        { "LLC", 8 << 20,  16, 64 },
+    };
+}
+
+// "32K", "1M" or plain bytes
+static size_t parseBytes(const std::string& text) {
+    char* end = nullptr;
+    size_t value = (size_t) std::strtoull(text.c_str(), &end, 10);
+    if (*end == 'K' || *end == 'k')
+        value <<= 10;
+    else if (*end == 'M' || *end == 'm')
+        value <<= 20;
+    return value;
+}
+
+bool CacheSimulator::parseLevels(const char* spec, std::vector<CacheConfig>* levels) {
+    levels->clear();
+    std::stringstream specStream(spec);
+    std::string level;
+    while (std::getline(specStream, level, ',')) {
+        std::vector<std::string> fields;
+        std::stringstream levelStream(level);
+        std::string field;
+        while (std::getline(levelStream, field, ':'))
+            fields.push_back(field);
+        if (fields.size() < 3 || fields.size() > 4)
+            return false;
+
+        CacheConfig config = { fields[0], parseBytes(fields[1]), parseBytes(fields[2]), 64 };
+        if (fields.size() == 4)
+            config.lineBytes = parseBytes(fields[3]);
+        if (config.sizeBytes == 0 || config.ways == 0 || config.lineBytes == 0)
+            return false;
+        levels->push_back(config);
+    }
+    return !levels->empty();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Sort.h"
+
+struct CacheConfig {
+    std::string name;
+    size_t sizeBytes;
+    size_t ways;
+    size_t lineBytes;
+};
+
+struct CacheCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;   // valid lines replaced
+    uint64_t writebacks = 0;  // ... that were dirty
+
+    uint64_t accesses() const { return hits + misses; }
+};
+
+// One set-associative, write-allocate, LRU level
+class CacheLevel {
+public:
+    CacheCounters counters;
+
+    CacheLevel(const CacheConfig& config);
+
+    // looks up (and on a miss fills) the line holding `address`. Returns true on a hit
+    bool access(uint64_t address, bool write);
+
+private:
+    size_t sets;
+    size_t ways;
+    unsigned int lineShift;
+    uint64_t clock = 0;
+    std::vector<uint64_t> tags;     // sets * ways, line address + 1 (0 = empty)
+    std::vector<uint64_t> lastUse;
+    std::vector<bool> dirty;
+};
+
+
+// Feeds every array and scratch buffer access a sort makes into a cache hierarchy. All levels but
+// the last are private to each sorting thread, the last is shared. Addresses are element index *
+// sizeof(int) from a line aligned array, and each scratch buffer gets its own line aligned region
+// past it (SCRATCH_REGION_BYTES apart).
+// Can be a SortView's recorder (thread safe) or be fed replayed events by the visualizer.
+class CacheSimulator : public SortRecorder {
+public:
+    CacheSimulator(const std::vector<CacheConfig>& levels = defaultLevels());
+
+    void record(const SortEvent& event) override;
+
+    // Levels missed by the accesses of the last recorded event, an access that goes all the
+    // way to memory counts levels().size(). Only meaningful when one thread is recording
+    size_t lastCost() const { return cost; }
+
+    const std::vector<CacheConfig>& levels() const { return configs; }
+    // counters of one level summed over every thread
+    CacheCounters counters(size_t level) const;
+
+    // 32K 8-way L1, 1M 16-way L2, 8M 16-way LLC, 64 byte lines
+    static std::vector<CacheConfig> defaultLevels();
+    // "L1:32K:8,L2:1M:16,LLC:8M:16[:line]". Returns false if the spec can't be parsed
+    static bool parseLevels(const char* spec, std::vector<CacheConfig>* levels);
+
+private:
+    std::vector<CacheConfig> configs;
+    std::vector<std::vector<CacheLevel>> privateLevels;  // [thread][level]
+    CacheLevel shared;                                    // the last level
+    std::mutex lock;
+    size_t cost = 0;
+
+    // room for 2^32 ints, the most an event can index, per buffer
+    static const uint64_t SCRATCH_REGION_BYTES = (uint64_t) 1 << 34;
+
+    // returns how many levels were missed
+    size_t access(unsigned int thread, uint64_t address, bool write);
+    static uint64_t arrayAddress(uint32_t index) { return (uint64_t) index * sizeof(int); }
+    static uint64_t scratchAddress(uint32_t buffer, uint32_t index) {
+        return (buffer + 1) * SCRATCH_REGION_BYTES + (uint64_t) index * sizeof(int);
+    }
+};
@@ -0,0 +1,104 @@
+#include "Dataset.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+// slices smaller than this aren't worth a thread
+const size_t MIN_SLICE = 1 << 16;
+
+const int FEW_UNIQUE_VALUES = 8;
+const size_t SAWTOOTH_TEETH = 8;
+
+
+const char* datasetName(Dataset_Type type) {
+    switch (type) {
+    case DATASET_RANDOM:     return "random";
+    case DATASET_SORTED:     return "sorted";
+    case DATASET_REVERSED:   return "reversed";
+    case DATASET_SAWTOOTH:   return "sawtooth";
+    case DATASET_FEW_UNIQUE: return "few-unique";
+    }
+    return "unknown";
+}
+
+bool parseDatasetType(const char* name, Dataset_Type* type) {
+    const Dataset_Type all[] = { DATASET_RANDOM, DATASET_SORTED, DATASET_REVERSED, DATASET_SAWTOOTH, DATASET_FEW_UNIQUE };
+    for (Dataset_Type t : all) {
+        if (strcmp(datasetName(t), name) == 0) {
+            *type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t randomAt(uint64_t seed, uint64_t n) {
+    // splitmix64 finaliser over a Weyl sequence
+    uint64_t z = seed + (n + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+void fillDataset(Dataset_Type type, uint64_t size, uint64_t seed, uint64_t begin, int* out, size_t count) {
+    uint64_t tooth = std::max<uint64_t>(1, size / SAWTOOTH_TEETH);
+    // values stay in 1 .. INT_MAX. Past INT_MAX elements the ordered shapes repeat each value
+    // `step` times, so they keep their order instead of wrapping around
+    uint64_t range = std::max<uint64_t>(1, std::min<uint64_t>(size, INT_MAX));
+    uint64_t step = std::max<uint64_t>(1, (size + INT_MAX - 1) / INT_MAX);
+    uint64_t spacing = std::max<uint64_t>(1, range / FEW_UNIQUE_VALUES);
+
+    for (size_t k = 0; k < count; k++) {
+        uint64_t i = begin + k;
+        uint64_t value = 0;
+        switch (type) {
+        case DATASET_RANDOM:
+            value = randomAt(seed, i) % range + 1;
+            break;
+        case DATASET_SORTED:
+            value = i / step + 1;
+            break;
+        case DATASET_REVERSED:
+            value = (size - 1 - i) / step + 1;
+            break;
+        case DATASET_SAWTOOTH:
+            value = (i % tooth) / step + 1;
+            break;
+        case DATASET_FEW_UNIQUE:
+            value = (randomAt(seed, i) % FEW_UNIQUE_VALUES + 1) * spacing;
+            break;
+        }
+        out[k] = (int) value;
+    }
+}
+
+static void fillSlice(std::vector<int>& data, Dataset_Type type, uint64_t seed, size_t begin, size_t end) {
+    fillDataset(type, data.size(), seed, begin, data.data() + begin, end - begin);
+}
+
+std::vector<int> generateDataset(Dataset_Type type, size_t size, uint64_t seed, unsigned int threads) {
+    std::vector<int> data(size);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned int) std::min<size_t>(threads, std::max<size_t>(1, size / MIN_SLICE));
+
+    if (threads <= 1) {
+        fillSlice(data, type, seed, 0, size);
+        return data;
+    }
+
+    std::vector<std::thread> workers;
+    size_t slice = (size + threads - 1) / threads;
+    for (unsigned int t = 0; t < threads; t++) {
+        size_t begin = t * slice;
+        size_t end = std::min(size, begin + slice);
+        workers.emplace_back(fillSlice, std::ref(data), type, seed, begin, end);
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    return data;
+}
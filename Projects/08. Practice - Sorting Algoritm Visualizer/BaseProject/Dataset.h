@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum Dataset_Type {
+    DATASET_RANDOM,
+    DATASET_SORTED,
+    DATASET_REVERSED,
+    DATASET_SAWTOOTH,
+    DATASET_FEW_UNIQUE
+};
+
+const char* datasetName(Dataset_Type type);
+bool parseDatasetType(const char* name, Dataset_Type* type);
+
+// Counter based PRNG: the n-th number of a stream only depends on (seed, n), so any
+// thread can generate any slice of the stream and the result never depends on the thread count
+uint64_t randomAt(uint64_t seed, uint64_t n);
+
+// Builds `size` values of the given shape. Random and few-unique data come from randomAt
+// so the same seed always gives the same array. threads = 0 uses every core
+std::vector<int> generateDataset(Dataset_Type type, size_t size, uint64_t seed, unsigned int threads = 0);
+
+// Writes elements [begin, begin + count) of the `size` element dataset into out. Lets datasets
+// too big for memory be generated a piece at a time
+void fillDataset(Dataset_Type type, uint64_t size, uint64_t seed, uint64_t begin, int* out, size_t count);
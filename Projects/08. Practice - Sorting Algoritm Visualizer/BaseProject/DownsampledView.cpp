@@ -0,0 +1,45 @@
+#include "DownsampledView.h"
+
+#include <algorithm>
+
+DownsampledView::DownsampledView(uint64_t elements, size_t columns) {
+    this->elements = elements;
+    columns = (size_t) std::max<uint64_t>(1, std::min<uint64_t>(columns, elements));
+    samples.assign(columns, 0);
+    threads.assign(columns, 0);
+    isDirty.assign(columns, false);
+}
+
+uint64_t DownsampledView::position(size_t column) const {
+    return column * elements / samples.size();
+}
+
+void DownsampledView::written(uint64_t begin, const int* values, size_t count, unsigned int thread) {
+    if (count == 0)
+        return;
+    // first column whose sample lies at or after begin
+    uint64_t columns = samples.size();
+    size_t column = (size_t) ((begin * columns + elements - 1) / elements);
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (; column < columns; column++) {
+        uint64_t at = position(column);
+        if (at >= begin + count)
+            break;
+        samples[column] = values[at - begin];
+        threads[column] = (uint16_t) thread;
+        if (!isDirty[column]) {
+            isDirty[column] = true;
+            dirty.push_back(column);
+        }
+    }
+}
+
+void DownsampledView::poll(std::vector<SortEvent>& out) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t column : dirty) {
+        out.push_back({ EVENT_WRITE, (uint32_t) column, 0, samples[column], threads[column] });
+        isDirty[column] = false;
+    }
+    dirty.clear();
+}
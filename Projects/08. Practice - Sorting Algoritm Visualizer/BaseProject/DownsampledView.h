@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Sort.h"
+
+// One point sample per column of an array too big to keep in memory. The sort reports every
+// block it writes, the renderer polls the samples that changed as write events.
+// Both sides may run on different threads.
+class DownsampledView {
+public:
+    DownsampledView(uint64_t elements, size_t columns);
+
+    size_t columns() const { return samples.size(); }
+    // the element each column shows
+    uint64_t position(size_t column) const;
+
+    // values[0, count) were just written to [begin, begin + count) by `thread`
+    void written(uint64_t begin, const int* values, size_t count, unsigned int thread);
+    // appends an EVENT_WRITE (a = column) for every column changed since the last poll
+    void poll(std::vector<SortEvent>& out);
+
+private:
+    uint64_t elements;
+    std::mutex lock;
+    std::vector<int> samples;
+    std::vector<uint16_t> threads;
+    std::vector<size_t> dirty;
+    std::vector<bool> isDirty;
+};
@@ -0,0 +1,325 @@
+#include "ExternalSort.h"
+#include "MappedFile.h"
+#include "ParallelSort.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// window used to stream whole files (generating and checking them)
+const size_t STREAM_WINDOW_BYTES = 16 << 20;
+
+// key of a run that has nothing left, sorts after every int
+const int64_t EXHAUSTED = std::numeric_limits<int64_t>::max();
+
+// the scratch buffers the input and output files are to ExternalSortOptions::recorder
+const unsigned int INPUT_BUFFER = 0, OUTPUT_BUFFER = 1;
+
+
+static uint64_t alignDown(uint64_t value, uint64_t alignment) {
+    return value / alignment * alignment;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// one access for ExternalSortOptions::recorder, index is into the whole file. The runs file unless
+// it's a scratch event
+static void recordAccess(SortRecorder* recorder, SortEvent_Type type, uint64_t index, unsigned int buffer, int value) {
+    if (recorder != nullptr)
+        recorder->record({ type, (uint32_t) index, buffer, value, (uint16_t) ThreadPool::currentWorker() });
+}
+
+
+// Tournament tree over k runs that keeps the loser of every match. Replacing the winner's key
+// only replays the matches on its own path, log2(k) comparisons per merged element
+class LoserTree {
+public:
+    uint64_t comparisons = 0;
+
+    LoserTree(const std::vector<int64_t>& keys) : keys(keys), tree(std::max<size_t>(1, keys.size()), 0) {
+        size_t k = keys.size();
+        // winners[i] for the internal nodes while building, leaves sit at k .. 2k - 1
+        std::vector<size_t> winners(2 * k);
+        for (size_t i = 0; i < k; i++)
+            winners[k + i] = i;
+        for (size_t node = k - 1; node > 0; node--) {
+            size_t a = winners[2 * node], b = winners[2 * node + 1];
+            bool aWins = this->keys[a] <= this->keys[b];
+            winners[node] = aWins ? a : b;
+            tree[node] = aWins ? b : a;
+        }
+        tree[0] = k > 1 ? winners[1] : 0;
+    }
+
+    size_t winner() const { return tree[0]; }
+    int64_t winningKey() const { return keys[tree[0]]; }
+
+    void replaceWinner(int64_t key) {
+        size_t run = tree[0];
+        keys[run] = key;
+        for (size_t node = (run + keys.size()) / 2; node > 0; node /= 2) {
+            comparisons++;
+            if (keys[tree[node]] < keys[run])
+                std::swap(tree[node], run);
+        }
+        tree[0] = run;
+    }
+
+private:
+    std::vector<int64_t> keys;
+    std::vector<size_t> tree;  // tree[0] is the overall winner, tree[1 .. k - 1] the losers
+};
+
+
+// Reads one sorted run front to back through a sliding window of the runs file
+struct RunReader {
+    MappedFile* file;
+    uint64_t next;
+    uint64_t end;
+    size_t windowElements;
+    SortRecorder* recorder;
+
+    const int* window = nullptr;
+    uint64_t windowBegin = 0;
+    size_t windowCount = 0;
+    bool failed = false;
+
+    // the next value of the run, EXHAUSTED once it's empty
+    int64_t pop() {
+        if (next == end) {
+            release();
+            return EXHAUSTED;
+        }
+        if (next >= windowBegin + windowCount) {
+            release();
+            windowBegin = next;
+            windowCount = (size_t) std::min<uint64_t>(windowElements, end - next);
+            window = (const int*) file->map(windowBegin * sizeof(int), windowCount * sizeof(int));
+            if (window == nullptr) {
+                failed = true;
+                windowCount = 0;
+                next = end;
+                return EXHAUSTED;
+            }
+        }
+        recordAccess(recorder, EVENT_READ, next, 0, window[next - windowBegin]);
+        return window[next++ - windowBegin];
+    }
+
+    void release() {
+        if (window != nullptr)
+            file->unmap((void*) window, windowCount * sizeof(int));
+        window = nullptr;
+        windowCount = 0;
+    }
+};
+
+
+bool writeDatasetFile(const char* path, Dataset_Type type, uint64_t size, uint64_t seed) {
+    MappedFile file;
+    if (!file.create(path, size * sizeof(int)))
+        return false;
+
+    size_t windowElements = STREAM_WINDOW_BYTES / sizeof(int);
+    for (uint64_t begin = 0; begin < size; begin += windowElements) {
+        size_t count = (size_t) std::min<uint64_t>(windowElements, size - begin);
+        int* window = (int*) file.map(begin * sizeof(int), count * sizeof(int));
+        if (window == nullptr)
+            return false;
+        fillDataset(type, size, seed, begin, window, count);
+        file.unmap(window, count * sizeof(int));
+    }
+    return true;
+}
+
+// Count, sum and xor of the ints of a file, which don't depend on their order
+struct FileChecksum {
+    uint64_t count = 0;
+    uint64_t sum = 0;  // wraps around
+    uint32_t bits = 0;
+
+    void add(const int* values, size_t count) {
+        this->count += count;
+        for (size_t i = 0; i < count; i++) {
+            sum += (uint32_t) values[i];
+            bits ^= (uint32_t) values[i];
+        }
+    }
+
+    bool operator==(const FileChecksum& other) const {
+        return count == other.count && sum == other.sum && bits == other.bits;
+    }
+};
+
+// Maps the file a window at a time and calls visit(window, count) front to back. Returns false
+// if the file couldn't be opened or mapped, or visit returned false
+template <typename Visit>
+static bool streamFile(const char* path, Visit visit) {
+    MappedFile file;
+    if (!file.openRead(path))
+        return false;
+
+    uint64_t elements = file.size() / sizeof(int);
+    size_t windowElements = STREAM_WINDOW_BYTES / sizeof(int);
+    for (uint64_t begin = 0; begin < elements; begin += windowElements) {
+        size_t count = (size_t) std::min<uint64_t>(windowElements, elements - begin);
+        const int* window = (const int*) file.map(begin * sizeof(int), count * sizeof(int));
+        if (window == nullptr)
+            return false;
+        bool more = visit(window, count);
+        file.unmap((void*) window, count * sizeof(int));
+        if (!more)
+            return false;
+    }
+    return true;
+}
+
+bool isSortedFile(const char* path, const char* inputPath) {
+    FileChecksum input, output;
+    bool read = streamFile(inputPath, [&](const int* window, size_t count) {
+        input.add(window, count);
+        return true;
+    });
+    if (!read)
+        return false;
+
+    int previous = std::numeric_limits<int>::min();
+    bool sorted = streamFile(path, [&](const int* window, size_t count) {
+        output.add(window, count);
+        bool ordered = previous <= window[0] && std::is_sorted(window, window + count);
+        previous = window[count - 1];
+        return ordered;
+    });
+    return sorted && output == input;
+}
+
+
+bool externalSort(const char* inputPath, const char* outputPath, const ExternalSortOptions& options, ExternalSortStats* stats) {
+    *stats = ExternalSortStats();
+
+    MappedFile input;
+    if (!input.openRead(inputPath))
+        return false;
+    uint64_t elements = input.size() / sizeof(int);
+    stats->elements = elements;
+
+    std::string runsPath = std::string(outputPath) + ".runs";
+    MappedFile runs, output;
+    if (!runs.create(runsPath.c_str(), elements * sizeof(int)) || !output.create(outputPath, elements * sizeof(int)))
+        return false;
+    if (elements == 0) {
+        runs.close();
+        std::remove(runsPath.c_str());
+        return true;
+    }
+
+    // every window offset has to land on the mapping granularity
+    size_t granule = MappedFile::granularity() / sizeof(int);
+    unsigned int threads = sortThreads();
+
+    // 1. sort runs. Each thread holds its run plus quicksort's scratch buffer of the same size
+    size_t runElements = (size_t) std::max<uint64_t>(granule, alignDown(options.memoryBytes / sizeof(int) / (2 * threads), granule));
+    size_t runCount = (size_t) ((elements + runElements - 1) / runElements);
+    stats->runs = runCount;
+    stats->runElements = runElements;
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<bool> failed(false);
+    std::mutex countersLock;
+    {
+        TaskGroup group(sortThreadPool());
+        for (size_t r = 0; r < runCount; r++) {
+            group.run([&, r] {
+                uint64_t begin = (uint64_t) r * runElements;
+                size_t count = (size_t) std::min<uint64_t>(runElements, elements - begin);
+                const int* source = (const int*) input.map(begin * sizeof(int), count * sizeof(int));
+                int* run = (int*) runs.map(begin * sizeof(int), count * sizeof(int));
+                if (source == nullptr || run == nullptr) {
+                    if (source != nullptr)
+                        input.unmap((void*) source, count * sizeof(int));
+                    if (run != nullptr)
+                        runs.unmap(run, count * sizeof(int));
+                    failed = true;
+                    return;
+                }
+                if (options.recorder == nullptr)
+                    std::copy(source, source + count, run);
+                else {
+                    for (size_t i = 0; i < count; i++) {
+                        recordAccess(options.recorder, EVENT_SCRATCH_READ, begin + i, INPUT_BUFFER, source[i]);
+                        run[i] = source[i];
+                        recordAccess(options.recorder, EVENT_WRITE, begin + i, 0, run[i]);
+                    }
+                }
+                input.unmap((void*) source, count * sizeof(int));
+
+                SortView view(run, count);
+                view.recorder = options.recorder;
+                view.thread = ThreadPool::currentWorker();
+                view.origin = begin;
+                quickSort(view);
+                if (options.view != nullptr)
+                    options.view->written(begin, run, count, ThreadPool::currentWorker());
+                runs.unmap(run, count * sizeof(int));
+
+                std::lock_guard<std::mutex> guard(countersLock);
+                stats->counters.add(view.counters);
+            });
+        }
+        group.wait();
+    }
+    stats->runMs = millisecondsSince(start);
+    input.close();
+    if (failed)
+        return false;
+
+    // 2. merge every run at once. Each run and the output get an equal share of the budget
+    start = std::chrono::steady_clock::now();
+    size_t windowElements = (size_t) std::max<uint64_t>(granule, alignDown(options.memoryBytes / sizeof(int) / (runCount + 1), granule));
+
+    std::vector<RunReader> readers(runCount);
+    std::vector<int64_t> heads(runCount);
+    for (size_t r = 0; r < runCount; r++) {
+        uint64_t begin = (uint64_t) r * runElements;
+        readers[r] = { &runs, begin, std::min<uint64_t>(elements, begin + runElements), windowElements, options.recorder };
+        heads[r] = readers[r].pop();
+    }
+    LoserTree tree(heads);
+
+    for (uint64_t begin = 0; begin < elements && !failed; begin += windowElements) {
+        size_t count = (size_t) std::min<uint64_t>(windowElements, elements - begin);
+        int* window = (int*) output.map(begin * sizeof(int), count * sizeof(int));
+        if (window == nullptr) {
+            failed = true;
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            window[i] = (int) tree.winningKey();
+            recordAccess(options.recorder, EVENT_SCRATCH_WRITE, begin + i, OUTPUT_BUFFER, window[i]);
+            tree.replaceWinner(readers[tree.winner()].pop());
+        }
+        if (options.view != nullptr)
+            options.view->written(begin, window, count, 0);
+        output.unmap(window, count * sizeof(int));
+    }
+    for (RunReader& reader : readers) {
+        reader.release();
+        failed = failed || reader.failed;
+    }
+
+    stats->mergeMs = millisecondsSince(start);
+    stats->counters.comparisons += tree.comparisons;
+    stats->counters.reads += elements;
+    stats->counters.writes += elements;
+
+    runs.close();
+    std::remove(runsPath.c_str());
+    return !failed;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Sort.h"
+#include "Dataset.h"
+#include "DownsampledView.h"
+
+// Out-of-core sort of a file of raw ints:
+//   1. the file is cut into runs that fit the memory budget. Each run is mapped, copied into a
+//      temporary runs file and sorted there, one run per pool thread at a time
+//   2. all runs are merged at once through a loser tree, each run read and the output written
+//      through large sequential mapped windows
+// Only memoryBytes worth of the data is mapped at any time (plus a window per run while merging).
+
+struct ExternalSortOptions {
+    size_t memoryBytes = (size_t) 256 << 20;
+    DownsampledView* view = nullptr;  // receives every sorted run and merged window
+    // receives every access, the runs file as the array and the input and output files as scratch
+    // buffers 0 and 1. Indices are 32 bit, so only for files of up to 2^32 ints
+    SortRecorder* recorder = nullptr;
+};
+
+struct ExternalSortStats {
+    uint64_t elements = 0;
+    size_t runs = 0;
+    size_t runElements = 0;
+    double runMs = 0.0;
+    double mergeMs = 0.0;
+    SortCounters counters;
+};
+
+// Writes a `size` element dataset to path a block at a time
+bool writeDatasetFile(const char* path, Dataset_Type type, uint64_t size, uint64_t seed);
+
+// Sorts the ints in inputPath into outputPath. `outputPath`.runs holds the runs while sorting
+bool externalSort(const char* inputPath, const char* outputPath, const ExternalSortOptions& options, ExternalSortStats* stats);
+
+// Streams through a file of ints checking they are in order, and that it has as many ints as the
+// input file with the same sum and xor, so nothing was lost or made up on the way
+bool isSortedFile(const char* path, const char* inputPath);
@@ -0,0 +1,152 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() {
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+}
+
+bool MappedFile::openFile(const char* path, bool create, uint64_t bytes) {
+    close();
+    writable = create;
+    file = CreateFileA(path, GENERIC_READ | (create ? GENERIC_WRITE : 0), FILE_SHARE_READ, NULL,
+                       create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "ERROR opening " << path << " (" << GetLastError() << ")" << std::endl;
+        return false;
+    }
+
+    if (create) {
+        LARGE_INTEGER end;
+        end.QuadPart = (LONGLONG) bytes;
+        if (!SetFilePointerEx(file, end, NULL, FILE_BEGIN) || !SetEndOfFile(file)) {
+            std::cout << "ERROR resizing " << path << " to " << bytes << " bytes" << std::endl;
+            close();
+            return false;
+        }
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    length = (uint64_t) fileSize.QuadPart;
+
+    // an empty file can't be mapped, but there is nothing to map either
+    if (length == 0)
+        return true;
+    mapping = CreateFileMappingA(file, NULL, create ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (mapping == nullptr) {
+        std::cout << "ERROR mapping " << path << " (" << GetLastError() << ")" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+
+void* MappedFile::map(uint64_t offset, size_t bytes) {
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                               (DWORD) (offset >> 32), (DWORD) offset, bytes);
+    if (view == nullptr)
+        std::cout << "ERROR mapping " << bytes << " bytes at " << offset << " (" << GetLastError() << ")" << std::endl;
+    return view;
+}
+
+void MappedFile::unmap(void* view, size_t bytes) {
+    UnmapViewOfFile(view);
+}
+
+size_t MappedFile::granularity() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+}
+
+#else
+
+MappedFile::MappedFile() {
+    file = -1;
+}
+
+bool MappedFile::openFile(const char* path, bool create, uint64_t bytes) {
+    close();
+    writable = create;
+    file = create ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    if (file < 0) {
+        std::cout << "ERROR opening " << path << std::endl;
+        return false;
+    }
+
+    if (create && ftruncate(file, (off_t) bytes) != 0) {
+        std::cout << "ERROR resizing " << path << " to " << bytes << " bytes" << std::endl;
+        close();
+        return false;
+    }
+    struct stat info;
+    fstat(file, &info);
+    length = (uint64_t) info.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (file >= 0)
+        ::close(file);
+    file = -1;
+    length = 0;
+}
+
+void* MappedFile::map(uint64_t offset, size_t bytes) {
+    void* view = mmap(nullptr, bytes, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, file, (off_t) offset);
+    if (view == MAP_FAILED) {
+        std::cout << "ERROR mapping " << bytes << " bytes at " << offset << std::endl;
+        return nullptr;
+    }
+    // windows are read front to back, let the kernel read ahead
+    madvise(view, bytes, MADV_SEQUENTIAL);
+    return view;
+}
+
+void MappedFile::unmap(void* view, size_t bytes) {
+    munmap(view, bytes);
+}
+
+size_t MappedFile::granularity() {
+    return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+#endif
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::openRead(const char* path) {
+    return openFile(path, false, 0);
+}
+
+bool MappedFile::create(const char* path, uint64_t bytes) {
+    return openFile(path, true, bytes);
+}
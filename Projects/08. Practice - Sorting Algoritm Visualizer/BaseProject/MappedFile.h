@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A file that is read and written through memory mapped windows, so files far bigger than
+// RAM (or the address space on 32 bit builds) can be worked on a window at a time.
+// Uses CreateFileMapping / MapViewOfFile on Windows and mmap everywhere else.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Opens an existing file read only. Returns false (and prints why) on failure
+    bool openRead(const char* path);
+    // Creates or truncates a read/write file of `bytes` bytes
+    bool create(const char* path, uint64_t bytes);
+    void close();
+
+    uint64_t size() const { return length; }
+
+    // Maps [offset, offset + bytes). offset must be a multiple of granularity(). Returns
+    // nullptr on failure. Windows are independent and may be mapped from several threads
+    void* map(uint64_t offset, size_t bytes);
+    void unmap(void* view, size_t bytes);
+
+    // alignment every window offset needs
+    static size_t granularity();
+
+private:
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int file;
+#endif
+    uint64_t length = 0;
+    bool writable = false;
+
+    bool openFile(const char* path, bool create, uint64_t bytes);
+};
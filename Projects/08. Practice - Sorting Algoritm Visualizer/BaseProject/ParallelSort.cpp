@@ -0,0 +1,292 @@
+#include "ParallelSort.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+// ranges smaller than the grain are sorted / merged / copied by a single task. Small arrays
+// (like the visualizer's) still get split across every thread
+const size_t MAX_GRAIN = 1 << 13;
+const size_t MIN_GRAIN = 64;
+
+// samples taken per bucket when picking sample sort splitters
+const size_t OVERSAMPLE = 32;
+
+
+// everything below is only touched with poolLock held
+static std::mutex poolLock;
+static std::unique_ptr<ThreadPool> pool;
+static unsigned int poolThreads = 0;
+static unsigned int poolHolds = 0;
+
+static void makePool(unsigned int threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (pool != nullptr && threads == poolThreads)
+        return;
+    pool.reset();
+    pool.reset(new ThreadPool(threads));
+    poolThreads = threads;
+}
+
+bool setSortThreads(unsigned int threads) {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (poolHolds > 0) {
+        std::cout << "ERROR::PARALLEL_SORT::POOL_IN_USE can't change the sort threads during a race" << std::endl;
+        return false;
+    }
+    makePool(threads);
+    return true;
+}
+
+unsigned int sortThreads() {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (pool == nullptr)
+        makePool(0);
+    return poolThreads;
+}
+
+ThreadPool& sortThreadPool() {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (pool == nullptr)
+        makePool(0);
+    return *pool;
+}
+
+void holdSortThreads() {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (pool == nullptr)
+        makePool(0);
+    poolHolds++;
+}
+
+void releaseSortThreads() {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (poolHolds > 0)
+        poolHolds--;
+}
+
+
+// State shared by every task of one parallel sort
+struct ParallelSortContext {
+    const SortView& parent;
+    size_t grain;
+    std::mutex lock;
+    SortCounters totals;
+
+    ParallelSortContext(const SortView& parent) : parent(parent) {
+        grain = std::min(MAX_GRAIN, std::max(MIN_GRAIN, parent.size() / (8 * sortThreads())));
+    }
+
+    // a view for the task running on this thread
+    SortView view() const {
+        return parent.fork(ThreadPool::currentWorker());
+    }
+
+    // collects a finished task's counters so they can be added back to the caller's view
+    void add(const SortCounters& counters) {
+        std::lock_guard<std::mutex> guard(lock);
+        totals.add(counters);
+    }
+};
+
+// runs body(begin, end) over [lo, hi) in grain sized chunks
+template <typename Body>
+static void parallelFor(size_t lo, size_t hi, size_t grain, Body body) {
+    TaskGroup group(sortThreadPool());
+    for (size_t begin = lo; begin < hi; begin += grain) {
+        size_t end = std::min(hi, begin + grain);
+        group.run([=] { body(begin, end); });
+    }
+    group.wait();
+}
+
+
+// ---------------------------------- merge sort ----------------------------------
+
+// Merges scratch[a0, a1) and scratch[b0, b1) into data starting at out. Large merges split the
+// bigger run in half, find the matching split point of the other with a binary search, and
+// merge both halves at once.
+static void parallelMerge(ParallelSortContext& context, const std::vector<int>& scratch,
+                          size_t a0, size_t a1, size_t b0, size_t b1, size_t out) {
+    SortView view = context.view();
+    const int* buffer = scratch.data();
+
+    if ((a1 - a0) + (b1 - b0) <= context.grain) {
+        while (a0 < a1 && b0 < b1) {
+            int a = view.readScratch(buffer, a0), b = view.readScratch(buffer, b0);
+            if (view.lessValue(b, a)) {
+                view.write(out++, b);
+                b0++;
+            }
+            else {
+                view.write(out++, a);
+                a0++;
+            }
+        }
+        while (a0 < a1)
+            view.write(out++, view.readScratch(buffer, a0++));
+        while (b0 < b1)
+            view.write(out++, view.readScratch(buffer, b0++));
+        context.add(view.counters);
+        return;
+    }
+
+    if (a1 - a0 < b1 - b0) {
+        std::swap(a0, b0);
+        std::swap(a1, b1);
+    }
+    size_t am = a0 + (a1 - a0) / 2;
+    int split = view.readScratch(buffer, am);
+
+    // first element of the other run that isn't smaller than the split value
+    size_t lo = b0, hi = b1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (view.lessValue(view.readScratch(buffer, mid), split))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    size_t bm = lo;
+    context.add(view.counters);
+
+    size_t outMid = out + (am - a0) + (bm - b0);
+    TaskGroup group(sortThreadPool());
+    group.run([&, a0, am, b0, bm, out] { parallelMerge(context, scratch, a0, am, b0, bm, out); });
+    parallelMerge(context, scratch, am, a1, bm, b1, outMid);
+    group.wait();
+}
+
+static void parallelMergeSortRange(ParallelSortContext& context, std::vector<int>& scratch, size_t lo, size_t hi) {
+    if (hi - lo <= context.grain) {
+        SortView view = context.view();
+        quickSortRange(view, lo, hi);
+        context.add(view.counters);
+        return;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    {
+        TaskGroup group(sortThreadPool());
+        group.run([&] { parallelMergeSortRange(context, scratch, lo, mid); });
+        parallelMergeSortRange(context, scratch, mid, hi);
+        group.wait();
+    }
+
+    {
+        // already in order, nothing to merge
+        SortView view = context.view();
+        bool ordered = !view.less(mid, mid - 1);
+        context.add(view.counters);
+        if (ordered)
+            return;
+    }
+
+    parallelFor(lo, hi, context.grain, [&](size_t begin, size_t end) {
+        SortView view = context.view();
+        for (size_t i = begin; i < end; i++)
+            view.writeScratch(scratch.data(), i, view.read(i));
+        context.add(view.counters);
+    });
+    parallelMerge(context, scratch, lo, mid, mid, hi, lo);
+}
+
+void parallelMergeSort(SortView& view) {
+    if (view.size() < 2)
+        return;
+    std::vector<int> scratch(view.size());
+    ParallelSortContext context(view);
+    parallelMergeSortRange(context, scratch, 0, view.size());
+    view.counters.add(context.totals);
+}
+
+
+// ---------------------------------- sample sort ---------------------------------
+
+void parallelSampleSort(SortView& view) {
+    size_t n = view.size();
+    unsigned int threads = sortThreads();
+    ParallelSortContext context(view);
+    if (n <= 2 * context.grain || threads == 1) {
+        quickSort(view);
+        return;
+    }
+
+    size_t grain = context.grain;
+    size_t buckets = std::min<size_t>(4 * threads, n / grain);
+
+    // 1. pick buckets - 1 splitters from an evenly spaced, sorted sample
+    std::vector<int> sample(buckets * OVERSAMPLE);
+    size_t stride = n / sample.size();
+    for (size_t i = 0; i < sample.size(); i++)
+        sample[i] = view.read(i * stride + stride / 2);
+    std::sort(sample.begin(), sample.end(), [&](int a, int b) { return view.lessValue(a, b); });
+
+    // scratch buffer 1 to the cache simulator, the scatter buffer is 0
+    std::vector<int> splitters(buckets - 1);
+    for (size_t i = 0; i < splitters.size(); i++)
+        splitters[i] = sample[(i + 1) * OVERSAMPLE];
+
+    // 2. classify every element and count how many of each block land in each bucket
+    size_t blocks = (n + grain - 1) / grain;
+    std::vector<uint16_t> bucketOf(n);
+    std::vector<size_t> counts(blocks * buckets, 0);
+
+    parallelFor(0, n, grain, [&](size_t begin, size_t end) {
+        SortView local = context.view();
+        size_t* blockCounts = &counts[(begin / grain) * buckets];
+        for (size_t i = begin; i < end; i++) {
+            int value = local.read(i);
+            size_t lo = 0, hi = splitters.size();
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (local.lessValue(local.readScratch(splitters.data(), mid, 1), value))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            bucketOf[i] = (uint16_t) lo;
+            blockCounts[lo]++;
+        }
+        context.add(local.counters);
+    });
+
+    // 3. prefix sums: bucket by bucket, and block by block inside each bucket
+    std::vector<size_t> bucketStart(buckets + 1, 0);
+    std::vector<size_t> offsets(blocks * buckets);
+    size_t running = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucketStart[b] = running;
+        for (size_t block = 0; block < blocks; block++) {
+            offsets[block * buckets + b] = running;
+            running += counts[block * buckets + b];
+        }
+    }
+    bucketStart[buckets] = n;
+
+    // 4. scatter into scratch, then copy each bucket back and sort it
+    std::vector<int> scratch(n);
+    parallelFor(0, n, grain, [&](size_t begin, size_t end) {
+        SortView local = context.view();
+        size_t* blockOffsets = &offsets[(begin / grain) * buckets];
+        for (size_t i = begin; i < end; i++)
+            local.writeScratch(scratch.data(), blockOffsets[bucketOf[i]]++, local.read(i));
+        context.add(local.counters);
+    });
+
+    TaskGroup group(sortThreadPool());
+    for (size_t b = 0; b < buckets; b++) {
+        size_t lo = bucketStart[b], hi = bucketStart[b + 1];
+        group.run([&, lo, hi] {
+            SortView local = context.view();
+            for (size_t i = lo; i < hi; i++)
+                local.write(i, local.readScratch(scratch.data(), i));
+            quickSortRange(local, lo, hi);
+            context.add(local.counters);
+        });
+    }
+    group.wait();
+
+    view.counters.add(context.totals);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "Sort.h"
+#include "ThreadPool.h"
+
+// Sets how many threads the parallel sorts use (0 = every core). Rebuilds the shared pool, so it's
+// refused (false) while the pool is held
+bool setSortThreads(unsigned int threads);
+unsigned int sortThreads();
+// the shared pool, made on first use. Race lanes ask for it from their own threads at once
+ThreadPool& sortThreadPool();
+// Keeps the pool as it is while sorts on other threads may be using it. Every hold needs a release
+void holdSortThreads();
+void releaseSortThreads();
+
+// Both sorts split the work across the pool. Each task works through its own fork of the
+// view so events carry the id of the thread that made them, and the per-task counters are
+// added back into `view` once the sort is done.
+void parallelMergeSort(SortView& view);
+void parallelSampleSort(SortView& view);
@@ -0,0 +1,57 @@
+#include "SegmentTree.h"
+
+#include <algorithm>
+
+SegmentTree::SegmentTree(const std::vector<int>& values) : values(values) {
+    blocks = (values.size() + LEAF_SIZE - 1) / LEAF_SIZE;
+    if (blocks == 0)
+        return;
+    nodes.resize(2 * blocks);
+    for (size_t b = 0; b < blocks; b++)
+        nodes[blocks + b] = scan(b * LEAF_SIZE, std::min(values.size(), (b + 1) * LEAF_SIZE));
+    for (size_t i = blocks - 1; i > 0; i--)
+        nodes[i] = combine(nodes[2 * i], nodes[2 * i + 1]);
+}
+
+void SegmentTree::changed(size_t i, unsigned int thread) {
+    size_t b = i / LEAF_SIZE;
+    size_t node = blocks + b;
+    nodes[node].stamp = ++clock;
+    nodes[node].thread = (uint16_t) thread;
+    nodes[node] = scan(b * LEAF_SIZE, std::min(values.size(), (b + 1) * LEAF_SIZE));
+    for (node /= 2; node > 0; node /= 2)
+        nodes[node] = combine(nodes[2 * node], nodes[2 * node + 1]);
+}
+
+SegmentNode SegmentTree::query(size_t lo, size_t hi) const {
+    size_t first = lo / LEAF_SIZE, last = (hi - 1) / LEAF_SIZE;
+    if (first == last)
+        return scan(lo, hi);
+
+    // partial blocks at either end are scanned, the whole blocks between come from the tree
+    SegmentNode result = combine(scan(lo, (first + 1) * LEAF_SIZE), scan(last * LEAF_SIZE, hi));
+    size_t l = blocks + first + 1, r = blocks + last;
+    for (; l < r; l /= 2, r /= 2) {
+        if (l & 1)
+            result = combine(result, nodes[l++]);
+        if (r & 1)
+            result = combine(result, nodes[--r]);
+    }
+    return result;
+}
+
+SegmentNode SegmentTree::scan(size_t lo, size_t hi) const {
+    const SegmentNode& block = nodes[blocks + lo / LEAF_SIZE];
+    SegmentNode result = { values[lo], values[lo], 0, block.stamp, block.thread };
+    for (size_t i = lo; i < hi; i++) {
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+        result.sum += values[i];
+    }
+    return result;
+}
+
+SegmentNode SegmentTree::combine(const SegmentNode& a, const SegmentNode& b) {
+    const SegmentNode& latest = a.stamp >= b.stamp ? a : b;
+    return { std::min(a.min, b.min), std::max(a.max, b.max), a.sum + b.sum, latest.stamp, latest.thread };
+}
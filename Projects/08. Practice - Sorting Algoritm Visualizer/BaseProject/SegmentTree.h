@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Summary of a range of the array
+struct SegmentNode {
+    int min;
+    int max;
+    int64_t sum;
+    uint32_t stamp;   // when the most recently changed block of the range was changed
+    uint16_t thread;  // and the thread that changed it
+};
+
+// Min / max / sum segment tree over an array it doesn't own. Leaves summarise blocks of
+// LEAF_SIZE elements so the tree costs a few bytes per element even at 10^8 elements, and
+// it is stored bottom-up (leaves at nodes[blocks + b]) so any length works without padding.
+// Both changed and query are O(LEAF_SIZE + log n).
+class SegmentTree {
+public:
+    static const size_t LEAF_SIZE = 16;
+
+    SegmentTree(const std::vector<int>& values);
+
+    // values[i] was changed by `thread`
+    void changed(size_t i, unsigned int thread);
+    // summary of [lo, hi), hi > lo
+    SegmentNode query(size_t lo, size_t hi) const;
+
+    size_t size() const { return values.size(); }
+
+private:
+    const std::vector<int>& values;
+    size_t blocks;
+    uint32_t clock = 0;
+    std::vector<SegmentNode> nodes;
+
+    // summary of elements [lo, hi) inside one block, dated like the block
+    SegmentNode scan(size_t lo, size_t hi) const;
+    static SegmentNode combine(const SegmentNode& a, const SegmentNode& b);
+};
@@ -0,0 +1,258 @@
+#include "Sort.h"
+#include "ParallelSort.h"
+#include "SortKernels.h"
+
+#include <cstring>
+
+// partitions smaller than this are finished with insertion sort (or a sorting network, see sortLeaf)
+const size_t SMALL_PARTITION = 16;
+
+
+void SortCounters::add(const SortCounters& other) {
+    comparisons += other.comparisons;
+    swaps += other.swaps;
+    reads += other.reads;
+    writes += other.writes;
+    estimated = estimated || other.estimated;
+}
+
+SortView::SortView(std::vector<int>& values) {
+    data = values.data();
+    length = values.size();
+}
+
+SortView::SortView(int* data, size_t length) {
+    this->data = data;
+    this->length = length;
+}
+
+
+const std::vector<SortAlgorithm>& sortAlgorithms() {
+    static const std::vector<SortAlgorithm> algorithms = {
+        { "selection",       selectionSort,      100000,   false },
+        { "insertion",       insertionSort,      100000,   false },
+        { "quick",           quickSort,          SIZE_MAX, false },
+        { "merge",           mergeSort,          SIZE_MAX, false },
+        { "heap",            heapSort,           SIZE_MAX, false },
+        { "parallel-merge",  parallelMergeSort,  SIZE_MAX, true },
+        { "parallel-sample", parallelSampleSort, SIZE_MAX, true },
+    };
+    return algorithms;
+}
+
+const SortAlgorithm* findSortAlgorithm(const char* name) {
+    for (const SortAlgorithm& algorithm : sortAlgorithms()) {
+        if (strcmp(algorithm.name, name) == 0)
+            return &algorithm;
+    }
+    return nullptr;
+}
+
+
+// the SIMD kernels can stand in for the instrumented code: nobody is replaying the steps and exact
+// counters weren't asked for
+static bool useKernels(const SortView& view) {
+    return view.recorder == nullptr && view.kernels;
+}
+
+size_t selectionSortStep(SortView& view, size_t current_index) {
+    // nobody is replaying the comparisons, so the whole scan can go to the argmin kernel
+    if (useKernels(view)) {
+        size_t remaining = view.size() - current_index;
+        size_t lowest_index = current_index + argmin(view.data + current_index, remaining);
+        view.counters.reads += remaining;
+        view.counters.comparisons += remaining - 1;
+        view.counters.estimated = true;
+        if (lowest_index != current_index)
+            view.swap(current_index, lowest_index);
+        return current_index + 1;
+    }
+
+    size_t lowest_index = current_index;
+    int lowest = view.read(current_index);
+
+    for (size_t i = current_index + 1; i < view.size(); i++) {
+        int cur = view.read(i);
+        if (view.lessValue(cur, lowest)) {
+            lowest = cur;
+            lowest_index = i;
+        }
+    }
+
+    if (lowest_index != current_index)
+        view.swap(current_index, lowest_index);
+
+    return current_index + 1;
+}
+
+void selectionSort(SortView& view) {
+    size_t i = 0;
+    while (i + 1 < view.size())
+        i = selectionSortStep(view, i);
+}
+
+
+void insertionSortRange(SortView& view, size_t lo, size_t hi) {
+    for (size_t i = lo + 1; i < hi; i++) {
+        int value = view.read(i);
+        size_t j = i;
+        while (j > lo) {
+            int prev = view.read(j - 1);
+            if (!view.lessValue(value, prev))
+                break;
+            view.write(j, prev);
+            j--;
+        }
+        view.write(j, value);
+    }
+}
+
+void insertionSort(SortView& view) {
+    insertionSortRange(view, 0, view.size());
+}
+
+
+// Largest range the divide and conquer sorts hand to sortLeaf
+static size_t leafSize(const SortView& view) {
+    return useKernels(view) ? NETWORK_MAX : SMALL_PARTITION;
+}
+
+// Small ranges nobody is watching go through a sorting network on the raw array, counted as one
+// read and write per element and the network's comparators. Recorded ones keep insertion sort so
+// every step can be replayed
+static void sortLeaf(SortView& view, size_t lo, size_t hi) {
+    size_t n = hi - lo;
+    if (!useKernels(view) || n > NETWORK_MAX) {
+        insertionSortRange(view, lo, hi);
+        return;
+    }
+    networkSort(view.data + lo, n);
+    view.counters.comparisons += networkComparators(n);
+    view.counters.reads += n;
+    view.counters.writes += n;
+    view.counters.estimated = true;
+}
+
+
+// median-of-three Hoare partition, recursing into the smaller half
+void quickSortRange(SortView& view, size_t lo, size_t hi) {
+    while (hi - lo > leafSize(view)) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (view.less(mid, lo))
+            view.swap(mid, lo);
+        if (view.less(hi - 1, lo))
+            view.swap(hi - 1, lo);
+        if (view.less(hi - 1, mid))
+            view.swap(hi - 1, mid);
+        int pivot = view.read(mid);
+
+        size_t i = lo;
+        size_t j = hi - 1;
+        while (true) {
+            while (view.lessValue(view.read(i), pivot))
+                i++;
+            while (view.lessValue(pivot, view.read(j)))
+                j--;
+            if (i >= j)
+                break;
+            view.swap(i, j);
+            i++;
+            j--;
+        }
+
+        // [lo, j] and [j + 1, hi)
+        if (j + 1 - lo < hi - j - 1) {
+            quickSortRange(view, lo, j + 1);
+            lo = j + 1;
+        }
+        else {
+            quickSortRange(view, j + 1, hi);
+            hi = j + 1;
+        }
+    }
+    sortLeaf(view, lo, hi);
+}
+
+void quickSort(SortView& view) {
+    if (view.size() > 1)
+        quickSortRange(view, 0, view.size());
+}
+
+
+// merges the sorted runs [lo, mid) and [mid, hi) through the scratch buffer
+static void mergeRuns(SortView& view, std::vector<int>& scratch, size_t lo, size_t mid, size_t hi) {
+    int* buffer = scratch.data();
+    for (size_t i = lo; i < hi; i++)
+        view.writeScratch(buffer, i, view.read(i));
+
+    size_t left = lo, right = mid, out = lo;
+    while (left < mid && right < hi) {
+        int a = view.readScratch(buffer, left), b = view.readScratch(buffer, right);
+        if (view.lessValue(b, a)) {
+            view.write(out++, b);
+            right++;
+        }
+        else {
+            view.write(out++, a);
+            left++;
+        }
+    }
+    while (left < mid)
+        view.write(out++, view.readScratch(buffer, left++));
+    while (right < hi)
+        view.write(out++, view.readScratch(buffer, right++));
+}
+
+static void mergeSortRange(SortView& view, std::vector<int>& scratch, size_t lo, size_t hi) {
+    if (hi - lo <= leafSize(view)) {
+        sortLeaf(view, lo, hi);
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    mergeSortRange(view, scratch, lo, mid);
+    mergeSortRange(view, scratch, mid, hi);
+
+    // already in order, nothing to merge
+    if (!view.less(mid, mid - 1))
+        return;
+    mergeRuns(view, scratch, lo, mid, hi);
+}
+
+void mergeSort(SortView& view) {
+    std::vector<int> scratch(view.size());
+    mergeSortRange(view, scratch, 0, view.size());
+}
+
+
+static void siftDown(SortView& view, size_t root, size_t end) {
+    while (2 * root + 1 < end) {
+        size_t child = 2 * root + 1;
+        if (child + 1 < end && view.less(child, child + 1))
+            child++;
+        if (!view.less(root, child))
+            return;
+        view.swap(root, child);
+        root = child;
+    }
+}
+
+void heapSort(SortView& view) {
+    size_t n = view.size();
+    if (n < 2)
+        return;
+    for (size_t i = n / 2; i-- > 0;)
+        siftDown(view, i, n);
+    for (size_t end = n - 1; end > 0; end--) {
+        view.swap(0, end);
+        siftDown(view, 0, end);
+    }
+}
+
+
+bool isSorted(const std::vector<int>& data) {
+    for (size_t i = 1; i < data.size(); i++) {
+        if (data[i] < data[i - 1])
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+enum SortEvent_Type {
+    EVENT_READ,
+    EVENT_COMPARE,
+    EVENT_SWAP,
+    EVENT_WRITE,
+    EVENT_COMPARE_VALUES,  // two values already read, no array access
+    EVENT_SCRATCH_READ,    // an element of one of the algorithm's own buffers, not the array
+    EVENT_SCRATCH_WRITE
+};
+
+// One step of an algorithm, tagged with the thread that made it
+struct SortEvent {
+    SortEvent_Type type;
+    uint32_t a, b;     // indices (b is unused for reads and writes, and is the buffer for scratch)
+    int value;         // value read or written
+    uint16_t thread;
+};
+
+// Receives the events of a SortView. May be called from several threads at once
+class SortRecorder {
+public:
+    virtual ~SortRecorder() {}
+    virtual void record(const SortEvent& event) = 0;
+};
+
+
+// Running totals of the work an algorithm did on a SortView
+struct SortCounters {
+    uint64_t comparisons = 0;
+    uint64_t swaps = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    // some of the work went through a SIMD kernel, whose counts are worked out from the sizes it
+    // was given rather than counted
+    bool estimated = false;
+
+    // bytes of the sorted array that were read or written
+    uint64_t bytesTouched() const { return (reads + writes) * sizeof(int); }
+    void add(const SortCounters& other);
+};
+
+
+// An instrumented window onto the array being sorted. Algorithms only touch the data
+// through these calls so every comparison, swap, read and write can be counted.
+class SortView {
+public:
+    int* data;
+    size_t length;
+    SortCounters counters;
+    SortRecorder* recorder = nullptr;  // nothing is recorded when null
+    unsigned int thread = 0;
+    size_t origin = 0;  // index of data[0] in the whole array, added to every recorded index
+    // unrecorded views may hand small ranges to the SIMD kernels. false keeps every step on the
+    // instrumented code, so the counters are exact
+    bool kernels = true;
+
+    SortView(std::vector<int>& values);
+    SortView(int* data, size_t length);
+
+    size_t size() const { return length; }
+
+    int read(size_t i) {
+        counters.reads++;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_READ, (uint32_t) (origin + i), 0, data[i], (uint16_t) thread });
+        return data[i];
+    }
+
+    void write(size_t i, int value) {
+        counters.writes++;
+        data[i] = value;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_WRITE, (uint32_t) (origin + i), 0, value, (uint16_t) thread });
+    }
+
+    // element i of a scratch buffer. Recorded so the cache simulator sees the buffer, but not
+    // counted, the counters are the array's. Each buffer an algorithm has at once gets a number
+    int readScratch(const int* scratch, size_t i, unsigned int buffer = 0) {
+        if (recorder != nullptr)
+            recorder->record({ EVENT_SCRATCH_READ, (uint32_t) i, buffer, scratch[i], (uint16_t) thread });
+        return scratch[i];
+    }
+
+    void writeScratch(int* scratch, size_t i, int value, unsigned int buffer = 0) {
+        scratch[i] = value;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_SCRATCH_WRITE, (uint32_t) i, buffer, value, (uint16_t) thread });
+    }
+
+    // data[i] < data[j]
+    bool less(size_t i, size_t j) {
+        counters.reads += 2;
+        counters.comparisons++;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_COMPARE, (uint32_t) (origin + i), (uint32_t) (origin + j), 0, (uint16_t) thread });
+        return data[i] < data[j];
+    }
+
+    // compares values the algorithm has already read
+    bool lessValue(int a, int b) {
+        counters.comparisons++;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_COMPARE_VALUES, 0, 0, 0, (uint16_t) thread });
+        return a < b;
+    }
+
+    void swap(size_t i, size_t j) {
+        counters.reads += 2;
+        counters.writes += 2;
+        counters.swaps++;
+        int temp = data[i];
+        data[i] = data[j];
+        data[j] = temp;
+        if (recorder != nullptr)
+            recorder->record({ EVENT_SWAP, (uint32_t) (origin + i), (uint32_t) (origin + j), 0, (uint16_t) thread });
+    }
+
+    // a view of the same array for another thread, with fresh counters
+    SortView fork(unsigned int thread) const {
+        SortView view(data, length);
+        view.recorder = recorder;
+        view.thread = thread;
+        view.origin = origin;
+        view.kernels = kernels;
+        return view;
+    }
+};
+
+
+typedef void (*SortFunction)(SortView& view);
+
+struct SortAlgorithm {
+    const char* name;
+    SortFunction run;
+    size_t maxSize;  // quadratic sorts are skipped above this many elements
+    bool parallel;   // runs on the pool set up by setSortThreads
+};
+
+// Every algorithm the visualizer and benchmark know about
+const std::vector<SortAlgorithm>& sortAlgorithms();
+const SortAlgorithm* findSortAlgorithm(const char* name);
+
+// One pass of selection sort: moves the smallest element of [current_index, size) into current_index.
+// Returns the next index to sort from
+size_t selectionSortStep(SortView& view, size_t current_index);
+
+void selectionSort(SortView& view);
+void insertionSort(SortView& view);
+void quickSort(SortView& view);
+void mergeSort(SortView& view);
+void heapSort(SortView& view);
+
+// The same algorithms on the index range [lo, hi), used as building blocks by the parallel sorts
+void insertionSortRange(SortView& view, size_t lo, size_t hi);
+void quickSortRange(SortView& view, size_t lo, size_t hi);
+
+bool isSorted(const std::vector<int>& data);
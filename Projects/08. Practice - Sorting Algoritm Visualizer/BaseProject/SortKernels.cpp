@@ -0,0 +1,438 @@
+#include "SortKernels.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SORT_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and clang need the instruction set per function
+#if defined(SORT_KERNELS_X86) && !defined(_MSC_VER)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+
+// ------------------------------------ dispatch ------------------------------------
+
+static bool cpuHasAvx2() {
+#if !defined(SORT_KERNELS_X86)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS also has to save the ymm registers between context switches
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static Simd_Level bestLevel() {
+    static const Simd_Level best = cpuHasAvx2() ? SIMD_AVX2 : SIMD_SCALAR;
+    return best;
+}
+
+static Simd_Level currentLevel = bestLevel();
+
+Simd_Level simdLevel() {
+    return currentLevel;
+}
+
+void setSimdLevel(Simd_Level level) {
+    currentLevel = std::min(level, bestLevel());
+}
+
+bool simdSupported(Simd_Level level) {
+    return level <= bestLevel();
+}
+
+const char* simdLevelName(Simd_Level level) {
+    switch (level) {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+
+// ------------------------------------- scalar -------------------------------------
+
+// padded network size: 8, 16, 32 or 64
+static size_t networkSize(size_t n) {
+    size_t size = 8;
+    while (size < n)
+        size *= 2;
+    return size;
+}
+
+// largest value of T, sorts after everything real
+template <typename T>
+static T padValue() {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+template <typename T>
+static void compareSwap(T* values, size_t a, size_t b) {
+    T lo = std::min(values[a], values[b]);
+    T hi = std::max(values[a], values[b]);
+    values[a] = lo;
+    values[b] = hi;
+}
+
+// Bitonic sort of `size` (a power of two) values. Each merge compares the mirror images of
+// its two sorted halves, then half-cleans at distances size/4 .. 1. The AVX2 version runs
+// exactly the same comparators
+template <typename T>
+static void bitonicSortScalar(T* values, size_t size) {
+    for (size_t k = 2; k <= size; k *= 2) {
+        for (size_t block = 0; block < size; block += k) {
+            for (size_t i = 0; i < k / 2; i++)
+                compareSwap(values, block + i, block + k - 1 - i);
+        }
+        for (size_t j = k / 4; j > 0; j /= 2) {
+            for (size_t i = 0; i < size; i++) {
+                if ((i & j) == 0)
+                    compareSwap(values, i, i + j);
+            }
+        }
+    }
+}
+
+template <typename T>
+static void networkSortScalar(T* data, size_t n) {
+    T padded[NETWORK_MAX];
+    size_t size = networkSize(n);
+    std::copy(data, data + n, padded);
+    std::fill(padded + n, padded + size, padValue<T>());
+    bitonicSortScalar(padded, size);
+    std::copy(padded, padded + n, data);
+}
+
+template <typename T>
+static size_t argminScalar(const T* data, size_t n) {
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (data[i] < data[best])
+            best = i;
+    }
+    return best;
+}
+
+template <typename T>
+static size_t partitionScalar(const T* in, T* out, size_t n, T pivot) {
+    size_t left = 0, right = n;
+    for (size_t i = 0; i < n; i++) {
+        if (in[i] < pivot)
+            out[left++] = in[i];
+        else
+            out[--right] = in[i];
+    }
+    return left;
+}
+
+
+// -------------------------------------- AVX2 --------------------------------------
+
+#ifdef SORT_KERNELS_X86
+
+// The int and float kernels are the same code over these two lane types
+struct IntLanes {
+    typedef int Scalar;
+    typedef __m256i Vector;
+
+    static AVX2_TARGET Vector load(const int* p) { return _mm256_loadu_si256((const __m256i*) p); }
+    static AVX2_TARGET void store(int* p, Vector v) { _mm256_storeu_si256((__m256i*) p, v); }
+    static AVX2_TARGET void maskStore(int* p, __m256i mask, Vector v) { _mm256_maskstore_epi32(p, mask, v); }
+    static AVX2_TARGET Vector set1(int value) { return _mm256_set1_epi32(value); }
+    static AVX2_TARGET Vector min(Vector a, Vector b) { return _mm256_min_epi32(a, b); }
+    static AVX2_TARGET Vector max(Vector a, Vector b) { return _mm256_max_epi32(a, b); }
+    static AVX2_TARGET Vector permute(Vector v, __m256i lanes) { return _mm256_permutevar8x32_epi32(v, lanes); }
+    // every bit of a lane set where a < b
+    static AVX2_TARGET __m256i less(Vector a, Vector b) { return _mm256_cmpgt_epi32(b, a); }
+
+    template <int MASK>
+    static AVX2_TARGET Vector blend(Vector a, Vector b) { return _mm256_blend_epi32(a, b, MASK); }
+};
+
+struct FloatLanes {
+    typedef float Scalar;
+    typedef __m256 Vector;
+
+    static AVX2_TARGET Vector load(const float* p) { return _mm256_loadu_ps(p); }
+    static AVX2_TARGET void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+    static AVX2_TARGET void maskStore(float* p, __m256i mask, Vector v) { _mm256_maskstore_ps(p, mask, v); }
+    static AVX2_TARGET Vector set1(float value) { return _mm256_set1_ps(value); }
+    static AVX2_TARGET Vector min(Vector a, Vector b) { return _mm256_min_ps(a, b); }
+    static AVX2_TARGET Vector max(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+    static AVX2_TARGET Vector permute(Vector v, __m256i lanes) { return _mm256_permutevar8x32_ps(v, lanes); }
+    static AVX2_TARGET __m256i less(Vector a, Vector b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+
+    template <int MASK>
+    static AVX2_TARGET Vector blend(Vector a, Vector b) { return _mm256_blend_ps(a, b, MASK); }
+};
+
+// Compares every lane with the lane `pairs` points at. Lanes set in MASK keep the larger value
+template <typename L, int MASK>
+static AVX2_TARGET typename L::Vector exchange(typename L::Vector v, __m256i pairs) {
+    typename L::Vector other = L::permute(v, pairs);
+    return L::template blend<MASK>(L::min(v, other), L::max(v, other));
+}
+
+// half cleaners at distances 4, 2 and 1 inside one register
+template <typename L>
+static AVX2_TARGET typename L::Vector cleanLanes(typename L::Vector v) {
+    v = exchange<L, 0xF0>(v, _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3));
+    v = exchange<L, 0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5));
+    return exchange<L, 0xAA>(v, _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6));
+}
+
+// the 8 element network inside one register
+template <typename L>
+static AVX2_TARGET typename L::Vector sortLanes(typename L::Vector v) {
+    const __m256i swap1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    v = exchange<L, 0xAA>(v, swap1);
+    v = exchange<L, 0xCC>(v, _mm256_setr_epi32(3, 2, 1, 0, 7, 6, 5, 4));
+    v = exchange<L, 0xAA>(v, swap1);
+    v = exchange<L, 0xF0>(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    v = exchange<L, 0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5));
+    return exchange<L, 0xAA>(v, swap1);
+}
+
+// Sorts count (1, 2, 4 or 8) registers as one array: each register on its own, then the same
+// mirror / half-cleaner merges as the scalar network with whole registers as the lanes
+template <typename L>
+static AVX2_TARGET void sortRegisters(typename L::Vector* v, size_t count) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (size_t r = 0; r < count; r++)
+        v[r] = sortLanes<L>(v[r]);
+
+    for (size_t k = 2; k <= count; k *= 2) {
+        for (size_t block = 0; block < count; block += k) {
+            for (size_t a = 0; a < k / 2; a++) {
+                typename L::Vector mirrored = L::permute(v[block + k - 1 - a], reverse);
+                typename L::Vector lo = L::min(v[block + a], mirrored);
+                typename L::Vector hi = L::max(v[block + a], mirrored);
+                v[block + a] = lo;
+                v[block + k - 1 - a] = L::permute(hi, reverse);
+            }
+        }
+        for (size_t j = k / 4; j > 0; j /= 2) {
+            for (size_t r = 0; r < count; r++) {
+                if ((r & j) == 0) {
+                    typename L::Vector lo = L::min(v[r], v[r + j]);
+                    v[r + j] = L::max(v[r], v[r + j]);
+                    v[r] = lo;
+                }
+            }
+        }
+        for (size_t r = 0; r < count; r++)
+            v[r] = cleanLanes<L>(v[r]);
+    }
+}
+
+template <typename L>
+static AVX2_TARGET void networkSortAvx2(typename L::Scalar* data, size_t n) {
+    typedef typename L::Scalar T;
+    T padded[NETWORK_MAX];
+    size_t size = networkSize(n);
+    std::copy(data, data + n, padded);
+    std::fill(padded + n, padded + size, padValue<T>());
+
+    typename L::Vector v[NETWORK_MAX / 8];
+    for (size_t r = 0; r < size / 8; r++)
+        v[r] = L::load(padded + 8 * r);
+    sortRegisters<L>(v, size / 8);
+    for (size_t r = 0; r < size / 8; r++)
+        L::store(padded + 8 * r, v[r]);
+
+    std::copy(padded, padded + n, data);
+}
+
+// Each lane keeps the smallest value it has seen and where. Strict comparisons keep the first
+// index in a lane, ties between lanes go to the smaller index
+template <typename L>
+static AVX2_TARGET size_t argminAvx2(const typename L::Scalar* data, size_t n) {
+    typedef typename L::Scalar T;
+    if (n < 16 || n > (size_t) INT_MAX)
+        return argminScalar(data, n);
+
+    typename L::Vector best = L::load(data);
+    __m256i bestIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i index = bestIndex;
+    const __m256i step = _mm256_set1_epi32(8);
+
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        index = _mm256_add_epi32(index, step);
+        typename L::Vector v = L::load(data + i);
+        __m256i smaller = L::less(v, best);
+        best = L::min(best, v);
+        bestIndex = _mm256_blendv_epi8(bestIndex, index, smaller);
+    }
+
+    T values[8];
+    int indices[8];
+    L::store(values, best);
+    _mm256_storeu_si256((__m256i*) indices, bestIndex);
+
+    T value = values[0];
+    size_t result = indices[0];
+    for (int lane = 1; lane < 8; lane++) {
+        if (values[lane] < value || (values[lane] == value && (size_t) indices[lane] < result)) {
+            value = values[lane];
+            result = indices[lane];
+        }
+    }
+    for (; i < n; i++) {
+        if (data[i] < value) {
+            value = data[i];
+            result = i;
+        }
+    }
+    return result;
+}
+
+// For every 8 bit lane mask: the lanes that are set, packed to the front
+struct CompressTable {
+    uint8_t lanes[256][8];
+    uint8_t count[256];
+
+    CompressTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int packed = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane))
+                    lanes[mask][packed++] = (uint8_t) lane;
+            }
+            count[mask] = (uint8_t) packed;
+            for (int lane = packed; lane < 8; lane++)
+                lanes[mask][lane] = 0;
+        }
+    }
+};
+
+static const CompressTable& compressTable() {
+    static const CompressTable table;
+    return table;
+}
+
+// Smaller values are packed into the front of out, the rest into the back. The masked stores
+// only write the packed lanes so neither side runs over the other
+template <typename L>
+static AVX2_TARGET size_t partitionAvx2(const typename L::Scalar* in, typename L::Scalar* out, size_t n, typename L::Scalar pivot) {
+    const CompressTable& table = compressTable();
+    const __m256i laneIds = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    typename L::Vector pivots = L::set1(pivot);
+
+    size_t left = 0, right = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        typename L::Vector v = L::load(in + i);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(L::less(v, pivots)));
+        int smaller = table.count[mask];
+        int larger = 8 - smaller;
+
+        __m256i lowLanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) table.lanes[mask]));
+        __m256i highLanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) table.lanes[~mask & 0xFF]));
+
+        L::maskStore(out + left, _mm256_cmpgt_epi32(_mm256_set1_epi32(smaller), laneIds), L::permute(v, lowLanes));
+        right -= larger;
+        L::maskStore(out + right, _mm256_cmpgt_epi32(_mm256_set1_epi32(larger), laneIds), L::permute(v, highLanes));
+        left += smaller;
+    }
+    for (; i < n; i++) {
+        if (in[i] < pivot)
+            out[left++] = in[i];
+        else
+            out[--right] = in[i];
+    }
+    return left;
+}
+
+#endif
+
+
+// ------------------------------------ kernels -------------------------------------
+
+void networkSort(int* data, size_t n) {
+    if (n < 2)
+        return;
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2) {
+        networkSortAvx2<IntLanes>(data, n);
+        return;
+    }
+#endif
+    networkSortScalar(data, n);
+}
+
+void networkSort(float* data, size_t n) {
+    if (n < 2)
+        return;
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2) {
+        networkSortAvx2<FloatLanes>(data, n);
+        return;
+    }
+#endif
+    networkSortScalar(data, n);
+}
+
+size_t networkComparators(size_t n) {
+    if (n < 2)
+        return 0;
+    size_t size = networkSize(n);
+    size_t stages = 0;
+    for (size_t k = 2; k <= size; k *= 2) {
+        for (size_t j = k; j > 1; j /= 2)
+            stages++;
+    }
+    return stages * size / 2;
+}
+
+size_t argmin(const int* data, size_t n) {
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2)
+        return argminAvx2<IntLanes>(data, n);
+#endif
+    return argminScalar(data, n);
+}
+
+size_t argmin(const float* data, size_t n) {
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2)
+        return argminAvx2<FloatLanes>(data, n);
+#endif
+    return argminScalar(data, n);
+}
+
+size_t partitionLess(const int* in, int* out, size_t n, int pivot) {
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2)
+        return partitionAvx2<IntLanes>(in, out, n, pivot);
+#endif
+    return partitionScalar(in, out, n, pivot);
+}
+
+size_t partitionLess(const float* in, float* out, size_t n, float pivot) {
+#ifdef SORT_KERNELS_X86
+    if (currentLevel == SIMD_AVX2)
+        return partitionAvx2<FloatLanes>(in, out, n, pivot);
+#endif
+    return partitionScalar(in, out, n, pivot);
+}
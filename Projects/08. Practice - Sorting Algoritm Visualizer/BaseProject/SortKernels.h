@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+
+// Branch free building blocks for the sorts' hot loops. Every kernel has an AVX2 version and a
+// scalar fallback with the same results, picked at runtime from what the CPU supports.
+
+enum Simd_Level {
+    SIMD_SCALAR,
+    SIMD_AVX2
+};
+
+// the level the kernels currently use (the best one the CPU supports unless overridden)
+Simd_Level simdLevel();
+// forces a level, e.g. to compare against scalar. Clamped to what the CPU supports
+void setSimdLevel(Simd_Level level);
+bool simdSupported(Simd_Level level);
+const char* simdLevelName(Simd_Level level);
+
+
+// largest range the sorting networks handle
+const size_t NETWORK_MAX = 64;
+
+// Sorts n <= NETWORK_MAX values with a bitonic network padded up to 8, 16, 32 or 64 elements.
+// Floats must not be NaN
+void networkSort(int* data, size_t n);
+void networkSort(float* data, size_t n);
+// comparators in the network used for n elements
+size_t networkComparators(size_t n);
+
+// index of the first smallest value, n > 0
+size_t argmin(const int* data, size_t n);
+size_t argmin(const float* data, size_t n);
+
+// Copies in[0, n) to out with every value < pivot first. Returns how many were smaller.
+// Neither side keeps its order, and in and out must not overlap
+size_t partitionLess(const int* in, int* out, size_t n, int pivot);
+size_t partitionLess(const float* in, float* out, size_t n, float pivot);
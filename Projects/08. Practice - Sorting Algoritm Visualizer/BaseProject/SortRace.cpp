@@ -0,0 +1,116 @@
+#include "SortRace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "ParallelSort.h"
+
+RaceLane::RaceLane(const SortAlgorithm* algorithm, const std::vector<int>& values) : algorithm(algorithm), data(values), bars(data) {
+}
+
+
+SortRace::SortRace(const std::vector<const SortAlgorithm*>& algorithms, const std::vector<int>& data) {
+    for (const SortAlgorithm* algorithm : algorithms)
+        lanes.emplace_back(new RaceLane(algorithm, data));
+
+    // as square a grid as fits the lanes
+    gridColumns = std::max<size_t>(1, (size_t) std::ceil(std::sqrt((double) lanes.size())));
+    gridRows = std::max<size_t>(1, (lanes.size() + gridColumns - 1) / gridColumns);
+}
+
+SortRace::~SortRace() {
+    stop();
+}
+
+void SortRace::start() {
+    stop();
+    // the pool is made here on the main thread, and can't be rebuilt while lanes might be using it
+    holdSortThreads();
+    holding = true;
+    finished = 0;
+    for (std::unique_ptr<RaceLane>& lane : lanes) {
+        lane->steps = 0;
+        lane->comparisons = 0;
+        lane->place = 0;
+        lane->runner.start(lane->algorithm, lane->data);
+    }
+}
+
+void SortRace::stop() {
+    // a lane's thread can be blocked on another lane's full queue while it runs one of that lane's
+    // pool tasks, so every lane is cancelled before any is joined
+    for (std::unique_ptr<RaceLane>& lane : lanes)
+        lane->runner.cancel();
+    for (std::unique_ptr<RaceLane>& lane : lanes)
+        lane->runner.join();
+    if (holding)
+        releaseSortThreads();
+    holding = false;
+}
+
+std::vector<RaceLane*> SortRace::replay(size_t max_changes) {
+    std::vector<RaceLane*> done;
+    std::vector<SortEvent> events;
+    for (std::unique_ptr<RaceLane>& lane : lanes) {
+        if (lane->place != 0)
+            continue;
+
+        events.clear();
+        lane->runner.poll(events, max_changes);
+        for (const SortEvent& event : events) {
+            switch (event.type) {
+            case EVENT_SWAP:
+                std::swap(lane->data[event.a], lane->data[event.b]);
+                lane->bars.changed(event.a, event.thread);
+                lane->bars.changed(event.b, event.thread);
+                lane->steps++;
+                break;
+            case EVENT_WRITE:
+                lane->data[event.a] = event.value;
+                lane->bars.changed(event.a, event.thread);
+                lane->steps++;
+                break;
+            case EVENT_COMPARE:
+            case EVENT_COMPARE_VALUES:
+                lane->comparisons++;
+                break;
+            case EVENT_READ:
+            case EVENT_SCRATCH_READ:
+            case EVENT_SCRATCH_WRITE:
+                break;
+            }
+        }
+
+        if (lane->runner.finished()) {
+            lane->comparisons = lane->runner.counters().comparisons;
+            lane->place = ++finished;
+            done.push_back(lane.get());
+        }
+    }
+    // every lane's thread has finished, so they can be joined and the pool let go
+    if (!running())
+        stop();
+    return done;
+}
+
+void SortRace::tile(size_t i, int width, int height, int* x, int* y, int* w, int* h) const {
+    size_t column = i % gridColumns, row = i / gridColumns;
+    *w = (int) (width / gridColumns);
+    *h = (int) (height / gridRows);
+    *x = (int) column * *w;
+    // GL viewports start at the bottom, the first row goes at the top
+    *y = height - (int) (row + 1) * *h;
+}
+
+std::string SortRace::status() const {
+    std::stringstream status;
+    for (size_t i = 0; i < lanes.size(); i++) {
+        if (i > 0)
+            status << " | ";
+        status << lanes[i]->algorithm->name << ' ' << lanes[i]->steps << '/' << lanes[i]->comparisons;
+        if (lanes[i]->place != 0)
+            status << " #" << lanes[i]->place;
+    }
+    return status.str();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Sort.h"
+#include "SortRunner.h"
+#include "BarColumns.h"
+
+// One algorithm of a race: its own runner thread sorting a copy of the dataset, and the
+// replayed copy its columns are drawn from
+struct RaceLane {
+    const SortAlgorithm* algorithm;
+    std::vector<int> data;
+    BarColumns bars;
+    SortRunner runner;
+
+    uint64_t steps = 0;        // swaps and writes replayed so far
+    // comparisons replayed so far, of array elements and of values already read
+    uint64_t comparisons = 0;
+    size_t place = 0;          // finishing position, 0 while still sorting
+
+    RaceLane(const SortAlgorithm* algorithm, const std::vector<int>& values);
+};
+
+// Runs several algorithms side by side on the same dataset, one runner thread per lane.
+// Every lane is replayed at the same number of swaps/writes per frame, so lanes finish in order
+// of the steps they needed as long as their threads stay ahead of the replay. Lanes are drawn in a grid of tiles
+// with one column per pixel of their tile, so a frame stays O(screen) however many lanes run.
+class SortRace {
+public:
+    SortRace(const std::vector<const SortAlgorithm*>& algorithms, const std::vector<int>& data);
+    ~SortRace();
+
+    void start();
+    void stop();
+
+    // replays up to max_changes swaps/writes in every lane that is still sorting. Returns the
+    // lanes that finished during this call
+    std::vector<RaceLane*> replay(size_t max_changes);
+
+    bool running() const { return finished < lanes.size(); }
+    size_t count() const { return lanes.size(); }
+    RaceLane& lane(size_t i) { return *lanes[i]; }
+
+    // pixel rectangle of lane i in a width x height framebuffer, first lane top left
+    void tile(size_t i, int width, int height, int* x, int* y, int* w, int* h) const;
+
+    // "quick 1200/3400 | merge 900/2100 ..." steps/comparisons per lane, for the window title
+    std::string status() const;
+
+private:
+    std::vector<std::unique_ptr<RaceLane>> lanes;
+    size_t gridColumns;
+    size_t gridRows;
+    size_t finished = 0;
+    bool holding = false;  // the sort pool, from start() until the lanes' threads are joined
+};
@@ -0,0 +1,87 @@
+#include "SortRunner.h"
+
+SortRunner::SortRunner(size_t capacity) {
+    this->capacity = capacity;
+}
+
+SortRunner::~SortRunner() {
+    stop();
+}
+
+void SortRunner::start(const SortAlgorithm* algorithm, const std::vector<int>& data) {
+    stop();
+
+    std::lock_guard<std::mutex> guard(lock);
+    working = data;
+    events.clear();
+    started = true;
+    done = false;
+    cancelled = false;
+    result = SortCounters();
+
+    worker = std::thread([this, algorithm] {
+        SortView view(working);
+        view.recorder = this;
+        algorithm->run(view);
+
+        std::lock_guard<std::mutex> guard(lock);
+        result = view.counters;
+        done = true;
+    });
+}
+
+void SortRunner::stop() {
+    cancel();
+    join();
+}
+
+void SortRunner::cancel() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        cancelled = true;
+    }
+    space.notify_all();
+}
+
+void SortRunner::join() {
+    if (worker.joinable())
+        worker.join();
+}
+
+void SortRunner::record(const SortEvent& event) {
+    std::unique_lock<std::mutex> guard(lock);
+    space.wait(guard, [this] { return events.size() < capacity || cancelled; });
+    if (cancelled)
+        return;
+    events.push_back(event);
+}
+
+void SortRunner::poll(std::vector<SortEvent>& out, size_t max_changes) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t changes = 0;
+        while (!events.empty() && changes < max_changes) {
+            const SortEvent& event = events.front();
+            if (event.type == EVENT_SWAP || event.type == EVENT_WRITE)
+                changes++;
+            out.push_back(event);
+            events.pop_front();
+        }
+    }
+    space.notify_all();
+}
+
+bool SortRunner::running() {
+    std::lock_guard<std::mutex> guard(lock);
+    return started && !(done && events.empty());
+}
+
+bool SortRunner::finished() {
+    std::lock_guard<std::mutex> guard(lock);
+    return done && events.empty();
+}
+
+SortCounters SortRunner::counters() {
+    std::lock_guard<std::mutex> guard(lock);
+    return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Sort.h"
+
+
+// Runs an algorithm on a background thread against its own copy of the data and queues its
+// events so the render loop can replay them at whatever speed it likes. The queue is bounded:
+// once `capacity` events are waiting the algorithm blocks until the renderer catches up.
+class SortRunner : public SortRecorder {
+public:
+    SortRunner(size_t capacity = 1 << 16);
+    ~SortRunner();
+
+    void start(const SortAlgorithm* algorithm, const std::vector<int>& data);
+    // cancel() and join(). Runners that share the sort pool can be running each other's tasks, so
+    // those have to all be cancelled before any is joined
+    void stop();
+    // unblocks the algorithm and makes it skip the rest of its events, without waiting for it
+    void cancel();
+    void join();
+
+    void record(const SortEvent& event) override;
+
+    // Moves events into `out` until `max_changes` swaps/writes have been taken. Reads and
+    // comparisons don't change the array so they don't count against the budget
+    void poll(std::vector<SortEvent>& out, size_t max_changes);
+
+    bool running();
+    // the algorithm is done and every event has been polled
+    bool finished();
+    SortCounters counters();
+
+private:
+    std::vector<int> working;
+    std::thread worker;
+
+    std::mutex lock;
+    std::condition_variable space;
+    std::deque<SortEvent> events;
+    size_t capacity;
+
+    bool started = false;
+    bool done = false;
+    bool cancelled = false;
+    SortCounters result;
+};
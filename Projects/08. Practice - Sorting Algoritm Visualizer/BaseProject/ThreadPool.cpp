@@ -0,0 +1,127 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+// which pool (if any) the current thread works for
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local unsigned int currentIndex = 0;
+
+
+ThreadPool::ThreadPool(unsigned int threads) {
+    pending = 0;
+    threads = std::max(1u, threads);
+
+    for (unsigned int i = 0; i < threads; i++)
+        queues.emplace_back(new TaskQueue());
+    // queue 0 belongs to whichever outside thread is waiting
+    for (unsigned int i = 1; i < threads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+unsigned int ThreadPool::size() const {
+    return (unsigned int) queues.size();
+}
+
+unsigned int ThreadPool::currentWorker() {
+    return currentPool != nullptr ? currentIndex : 0;
+}
+
+unsigned int ThreadPool::queueIndex() const {
+    return currentPool == this ? currentIndex : 0;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    TaskQueue& queue = *queues[queueIndex()];
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        pending++;
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::runPending() {
+    std::function<void()> task;
+    if (!popTask(queueIndex(), task))
+        return false;
+    task();
+    return true;
+}
+
+bool ThreadPool::popTask(unsigned int index, std::function<void()>& task) {
+    // newest of our own work first, it's still warm in cache
+    {
+        TaskQueue& own = *queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending--;
+            return true;
+        }
+    }
+    // otherwise steal the oldest (and usually biggest) task from someone else
+    for (unsigned int k = 1; k < queues.size(); k++) {
+        TaskQueue& victim = *queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned int index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (runPending())
+            continue;
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this] { return stopping || pending > 0; });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool) {
+    outstanding = 0;
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    outstanding++;
+    pool.submit([this, task] {
+        task();
+        outstanding--;
+    });
+}
+
+void TaskGroup::wait() {
+    while (outstanding > 0) {
+        if (!pool.runPending())
+            std::this_thread::yield();
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// A work-stealing pool. Every worker owns a deque: it pushes and pops its own work at the back
+// and idle workers steal from the front of everyone else's. A pool of N threads starts N - 1
+// workers; the thread that waits on a TaskGroup is the N-th and runs tasks while it waits.
+class ThreadPool {
+public:
+    ThreadPool(unsigned int threads);
+    ~ThreadPool();
+
+    unsigned int size() const;
+    void submit(std::function<void()> task);
+    // runs one queued task on the calling thread. Returns false if there was nothing to run
+    bool runPending();
+
+    // index of the pool thread running the caller, 0 for threads outside any pool
+    static unsigned int currentWorker();
+
+private:
+    struct TaskQueue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<int> pending;
+    bool stopping = false;
+
+    unsigned int queueIndex() const;
+    bool popTask(unsigned int index, std::function<void()>& task);
+    void workerLoop(unsigned int index);
+};
+
+
+// Fork/join helper: run() queues work on the pool, wait() helps out until all of it is done
+class TaskGroup {
+public:
+    TaskGroup(ThreadPool& pool);
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> outstanding;
+};
@@ -16,7 +16,22 @@
 #include <fstream>
 #include <sstream>
 #include <stack>
-
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <cstddef>
+
+#include "Sort.h"
+#include "ParallelSort.h"
+#include "SortRunner.h"
+#include "Dataset.h"
+#include "BarColumns.h"
+#include "ExternalSort.h"
+#include "CacheSimulator.h"
+#include "SortRace.h"
 
 // Handles Window size changes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -27,24 +42,49 @@ void handle_input(GLFWwindow* window);
 // Interprets txt data to an int array
 std::vector<int> get_data(const char* location);
 
-// selection sort
-void swap(std::vector<int>* data, int index1, int index2);
-int iterateOnce(std::vector<int>* data, int current_index);
+// Applies a replayed event to the displayed data and the columns drawn from it
+void apply_event(const SortEvent& event, std::vector<int>& data, BarColumns& bars);
+
+// Refreshes the columns for a viewport `pixels` wide and draws them from columnVBO
+void draw_columns(BarColumns& bars, unsigned int columnVBO, int pixels, Shader& shader);
 
 
 // Screen settings
 const unsigned int WIDTH  = 800;
 const unsigned int HEIGHT = 600;
 bool runSort = false;
+const SortAlgorithm* algorithm = &sortAlgorithms()[0];  // picked with the number keys
 
 // delta time
 float deltaTime = 0.0f;	// Time between current frame and last frame
 float lastFrame = 0.0f; // Time of last frame
 
-float speed = 0.001f;
+float speed = 0.001f;  // seconds per swap/write replayed
+
+// cache heatmap: replayed accesses go through a simulated cache, columns glow with their misses
+bool showHeat = false;
+const float HEAT_HALF_LIFE = 0.25f;  // seconds
 
+// external sort mode: files in the working directory and how many columns are sampled from them
+const char* EXTERNAL_INPUT  = "external_input.bin";
+const char* EXTERNAL_OUTPUT = "external_sorted.bin";
+const size_t EXTERNAL_COLUMNS = 4096;
 
-int main() {
+// bar colour for each thread, thread 0 (the main sorting thread) stays white
+const glm::vec3 THREAD_COLORS[] = {
+    glm::vec3(1.0f, 1.0f, 1.0f),
+    glm::vec3(0.9f, 0.3f, 0.3f),
+    glm::vec3(0.3f, 0.9f, 0.3f),
+    glm::vec3(0.3f, 0.5f, 1.0f),
+    glm::vec3(0.9f, 0.9f, 0.3f),
+    glm::vec3(0.9f, 0.4f, 0.9f),
+    glm::vec3(0.3f, 0.9f, 0.9f),
+    glm::vec3(1.0f, 0.6f, 0.2f),
+};
+const unsigned int THREAD_COLOR_COUNT = sizeof(THREAD_COLORS) / sizeof(THREAD_COLORS[0]);
+
+
+int main(int argc, char** argv) {
     // GLFW WINDOW HINTS
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -68,19 +108,71 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
 
-    // to be sorted
-    std::vector<int> sortData = get_data("data.txt");
+    // to be sorted: data.txt, `BaseProject <size>` for a random array of any size,
+    // `BaseProject --external <size> [memory MB]` for a file on disk that may not fit in memory, or
+    // `BaseProject --race <size> [quick,merge,...]` to race several algorithms on the same array.
+    // In external mode sortData only holds one sample per column
+    std::vector<int> sortData;
+    std::unique_ptr<DownsampledView> externalView;
+    ExternalSortOptions externalOptions;
+    std::unique_ptr<SortRace> race;
+    if (argc > 2 && strcmp(argv[1], "--race") == 0) {
+        sortData = generateDataset(DATASET_RANDOM, std::strtoull(argv[2], nullptr, 10), 42);
+        std::vector<const SortAlgorithm*> lanes;
+        std::stringstream names(argc > 3 ? argv[3] : "");
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            const SortAlgorithm* lane = findSortAlgorithm(name.c_str());
+            if (lane == nullptr) {
+                std::cout << "ERROR unknown algorithm " << name << "\n";
+                glfwTerminate();
+                return -1;
+            }
+            lanes.push_back(lane);
+        }
+        if (lanes.empty()) {
+            for (const SortAlgorithm& lane : sortAlgorithms())
+                lanes.push_back(&lane);
+        }
+        race.reset(new SortRace(lanes, sortData));
+    }
+    else if (argc > 2 && strcmp(argv[1], "--external") == 0) {
+        uint64_t size = std::strtoull(argv[2], nullptr, 10);
+        if (argc > 3)
+            externalOptions.memoryBytes = (size_t) std::strtoull(argv[3], nullptr, 10) << 20;
+        std::cout << "Writing " << size << " elements to " << EXTERNAL_INPUT << "\n";
+        if (!writeDatasetFile(EXTERNAL_INPUT, DATASET_RANDOM, size, 42)) {
+            glfwTerminate();
+            return -1;
+        }
+        externalView.reset(new DownsampledView(size, EXTERNAL_COLUMNS));
+        externalOptions.view = externalView.get();
+        sortData.resize(externalView->columns());
+        for (size_t i = 0; i < sortData.size(); i++)
+            fillDataset(DATASET_RANDOM, size, 42, externalView->position(i), &sortData[i], 1);
+    }
+    else if (argc > 1)
+        sortData = generateDataset(DATASET_RANDOM, std::strtoull(argv[1], nullptr, 10), 42);
+    else
+        sortData = get_data("data.txt");
+    if (sortData.empty()) {
+        std::cout << "ERROR nothing to sort\n";
+        glfwTerminate();
+        return -1;
+    }
 
-    float data_length = 2.0f / sortData.size();  // 2 = 1 - (-1)
     float max_height = *std::max_element(sortData.begin(), sortData.end());  // max in vector
-    float min_height = *std::min_element(sortData.begin(), sortData.end());  // min in vector
 
+    // at most one column per pixel, each one summarising the elements under it
+    BarColumns bars(sortData);
+
+    // one column, instanced once per column by the vertex shader
     float rectangle []{
-        // Positions                        // Color
-         data_length / -2.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // BL
-         data_length /  2.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // BR
-         data_length /  2.0f,  1.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // TR
-         data_length / -2.0f,  1.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // TL
+        // Positions          // Color
+         0.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // BL
+         1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // BR
+         1.0f,  1.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // TR
+         0.0f,  1.0f,  0.0f,  1.0f, 1.0f, 1.0f,  // TL
     };
 
     unsigned int indices[]{
@@ -94,10 +186,11 @@ int main() {
 
 
     // Creating Objects to send to GPU
-    unsigned int VBO, VAO, EBO;
+    unsigned int VBO, VAO, EBO, columnVBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
+    glGenBuffers(1, &columnVBO);
 
     // Binding VAO 
     glBindVertexArray(VAO);
@@ -119,13 +212,39 @@ int main() {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*) (3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    // Columns, one per instance. Pointed at a column buffer by draw_columns
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
     
     // Unbinding
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    int current_index = 0;
+    // the sort runs on its own thread(s), we replay its events
+    SortRunner runner;
+    std::vector<SortEvent> events;
     float dt = 0;
+    std::unique_ptr<CacheSimulator> cache;  // a fresh one per sort
+
+    // race mode: a column buffer per lane
+    std::vector<unsigned int> raceVBOs(race != nullptr ? race->count() : 0);
+    if (!raceVBOs.empty())
+        glGenBuffers((GLsizei) raceVBOs.size(), raceVBOs.data());
+    bool raceStarted = false;
+    float titleTime = 0.0f;
+
+    // the external sort runs to completion on its own thread, closing the window waits for it
+    std::thread externalWorker;
+    std::atomic<bool> externalDone(false);
+    ExternalSortStats externalStats;
+
+    elementShader.use();
+    elementShader.setFloat("max_height", max_height);
+    for (unsigned int i = 0; i < THREAD_COLOR_COUNT; i++)
+        elementShader.setVec3("threadColors[" + std::to_string(i) + "]", THREAD_COLORS[i]);
 
     // RENDER LOOP
     while (!glfwWindowShouldClose(window)) {
@@ -147,38 +266,111 @@ int main() {
         // Bind the VAO
         glBindVertexArray(VAO);
 
-        // create transformations
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::mat4 view = glm::mat4(1.0f);
-        glm::mat4 projection = glm::mat4(1.0f);
-
-        float dx = -1.0f + data_length/2;
-        for (int i = 0; i < sortData.size(); i++) {
-            model = glm::mat4(1.0f);
-            view = glm::mat4(1.0f);
-            projection = glm::mat4(1.0f);
-
-            view = glm::translate(view, glm::vec3(dx, -1.0f, 0.0f));
-            dx += data_length;
-            
-            float height = sortData[i] / max_height;
-
-            elementShader.setFloat("height", height);
-            elementShader.setMat4("model", model);
-            elementShader.setMat4("view",  view);
-            elementShader.setMat4("projection", projection);
-
-            // Draw triangle
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        elementShader.setBool("showHeat", showHeat);
+        if (race != nullptr) {
+            // every lane in its own tile with a one pixel gap, one column per pixel of the tile
+            for (size_t i = 0; i < race->count(); i++) {
+                int x, y, w, h;
+                race->tile(i, width, height, &x, &y, &w, &h);
+                glViewport(x + 1, y + 1, std::max(1, w - 2), std::max(1, h - 2));
+                draw_columns(race->lane(i).bars, raceVBOs[i], std::max(1, w - 2), elementShader);
+            }
+            glViewport(0, 0, width, height);
         }
-        
-        if (runSort) {
-            dt += deltaTime;
-            if (dt > speed) {
-                current_index = iterateOnce(&sortData, current_index);
+        else
+            draw_columns(bars, columnVBO, width, elementShader);
+
+
+        if (race != nullptr) {
+            if (runSort && !raceStarted) {
+                std::cout << "Racing " << race->count() << " algorithms on " << sortData.size() << " elements\n";
+                race->start();
+                raceStarted = true;
                 dt = 0;
             }
-
+            if (raceStarted) {
+                dt += deltaTime;
+                size_t changes = (size_t) (dt / speed);
+                if (changes > 0) {
+                    for (RaceLane* lane : race->replay(changes)) {
+                        std::cout << lane->place << ". " << lane->algorithm->name << ": " << lane->steps << " steps, "
+                                  << lane->comparisons << " comparisons, " << lane->runner.counters().swaps << " swaps\n";
+                    }
+                    dt -= changes * speed;
+                }
+                // steps/comparisons per lane, a few times a second
+                if (currentFrame - titleTime > 0.2f || !race->running()) {
+                    glfwSetWindowTitle(window, race->status().c_str());
+                    titleTime = currentFrame;
+                }
+                if (!race->running()) {
+                    runSort = false;
+                    raceStarted = false;
+                }
+            }
+        }
+        else if (externalView != nullptr) {
+            if (runSort && !externalWorker.joinable()) {
+                std::cout << "External sort on " << sortThreads() << " threads with " << (externalOptions.memoryBytes >> 20) << " MB\n";
+                externalWorker = std::thread([&] {
+                    if (!externalSort(EXTERNAL_INPUT, EXTERNAL_OUTPUT, externalOptions, &externalStats))
+                        std::cout << "ERROR external sort failed\n";
+                    externalDone = true;
+                });
+            }
+            events.clear();
+            externalView->poll(events);
+            for (const SortEvent& event : events)
+                apply_event(event, sortData, bars);
+            if (externalDone && runSort) {
+                std::cout << "external: " << externalStats.runs << " runs sorted in " << externalStats.runMs << " ms, merged in "
+                          << externalStats.mergeMs << " ms\n";
+                runSort = false;
+                externalWorker.join();
+                externalDone = false;
+            }
+        }
+        else if (runSort && !runner.running()) {
+            std::cout << "Sorting with " << algorithm->name << " on " << sortThreads() << " threads\n";
+            runner.start(algorithm, sortData);
+            cache.reset(new CacheSimulator());
+            dt = 0;
+        }
+        if (runner.running()) {
+            dt += deltaTime;
+            size_t changes = (size_t) (dt / speed);
+            if (changes > 0) {
+                events.clear();
+                runner.poll(events, changes);
+                for (const SortEvent& event : events) {
+                    apply_event(event, sortData, bars);
+                    // the levels missed are shared out between the indices the event touched
+                    cache->record(event);
+                    float cost = (float) cache->lastCost();
+                    // only array accesses have a bar to heat up
+                    if (event.type == EVENT_COMPARE_VALUES || event.type == EVENT_SCRATCH_READ || event.type == EVENT_SCRATCH_WRITE)
+                        continue;
+                    if (event.type == EVENT_COMPARE || event.type == EVENT_SWAP) {
+                        bars.heat(event.a, cost * 0.5f);
+                        bars.heat(event.b, cost * 0.5f);
+                    }
+                    else
+                        bars.heat(event.a, cost);
+                }
+                dt -= changes * speed;
+            }
+            if (runner.finished()) {
+                SortCounters counters = runner.counters();
+                std::cout << algorithm->name << ": " << counters.comparisons << " comparisons, " << counters.swaps << " swaps\n";
+                for (size_t level = 0; level < cache->levels().size(); level++) {
+                    CacheCounters levelCounters = cache->counters(level);
+                    std::cout << "  " << cache->levels()[level].name << ": " << levelCounters.hits << " hits, "
+                              << levelCounters.misses << " misses, " << levelCounters.evictions << " evictions\n";
+                }
+                runSort = false;
+            }
         }
 
         glBindVertexArray(0);
@@ -187,6 +379,11 @@ int main() {
         glfwPollEvents();
     }
 
+    runner.stop();
+    if (race != nullptr)
+        race->stop();
+    if (externalWorker.joinable())
+        externalWorker.join();
     glfwTerminate();
     return 0;
 }
@@ -203,6 +400,28 @@ void handle_input(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
         runSort = true;
     }
+    // C toggles the cache miss heatmap
+    static bool heatKeyDown = false;
+    bool heatKey = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+    if (heatKey && !heatKeyDown)
+        showHeat = !showHeat;
+    heatKeyDown = heatKey;
+    // 1-9 picks the algorithm before the sort starts
+    if (!runSort) {
+        const std::vector<SortAlgorithm>& algorithms = sortAlgorithms();
+        for (size_t i = 0; i < algorithms.size() && i < 9; i++) {
+            if (glfwGetKey(window, GLFW_KEY_1 + (int) i) == GLFW_PRESS && algorithm != &algorithms[i]) {
+                algorithm = &algorithms[i];
+                std::cout << "Selected " << algorithm->name << "\n";
+            }
+        }
+    }
+    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+        speed = std::max(speed * 0.95f, 0.00001f);
+    }
+    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+        speed = std::min(speed * 1.05f, 0.5f);
+    }
 }
 
 std::vector<int> get_data(const char* location) {
@@ -241,35 +460,38 @@ std::vector<int> get_data(const char* location) {
     return data;
 }
 
-void swap(std::vector<int>* data, int index1, int index2) {
-    // Pointers are fun
-    int temp = data->operator[](index1);
-    data->operator[](index1) = data->operator[](index2);
-    data->operator[](index2) = temp;
-}
-
-int iterateOnce(std::vector<int>* data, int current_index) {
-    if (current_index > data->size() - 2) {
-        runSort = false;
-    }
-    // I hate this code but it works
-    int lowest = data->operator[](current_index);
-    int lowest_index = -1;
-
-    int i = current_index;
-    while (i < data->size() - 1) {
-        i++;
-        int cur = data->operator[](i);
-
-        if (cur < lowest) {
-            lowest = cur;
-            lowest_index = i;
-        }
+void apply_event(const SortEvent& event, std::vector<int>& data, BarColumns& bars) {
+    switch (event.type) {
+    case EVENT_SWAP:
+        std::swap(data[event.a], data[event.b]);
+        bars.changed(event.a, event.thread);
+        bars.changed(event.b, event.thread);
+        break;
+    case EVENT_WRITE:
+        data[event.a] = event.value;
+        bars.changed(event.a, event.thread);
+        break;
+    case EVENT_READ:
+    case EVENT_COMPARE:
+    case EVENT_COMPARE_VALUES:
+    case EVENT_SCRATCH_READ:
+    case EVENT_SCRATCH_WRITE:
+        break;
     }
+}
 
-    if (lowest_index != -1)
-        swap(data, current_index, lowest_index);
+void draw_columns(BarColumns& bars, unsigned int columnVBO, int pixels, Shader& shader) {
+    // only the columns that changed since last frame are re-summarised
+    bars.resize(pixels);
+    bool cooled = bars.cool(std::pow(0.5f, deltaTime / HEAT_HALF_LIFE));
+    glBindBuffer(GL_ARRAY_BUFFER, columnVBO);
+    if (bars.update() || cooled)
+        glBufferData(GL_ARRAY_BUFFER, bars.count() * sizeof(BarColumn), bars.columns().data(), GL_STREAM_DRAW);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(BarColumn), (void*) 0);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(BarColumn), (void*) offsetof(BarColumn, heat));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    return current_index + 1;
+    // Draw every column at once
+    shader.setFloat("columns", (float) bars.count());
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei) bars.count());
 }
-
@@ -2,8 +2,16 @@
 
 out vec4 FragColor;
 in vec3 color;
+in float value;
+flat in vec3 range;
 
 void main()
 {
-    FragColor = vec4(color, 1.0);
+    // every element of the column reaches its min, the mean and max bands are dimmer
+    float shade = 1.0;
+    if (value > range.y)
+        shade = 0.4;
+    else if (value > range.x)
+        shade = 0.7;
+    FragColor = vec4(color * shade, 1.0);
 }
\ No newline at end of file
@@ -1,21 +1,33 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec4 aColumn;  // per instance: low, mean, high, thread
+layout (location = 3) in float aHeat;   // per instance: recent cache misses
 
 out vec3 color;
+out float value;
+flat out vec3 range;
 
-uniform float height;
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform float columns;
+uniform float max_height;
+uniform vec3 threadColors[8];
+uniform bool showHeat;
 
 void main()
 {
-    vec3 pos = aPos;
-    if (aPos.y > 0.0f) {
-        pos = vec3(aPos.x, aPos.y * height * 2, aPos.z);
-    }
-    gl_Position = projection * view * model * vec4(pos, 1.0);
+    // the unit quad is stretched over this instance's column, up to its tallest element
+    float x = (gl_InstanceID + aPos.x) * 2.0 / columns;
+    float y = aPos.y * aColumn.z / max_height;
+    gl_Position = vec4(x - 1.0, y * 2.0 - 1.0, aPos.z, 1.0);
 
-    color = aColor;
+    value = aPos.y * aColumn.z;
+    range = aColumn.xyz;
+    color = aColor * threadColors[int(aColumn.w) % 8];
+    if (showHeat) {
+        // cold columns are blue, a few misses per frame turn them yellow then red
+        float heat = 1.0 - exp(-aHeat / 8.0);
+        vec3 hot = heat < 0.5 ? mix(vec3(0.2, 0.3, 1.0), vec3(1.0, 0.9, 0.2), heat * 2.0)
+                              : mix(vec3(1.0, 0.9, 0.2), vec3(1.0, 0.1, 0.1), heat * 2.0 - 1.0);
+        color = aColor * hot;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,355 @@
+// Headless benchmark for the visualizer's sorting algorithms. No window or GL context is created,
+// every algorithm runs straight on a generated dataset and one CSV row is written per run.
+//
+// Usage: Benchmark [--sizes 1000,10000] [--max-exp 8] [--algorithms quick,merge]
+//                  [--datasets random,sorted] [--seed 42] [--threads 1,2,4,8] [--scalar] [--out results.csv]
+//        Benchmark --kernels [--out kernels.csv]
+//        Benchmark --external 1000000000 [--memory 256] [--datasets random] [--threads 1,8] [--out external.csv]
+//        Benchmark --cache L1:32K:8,L2:1M:16,LLC:8M:16 [--max-exp 5] [--algorithms ...] [--out cache.csv]
+//
+// Parallel algorithms run once per entry of --threads. Their speedup column is relative to the
+// first thread count in the list, so listing 1 first gives a classic speedup curve.
+// Small ranges go through the SIMD kernels, which aren't instrumented, so the counters column says
+// "estimated". --scalar keeps every step on the instrumented code for exact counters.
+// --kernels times the SIMD sort kernels on their own instead, scalar against AVX2.
+// --external writes a dataset of that many ints to disk and sorts it out of core with --memory MB,
+// once per dataset and thread count. The files are deleted afterwards.
+// --cache replays every array and scratch buffer access through a simulated cache hierarchy
+// ("default" for the built-in one) and writes one row per cache level instead. Every access is
+// simulated, so sizes default to 10^5 and the SIMD fast paths are off. With --external too, the
+// out-of-core sort is simulated the same way (up to 2^32 ints), as algorithm "external".
+
+#include "Sort.h"
+#include "ParallelSort.h"
+#include "Dataset.h"
+#include "ExternalSort.h"
+#include "CacheSimulator.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+struct BenchmarkOptions {
+    std::vector<size_t> sizes;
+    std::vector<const SortAlgorithm*> algorithms;
+    std::vector<Dataset_Type> datasets;
+    std::vector<unsigned int> threads;
+    uint64_t seed = 42;
+    const char* out = nullptr;
+    bool kernels = false;
+    bool scalar = false;     // no SIMD kernels inside the sorts, the counters are exact
+    uint64_t external = 0;   // elements, 0 = in-memory benchmark
+    size_t memory_mb = 256;  // external sort budget
+    const char* cache = nullptr;  // cache levels to simulate, nullptr = timing benchmark
+    std::vector<CacheConfig> cacheLevels;
+};
+
+// Splits "a,b,c" into its parts
+std::vector<std::string> split_list(const char* list);
+
+// Fills in the options from argv. Returns false if something couldn't be parsed
+bool parse_options(int argc, char** argv, BenchmarkOptions* options);
+
+// One CSV row per dataset and thread count for the out-of-core sort, or per cache level as well
+// with --cache. Returns false if a sort failed
+bool run_external_benchmark(const BenchmarkOptions& options, std::ostream& csv);
+
+// One CSV row per algorithm, dataset, size, thread count and cache level
+void run_cache_benchmark(const BenchmarkOptions& options, std::ostream& csv);
+// The rows of run_cache_benchmark for one sort
+void write_cache_rows(std::ostream& csv, const char* algorithm, Dataset_Type dataset, uint64_t size, uint64_t seed,
+                      unsigned int threads, const CacheSimulator& cache);
+
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parse_options(argc, argv, &options))
+        return -1;
+
+    std::ofstream file;
+    if (options.out != nullptr) {
+        file.open(options.out);
+        if (!file.is_open()) {
+            std::cout << "ERROR opening " << options.out << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& csv = options.out != nullptr ? file : std::cout;
+
+    if (options.kernels) {
+        if (!run_kernel_benchmark(csv)) {
+            std::cout << "ERROR a kernel returned a wrong result" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+    if (options.external > 0)
+        return run_external_benchmark(options, csv) ? 0 : -1;
+    if (options.cache != nullptr) {
+        run_cache_benchmark(options, csv);
+        return 0;
+    }
+
+    csv << "algorithm,dataset,size,seed,threads,comparisons,swaps,reads,writes,bytes_touched,wall_ms,speedup,sorted,counters\n";
+
+    for (size_t size : options.sizes) {
+        for (Dataset_Type dataset : options.datasets) {
+            for (const SortAlgorithm* algorithm : options.algorithms) {
+                if (size > algorithm->maxSize) {
+                    std::cerr << "skipping " << algorithm->name << " at " << size << " elements\n";
+                    continue;
+                }
+
+                std::vector<unsigned int> threadCounts = { 1 };
+                if (algorithm->parallel)
+                    threadCounts = options.threads;
+
+                double baseline_ms = 0.0;
+                for (unsigned int threads : threadCounts) {
+                    setSortThreads(threads);
+
+                    // regenerating is cheaper than keeping a pristine copy of a 10^8 element array around
+                    std::vector<int> data = generateDataset(dataset, size, options.seed);
+                    SortView view(data);
+                    view.kernels = !options.scalar;
+
+                    auto start = std::chrono::steady_clock::now();
+                    algorithm->run(view);
+                    auto end = std::chrono::steady_clock::now();
+                    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                    if (baseline_ms == 0.0)
+                        baseline_ms = ms;
+
+                    csv << algorithm->name << ',' << datasetName(dataset) << ',' << size << ',' << options.seed << ','
+                        << threads << ',' << view.counters.comparisons << ',' << view.counters.swaps << ','
+                        << view.counters.reads << ',' << view.counters.writes << ','
+                        << view.counters.bytesTouched() << ',' << ms << ',' << baseline_ms / ms << ','
+                        << (isSorted(data) ? "yes" : "no") << ',' << (view.counters.estimated ? "estimated" : "exact") << '\n';
+                    csv.flush();
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+
+std::vector<std::string> split_list(const char* list) {
+    std::vector<std::string> parts;
+    std::stringstream stream(list);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty())
+            parts.push_back(part);
+    }
+    return parts;
+}
+
+bool parse_options(int argc, char** argv, BenchmarkOptions* options) {
+    int max_exp = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--kernels") == 0) {
+            options->kernels = true;
+            continue;
+        }
+        if (strcmp(arg, "--scalar") == 0) {
+            options->scalar = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            std::cout << "ERROR missing value for " << arg << std::endl;
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--sizes") == 0) {
+            for (const std::string& size : split_list(value))
+                options->sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+        }
+        else if (strcmp(arg, "--max-exp") == 0) {
+            max_exp = atoi(value);
+        }
+        else if (strcmp(arg, "--algorithms") == 0) {
+            for (const std::string& name : split_list(value)) {
+                const SortAlgorithm* algorithm = findSortAlgorithm(name.c_str());
+                if (algorithm == nullptr) {
+                    std::cout << "ERROR unknown algorithm " << name << std::endl;
+                    return false;
+                }
+                options->algorithms.push_back(algorithm);
+            }
+        }
+        else if (strcmp(arg, "--datasets") == 0) {
+            for (const std::string& name : split_list(value)) {
+                Dataset_Type type;
+                if (!parseDatasetType(name.c_str(), &type)) {
+                    std::cout << "ERROR unknown dataset " << name << std::endl;
+                    return false;
+                }
+                options->datasets.push_back(type);
+            }
+        }
+        else if (strcmp(arg, "--seed") == 0) {
+            options->seed = std::strtoull(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--threads") == 0) {
+            for (const std::string& threads : split_list(value))
+                options->threads.push_back((unsigned int) atoi(threads.c_str()));
+        }
+        else if (strcmp(arg, "--external") == 0) {
+            options->external = std::strtoull(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--memory") == 0) {
+            options->memory_mb = (size_t) std::strtoull(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--cache") == 0) {
+            options->cache = value;
+            if (strcmp(value, "default") == 0)
+                options->cacheLevels = CacheSimulator::defaultLevels();
+            else if (!CacheSimulator::parseLevels(value, &options->cacheLevels)) {
+                std::cout << "ERROR bad cache levels " << value << std::endl;
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--out") == 0) {
+            options->out = value;
+        }
+        else {
+            std::cout << "ERROR unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options->external > UINT32_MAX && options->cache != nullptr) {
+        std::cout << "ERROR --cache only simulates external sorts of up to 2^32 ints" << std::endl;
+        return false;
+    }
+
+    // defaults: 10^3 .. 10^max_exp, every algorithm, every dataset
+    if (max_exp == 0)
+        max_exp = options->cache != nullptr ? 5 : 8;
+    if (options->sizes.empty()) {
+        size_t size = 1000;
+        for (int exp = 3; exp <= max_exp; exp++, size *= 10)
+            options->sizes.push_back(size);
+    }
+    if (options->algorithms.empty()) {
+        for (const SortAlgorithm& algorithm : sortAlgorithms())
+            options->algorithms.push_back(&algorithm);
+    }
+    if (options->datasets.empty()) {
+        options->datasets = { DATASET_RANDOM, DATASET_SORTED, DATASET_REVERSED, DATASET_SAWTOOTH, DATASET_FEW_UNIQUE };
+    }
+    // 1, 2, 4, ... up to the core count
+    if (options->threads.empty()) {
+        unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 1; threads < cores; threads *= 2)
+            options->threads.push_back(threads);
+        options->threads.push_back(cores);
+    }
+    return true;
+}
+
+bool run_external_benchmark(const BenchmarkOptions& options, std::ostream& csv) {
+    const char* input = "external_input.bin";
+    const char* output = "external_sorted.bin";
+
+    ExternalSortOptions sortOptions;
+    sortOptions.memoryBytes = options.memory_mb << 20;
+
+    if (options.cache != nullptr)
+        csv << "algorithm,dataset,size,seed,threads,level,accesses,hits,misses,evictions,writebacks,miss_rate\n";
+    else
+        csv << "dataset,size,seed,threads,memory_mb,runs,run_elements,comparisons,run_ms,merge_ms,wall_ms,mb_per_s,sorted\n";
+    bool ok = true;
+    for (Dataset_Type dataset : options.datasets) {
+        if (!writeDatasetFile(input, dataset, options.external, options.seed))
+            return false;
+
+        for (unsigned int threads : options.threads) {
+            setSortThreads(threads);
+            std::unique_ptr<CacheSimulator> cache;
+            if (options.cache != nullptr)
+                cache.reset(new CacheSimulator(options.cacheLevels));
+            sortOptions.recorder = cache.get();
+            ExternalSortStats stats;
+            if (!externalSort(input, output, sortOptions, &stats)) {
+                ok = false;
+                continue;
+            }
+            bool sorted = isSortedFile(output, input);
+            ok = ok && sorted;
+            if (cache != nullptr) {
+                write_cache_rows(csv, "external", dataset, stats.elements, options.seed, threads, *cache);
+                continue;
+            }
+
+            double ms = stats.runMs + stats.mergeMs;
+            double mb = (double) stats.elements * sizeof(int) / (1 << 20);
+            csv << datasetName(dataset) << ',' << stats.elements << ',' << options.seed << ',' << threads << ','
+                << options.memory_mb << ',' << stats.runs << ',' << stats.runElements << ','
+                << stats.counters.comparisons << ',' << stats.runMs << ',' << stats.mergeMs << ',' << ms << ','
+                << mb / (ms / 1000.0) << ',' << (sorted ? "yes" : "no") << '\n';
+            csv.flush();
+        }
+    }
+    std::remove(input);
+    std::remove(output);
+    return ok;
+}
+
+void run_cache_benchmark(const BenchmarkOptions& options, std::ostream& csv) {
+    csv << "algorithm,dataset,size,seed,threads,level,accesses,hits,misses,evictions,writebacks,miss_rate\n";
+
+    for (size_t size : options.sizes) {
+        for (Dataset_Type dataset : options.datasets) {
+            for (const SortAlgorithm* algorithm : options.algorithms) {
+                if (size > algorithm->maxSize) {
+                    std::cerr << "skipping " << algorithm->name << " at " << size << " elements\n";
+                    continue;
+                }
+
+                std::vector<unsigned int> threadCounts = { 1 };
+                if (algorithm->parallel)
+                    threadCounts = options.threads;
+
+                for (unsigned int threads : threadCounts) {
+                    setSortThreads(threads);
+                    std::vector<int> data = generateDataset(dataset, size, options.seed);
+                    CacheSimulator cache(options.cacheLevels);
+                    SortView view(data);
+                    view.recorder = &cache;
+                    algorithm->run(view);
+                    write_cache_rows(csv, algorithm->name, dataset, size, options.seed, threads, cache);
+                }
+            }
+        }
+    }
+}
+
+void write_cache_rows(std::ostream& csv, const char* algorithm, Dataset_Type dataset, uint64_t size, uint64_t seed,
+                      unsigned int threads, const CacheSimulator& cache) {
+    for (size_t level = 0; level < cache.levels().size(); level++) {
+        CacheCounters counters = cache.counters(level);
+        double missRate = counters.accesses() > 0 ? (double) counters.misses / counters.accesses() : 0.0;
+        csv << algorithm << ',' << datasetName(dataset) << ',' << size << ',' << seed << ','
+            << threads << ',' << cache.levels()[level].name << ',' << counters.accesses() << ','
+            << counters.hits << ',' << counters.misses << ',' << counters.evictions << ','
+            << counters.writebacks << ',' << missRate << '\n';
+    }
+    csv.flush();
+}
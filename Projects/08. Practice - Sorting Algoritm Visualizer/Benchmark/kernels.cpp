@@ -0,0 +1,155 @@
+#include "kernels.h"
+
+#include "SortKernels.h"
+#include "Dataset.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+
+// elements worth of input each pass works through
+const size_t POOL_SIZE = 1 << 20;
+// every measurement runs for at least this long
+const double MIN_MS = 50.0;
+
+struct KernelResult {
+    double ns_per_call;
+    bool checked;
+};
+
+template <typename T>
+static void fill_random(std::vector<T>& values, uint64_t seed) {
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = (T) (int) (randomAt(seed, i) % 1000000);
+}
+
+// Times `run(input)` over freshly randomised input until MIN_MS has been spent inside it. run
+// returns how many kernel calls it made, `check(input)` then verifies them outside the timing
+template <typename T, typename Run, typename Check>
+static KernelResult time_kernel(Run run, Check check) {
+    std::vector<T> input(POOL_SIZE);
+    double ms = 0.0;
+    size_t calls = 0;
+    bool checked = true;
+    for (uint64_t round = 0; ms < MIN_MS; round++) {
+        fill_random(input, round);
+        auto start = std::chrono::steady_clock::now();
+        calls += run(input);
+        auto end = std::chrono::steady_clock::now();
+        ms += std::chrono::duration<double, std::milli>(end - start).count();
+        checked &= check(input);
+    }
+    return { ms * 1e6 / calls, checked };
+}
+
+template <typename T>
+static KernelResult time_network(size_t size) {
+    size_t calls = POOL_SIZE / size;
+    auto run = [&](std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++)
+            networkSort(&input[call * size], size);
+        return calls;
+    };
+    auto check = [&](const std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++) {
+            if (!std::is_sorted(input.begin() + call * size, input.begin() + (call + 1) * size))
+                return false;
+        }
+        return true;
+    };
+    return time_kernel<T>(run, check);
+}
+
+template <typename T>
+static KernelResult time_argmin(size_t size) {
+    size_t calls = POOL_SIZE / size;
+    std::vector<size_t> found(calls);
+    auto run = [&](std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++)
+            found[call] = argmin(&input[call * size], size);
+        return calls;
+    };
+    auto check = [&](const std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++) {
+            auto begin = input.begin() + call * size;
+            if (found[call] != (size_t) (std::min_element(begin, begin + size) - begin))
+                return false;
+        }
+        return true;
+    };
+    return time_kernel<T>(run, check);
+}
+
+template <typename T>
+static KernelResult time_partition(size_t size) {
+    size_t calls = POOL_SIZE / size;
+    std::vector<T> out(POOL_SIZE);
+    std::vector<size_t> smaller(calls);
+    auto run = [&](std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++)
+            smaller[call] = partitionLess(&input[call * size], &out[call * size], size, input[call * size + size / 2]);
+        return calls;
+    };
+    auto check = [&](const std::vector<T>& input) {
+        for (size_t call = 0; call < calls; call++) {
+            T pivot = input[call * size + size / 2];
+            for (size_t i = 0; i < size; i++) {
+                if ((i < smaller[call]) != (out[call * size + i] < pivot))
+                    return false;
+            }
+        }
+        return true;
+    };
+    return time_kernel<T>(run, check);
+}
+
+template <typename T>
+static bool run_type(std::ostream& csv, const char* type) {
+    struct Case {
+        const char* kernel;
+        size_t size;
+        KernelResult (*run)(size_t size);
+    };
+    const Case cases[] = {
+        { "network",   8,       time_network<T> },
+        { "network",   16,      time_network<T> },
+        { "network",   32,      time_network<T> },
+        { "network",   64,      time_network<T> },
+        { "argmin",    64,      time_argmin<T> },
+        { "argmin",    4096,    time_argmin<T> },
+        { "argmin",    1 << 20, time_argmin<T> },
+        { "partition", 64,      time_partition<T> },
+        { "partition", 4096,    time_partition<T> },
+        { "partition", 1 << 20, time_partition<T> },
+    };
+
+    bool all_checked = true;
+    Simd_Level best = simdLevel();
+    for (const Case& test : cases) {
+        double scalar_ns = 0.0;
+        for (Simd_Level level : { SIMD_SCALAR, SIMD_AVX2 }) {
+            if (!simdSupported(level))
+                continue;
+            setSimdLevel(level);
+            KernelResult result = test.run(test.size);
+            if (level == SIMD_SCALAR)
+                scalar_ns = result.ns_per_call;
+            all_checked &= result.checked;
+
+            csv << test.kernel << ',' << type << ',' << test.size << ',' << simdLevelName(level) << ','
+                << result.ns_per_call << ',' << result.ns_per_call / test.size << ','
+                << scalar_ns / result.ns_per_call << ',' << (result.checked ? "yes" : "no") << '\n';
+            csv.flush();
+        }
+    }
+    setSimdLevel(best);
+    return all_checked;
+}
+
+bool run_kernel_benchmark(std::ostream& csv) {
+    csv << "kernel,type,size,simd,ns_per_call,ns_per_element,speedup,checked\n";
+    bool ints = run_type<int>(csv, "int");
+    bool floats = run_type<float>(csv, "float");
+    return ints && floats;
+}
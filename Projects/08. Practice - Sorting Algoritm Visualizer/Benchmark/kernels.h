@@ -0,0 +1,6 @@
+#pragma once
+#include <ostream>
+
+// Times every kernel of SortKernels.h at each SIMD level the CPU supports and writes one CSV
+// row per kernel, element type, size and level. Returns false if any result was wrong
+bool run_kernel_benchmark(std::ostream& csv);
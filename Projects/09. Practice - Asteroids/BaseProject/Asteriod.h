@@ -4,6 +4,7 @@
 
 #include "Settings.h"
 #include "GameObject.h"
+#include "ShaderCache.h"
 
 enum Asteroid_Type {
     ASTEROID_BIG,
@@ -23,7 +24,7 @@ private:
     bool alive = true;
 
 public:
-    Asteroid(float t_direction, glm::vec3 t_position, Asteroid_Type t_atype);
+    Asteroid(float t_direction, glm::vec3 t_position, Asteroid_Type t_atype, ShaderCache* shaders);
     void update(Camera *camera, float deltaTime);
     bool isAlive();
     void destroy();
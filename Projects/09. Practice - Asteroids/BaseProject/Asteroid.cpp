@@ -35,14 +35,14 @@ std::vector<float> Asteroid::getVertices(Asteroid_Type atype) {
     return vertices;
 }
 
-Asteroid::Asteroid(float t_direction, glm::vec3 t_position, Asteroid_Type t_atype) :
+Asteroid::Asteroid(float t_direction, glm::vec3 t_position, Asteroid_Type t_atype, ShaderCache* shaders) :
     GameObject(
         getVertices(t_atype), 
         {
              0,  1,  2,  // 1st triangle
              0,  2,  3,  // 2nd triangle
         },
-        Shader("shaders/asteroid.vs", "shaders/asteroid.fs"),
+        shaders->get("shaders/asteroid.vs", "shaders/asteroid.fs"),
         Image("assets/asteroid1.png", GL_RGBA),
         t_position  // Position
         )
@@ -72,10 +72,10 @@ void Asteroid::update(Camera *camera, float deltaTime) {
     view = glm::translate(view, position);
 
     // Uniforms
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
 }
 
@@ -1,10 +1,10 @@
 #include "Button.h"
 
-Button::Button(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader shader, Image texture, glm::vec3 position) : GameObject(
+Button::Button(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader* shader, Image texture, glm::vec3 position) : GameObject(
     vertexData,
     indexData,
     shader,
-    texture,
+    std::move(texture),
     position
     ) {
     
@@ -16,10 +16,10 @@ void Button::update(GLFWwindow* window, glm::mat4 model, glm::mat4 view, glm::ma
 
     view = glm::translate(view, position);
     
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
 }
 
@@ -16,7 +16,7 @@ private:
     bool pressed = false;
     bool mouse_hovering = false;
 public:
-    Button(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader shader, Image texture, glm::vec3 position);
+    Button(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader* shader, Image texture, glm::vec3 position);
     void update(GLFWwindow* window, glm::mat4 model, glm::mat4 view, glm::mat4 projection);
     bool is_pressed();
 private:
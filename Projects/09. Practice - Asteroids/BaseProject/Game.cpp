@@ -1,6 +1,6 @@
 #include "Game.h"
 
-Game::Game(Camera *camera) {
+Game::Game(Camera *camera, ShaderCache *shaders) : shaders(shaders) {
     this->camera = camera;
     score = 0;
     srand(time(NULL));  // TODO: implement std::random instead of srand
@@ -129,16 +129,14 @@ void Game::shoot(Projectile_Type ptype) {
         return;
     }
     cooldown = 0.25f;
-    Projectile p = Projectile(player.direction, player.position, ptype);
-    projectiles.push_back(p);
+    projectiles.push_back(Projectile(player.direction, player.position, ptype, shaders));
 }
 
 void Game::spawnAsteroid(Asteroid_Type asize, glm::vec3 pos) {  // Asteroid at specified position
     float r = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);  // random float between 0 and 1
     float angle = r * 360;
 
-    Asteroid a = Asteroid(angle, pos, asize);
-    asteroids.push_back(a);
+    asteroids.push_back(Asteroid(angle, pos, asize, shaders));
 }
 
 void Game::spawnAsteroid(Asteroid_Type asize) {  // Asteroid at random position
@@ -11,13 +11,15 @@
 #include "Ship.h"
 #include "Projectile.h"
 #include "Asteriod.h"
+#include "ShaderCache.h"
 
 
 class Game {
 
 public:
     Camera* camera;
-    Ship player = Ship();
+    ShaderCache* shaders;  // set before player is made
+    Ship player = Ship(shaders);
     std::vector<Asteroid> asteroids{};
     std::vector<Projectile> projectiles{};
     float cooldown = 0.0f;
@@ -31,7 +33,7 @@ private:
     int score;
 
 public:
-    Game(Camera *camera);
+    Game(Camera *camera, ShaderCache *shaders);
     void reload();
     void handleInput(GLFWwindow* window);
     void update(GLFWwindow* window);
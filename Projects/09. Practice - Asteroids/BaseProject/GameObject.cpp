@@ -1,6 +1,7 @@
 #include "GameObject.h"
 
-GameObject::GameObject(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader shader, Image texture, glm::vec3 position) {
+GameObject::GameObject(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader* shader, Image texture, glm::vec3 position)
+    : shader(shader), texture(std::move(texture)) {
     indices = indexData;
     this->position = position;
 
@@ -10,6 +11,9 @@ GameObject::GameObject(std::vector<float> vertexData, std::vector<unsigned int>
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
+    GpuResources::created(RESOURCE_VERTEX_ARRAY);
+    GpuResources::created(RESOURCE_BUFFER);
+    GpuResources::created(RESOURCE_BUFFER);
 
     // Binding VAO 
     glBindVertexArray(VAO);
@@ -21,6 +25,10 @@ GameObject::GameObject(std::vector<float> vertexData, std::vector<unsigned int>
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size() * sizeof(unsigned int), &indexData[0], GL_STATIC_DRAW);
 
+    // put down to the texture, the nearest thing the object has to a name
+    GpuResources::track(RESOURCE_BUFFER, VBO, vertexData.size() * sizeof(float), this->texture.path);
+    GpuResources::track(RESOURCE_BUFFER, EBO, indexData.size() * sizeof(unsigned int), this->texture.path);
+
     // Specifies the location and data format of the bound VBO to use when rendering
     // Positions
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -33,10 +41,32 @@ GameObject::GameObject(std::vector<float> vertexData, std::vector<unsigned int>
     // Unbinding
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+}
 
-    // Texture and shader
-    this->shader = shader;
-    this->texture = texture;
+GameObject::~GameObject() {
+    releaseAll();
+}
+
+GameObject::GameObject(GameObject&& other) noexcept
+    : shader(other.shader), texture(std::move(other.texture)), indices(std::move(other.indices)),
+      VBO(other.VBO), VAO(other.VAO), EBO(other.EBO), vertSize(other.vertSize), position(other.position) {
+    other.VBO = other.VAO = other.EBO = 0;
+}
+
+GameObject& GameObject::operator=(GameObject&& other) noexcept {
+    if (this != &other) {
+        releaseAll();
+        shader = other.shader;
+        texture = std::move(other.texture);
+        indices = std::move(other.indices);
+        VBO = other.VBO;
+        VAO = other.VAO;
+        EBO = other.EBO;
+        vertSize = other.vertSize;
+        position = other.position;
+        other.VBO = other.VAO = other.EBO = 0;
+    }
+    return *this;
 }
 
 void GameObject::update(Camera *camera) {
@@ -47,10 +77,10 @@ void GameObject::update(Camera *camera) {
     glm::mat4 projection = glm::perspective(Settings::FOV, (float)Settings::WIDTH / Settings::HEIGHT, 0.1f, 100.0f);  // projection remains the same for all cubes
 
     // Uniforms
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
 }
 
@@ -58,10 +88,10 @@ void GameObject::update(glm::mat4 model, glm::mat4 view, glm::mat4 projection) {
     view = glm::translate(view, position);
 
     // Uniforms
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
 }
 
@@ -85,7 +115,7 @@ bool GameObject::collideswith(GameObject &other) {
 
 void GameObject::bindAll() {
     glBindVertexArray(VAO);  // Bind the VAO
-    shader.use();  // Bind Shader
+    shader->use();  // Bind Shader
     texture.use();  // Bind textures on corresponding texture units
 }
 
@@ -95,6 +125,14 @@ void GameObject::unbindAll() {
     glUseProgram(0);
 }
 
+// deleted once the GPU is past this frame, it may have just been drawn
+void GameObject::releaseAll() {
+    GpuResources::release(RESOURCE_VERTEX_ARRAY, VAO);
+    GpuResources::release(RESOURCE_BUFFER, VBO);
+    GpuResources::release(RESOURCE_BUFFER, EBO);
+    VAO = VBO = EBO = 0;
+}
+
 void GameObject::inBounds() {
     // std::cout << position.x << " " << position.y << std::endl;
 
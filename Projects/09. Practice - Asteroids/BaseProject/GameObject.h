@@ -12,7 +12,7 @@
 class GameObject {
 public:
 
-    Shader shader;
+    Shader* shader;  // the ShaderCache's, shared with every object drawn the same way
     Image texture;
     std::vector<unsigned int> indices;
     unsigned int VBO, VAO, EBO;
@@ -20,7 +20,15 @@ public:
     glm::vec2 vertSize;
     glm::vec3 position;
 
-    GameObject(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader shader, Image texture, glm::vec3 position);
+    GameObject(std::vector<float> vertexData, std::vector<unsigned int> indexData, Shader* shader, Image texture, glm::vec3 position);
+
+    // owns its buffers, vertex array and texture, so it can be moved but not copied
+    ~GameObject();
+    GameObject(const GameObject&) = delete;
+    GameObject& operator=(const GameObject&) = delete;
+    GameObject(GameObject&& other) noexcept;
+    GameObject& operator=(GameObject&& other) noexcept;
+
     void update(Camera *camera);
     void update(glm::mat4 model, glm::mat4 view, glm::mat4 projection);
     void draw();
@@ -30,4 +38,5 @@ public:
 private:
     void bindAll();
     void unbindAll();
+    void releaseAll();
 };
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct Release {
+        Resource_Type type;
+        unsigned int id;
+    };
+
+    // the releases of one frame, deleted once its fence has signalled
+    struct Frame {
+        GLsync fence;
+        std::vector<Release> releases;
+    };
+
+    struct Allocation {
+        size_t bytes;
+        std::string owner;
+    };
+
+    struct Owner {
+        size_t bytes = 0;
+        size_t highWater = 0;
+        int objects = 0;
+    };
+
+    int liveCounts[RESOURCE_TYPE_COUNT] = {};
+    int highWater[RESOURCE_TYPE_COUNT] = {};
+    std::vector<Release> releasing;  // this frame's
+    std::deque<Frame> inFlight;
+
+    // by type and GL name
+    std::unordered_map<uint64_t, Allocation> allocations;
+    std::map<std::string, Owner> owners;
+    size_t typeBytes[RESOURCE_TYPE_COUNT] = {};
+    size_t typeHighWater[RESOURCE_TYPE_COUNT] = {};
+    size_t totalBytes = 0, totalHighWater = 0;
+    size_t budget = 0;
+    bool overBudget = false;
+
+    uint64_t key(Resource_Type type, unsigned int id) {
+        return ((uint64_t) type << 32) | id;
+    }
+
+    double megabytes(size_t bytes) {
+        return bytes / (1024.0 * 1024.0);
+    }
+
+    void untrack(Resource_Type type, unsigned int id) {
+        auto found = allocations.find(key(type, id));
+        if (found == allocations.end())
+            return;
+        Owner& owner = owners[found->second.owner];
+        owner.bytes -= found->second.bytes;
+        owner.objects--;
+        typeBytes[type] -= found->second.bytes;
+        totalBytes -= found->second.bytes;
+        allocations.erase(found);
+        // back under, so going over again is worth another warning
+        if (budget > 0 && totalBytes <= budget)
+            overBudget = false;
+    }
+
+    void destroy(const Release& release) {
+        untrack(release.type, release.id);
+        switch (release.type) {
+        case RESOURCE_PROGRAM:
+            glDeleteProgram(release.id);
+            break;
+        case RESOURCE_TEXTURE:
+            glDeleteTextures(1, &release.id);
+            break;
+        case RESOURCE_BUFFER:
+            glDeleteBuffers(1, &release.id);
+            break;
+        case RESOURCE_VERTEX_ARRAY:
+            glDeleteVertexArrays(1, &release.id);
+            break;
+        case RESOURCE_RENDERBUFFER:
+            glDeleteRenderbuffers(1, &release.id);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // bytes per texel as stored, drivers keep 3 channel formats as 4
+    size_t texelBytes(GLenum internalFormat) {
+        switch (internalFormat) {
+        case GL_RED: case GL_R8:
+            return 1;
+        case GL_RG: case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGB: case GL_RGB8: case GL_RGBA: case GL_RGBA8: case GL_SRGB8: case GL_SRGB8_ALPHA8:
+        case GL_RG16F: case GL_R32F: case GL_R11F_G11F_B10F:
+        case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: case GL_DEPTH24_STENCIL8:
+            return 4;
+        case GL_RGB16F: case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGB32F: case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+        }
+    }
+}
+
+const char* GpuResources::name(Resource_Type type) {
+    switch (type) {
+    case RESOURCE_PROGRAM:      return "programs";
+    case RESOURCE_TEXTURE:      return "textures";
+    case RESOURCE_BUFFER:       return "buffers";
+    case RESOURCE_VERTEX_ARRAY: return "vertex arrays";
+    case RESOURCE_RENDERBUFFER: return "renderbuffers";
+    default:                    return "?";
+    }
+}
+
+void GpuResources::created(Resource_Type type) {
+    liveCounts[type]++;
+    if (liveCounts[type] > highWater[type])
+        highWater[type] = liveCounts[type];
+}
+
+void GpuResources::deleted(Resource_Type type) {
+    liveCounts[type]--;
+}
+
+void GpuResources::release(Resource_Type type, unsigned int id) {
+    if (id == 0)
+        return;
+    liveCounts[type]--;
+    releasing.push_back({ type, id });
+}
+
+void GpuResources::track(Resource_Type type, unsigned int id, size_t size, const std::string& ownerName) {
+    untrack(type, id);
+    allocations[key(type, id)] = { size, ownerName };
+    Owner& owner = owners[ownerName];
+    owner.bytes += size;
+    owner.objects++;
+    owner.highWater = std::max(owner.highWater, owner.bytes);
+    typeBytes[type] += size;
+    typeHighWater[type] = std::max(typeHighWater[type], typeBytes[type]);
+    totalBytes += size;
+    totalHighWater = std::max(totalHighWater, totalBytes);
+
+    if (budget > 0 && totalBytes > budget && !overBudget) {
+        overBudget = true;
+        std::ostringstream warning;
+        warning << std::fixed << std::setprecision(2) << megabytes(totalBytes) << " MB of " << megabytes(budget)
+            << " MB, the last " << megabytes(size) << " MB for " << ownerName;
+        std::cout << "WARNING::GPU_MEMORY::OVER_BUDGET " << warning.str() << std::endl;
+    }
+}
+
+size_t GpuResources::imageBytes(GLenum internalFormat, int width, int height, bool mipmapped) {
+    size_t total = 0;
+    // every level halves each side, rounding down, until both are 1
+    while (true) {
+        total += (size_t) width * height * texelBytes(internalFormat);
+        if (!mipmapped || (width == 1 && height == 1))
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return total;
+}
+
+void GpuResources::setBudget(size_t bytes) {
+    budget = bytes;
+    overBudget = false;
+}
+
+void GpuResources::endFrame() {
+    if (!releasing.empty()) {
+        inFlight.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(releasing) });
+        releasing.clear();
+    }
+    // frames finish in order, so stop at the first one that hasn't
+    while (!inFlight.empty()) {
+        GLenum status = glClientWaitSync(inFlight.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        for (const Release& release : inFlight.front().releases)
+            destroy(release);
+        glDeleteSync(inFlight.front().fence);
+        inFlight.pop_front();
+    }
+}
+
+int GpuResources::live(Resource_Type type) {
+    return liveCounts[type];
+}
+
+int GpuResources::queued() {
+    size_t count = releasing.size();
+    for (const Frame& frame : inFlight)
+        count += frame.releases.size();
+    return (int) count;
+}
+
+size_t GpuResources::bytes(Resource_Type type) {
+    return typeBytes[type];
+}
+
+size_t GpuResources::bytes() {
+    return totalBytes;
+}
+
+size_t GpuResources::highWaterBytes() {
+    return totalHighWater;
+}
+
+void GpuResources::report(std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "GPU memory: " << megabytes(totalBytes) << " MB, most " << megabytes(totalHighWater) << " MB";
+    if (budget > 0)
+        out << ", budget " << megabytes(budget) << " MB";
+    out << "\n";
+    for (int type = 0; type < RESOURCE_TYPE_COUNT; type++)
+        if (typeHighWater[type] > 0)
+            out << "  " << name((Resource_Type) type) << ": " << megabytes(typeBytes[type]) << " MB, most " << megabytes(typeHighWater[type]) << " MB\n";
+
+    std::vector<std::pair<std::string, Owner>> sorted(owners.begin(), owners.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Owner>& a, const std::pair<std::string, Owner>& b) {
+        return a.second.highWater > b.second.highWater;
+    });
+    for (const auto& owner : sorted)
+        out << "  " << owner.first << ": " << megabytes(owner.second.bytes) << " MB in " << owner.second.objects << " objects, most "
+            << megabytes(owner.second.highWater) << " MB\n";
+    out.flags(flags);
+    out.precision(precision);
+    out << std::flush;
+}
+
+void GpuResources::shutdown(std::ostream& out) {
+    glFinish();
+    for (Frame& frame : inFlight) {
+        for (const Release& release : frame.releases)
+            destroy(release);
+        glDeleteSync(frame.fence);
+    }
+    inFlight.clear();
+    for (const Release& release : releasing)
+        destroy(release);
+    releasing.clear();
+
+    out << "GPU objects still alive at shutdown:";
+    for (int type = 0; type < RESOURCE_TYPE_COUNT; type++)
+        out << ' ' << name((Resource_Type) type) << ' ' << liveCounts[type] << " (most " << highWater[type] << ')';
+    out << ", " << totalBytes << " bytes" << std::endl;
+}
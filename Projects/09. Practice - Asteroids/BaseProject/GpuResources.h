@@ -0,0 +1,63 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+enum Resource_Type {
+    RESOURCE_PROGRAM,
+    RESOURCE_TEXTURE,
+    RESOURCE_BUFFER,
+    RESOURCE_VERTEX_ARRAY,
+    RESOURCE_RENDERBUFFER,
+    RESOURCE_TYPE_COUNT
+};
+
+// Keeps count of the GL objects alive of each type, and deletes the ones given up mid-frame only
+// once the GPU is done with that frame. A projectile is freed right after it's drawn, so deleting
+// its buffers and texture there and then would be under a draw that may still be queued.
+//
+// It also keeps track of the memory behind textures, buffers and renderbuffers. Each one is put
+// down against an owner, the asset it came from or the part of the game that made it, with its
+// size worked out from its format and dimensions. GL can't say what the driver really allocated,
+// so these are what the data needs, not counting alignment or padding
+namespace GpuResources
+{
+    const char* name(Resource_Type type);
+
+    // counts an object made by its owner
+    void created(Resource_Type type);
+    // counts an object its owner has deleted itself
+    void deleted(Resource_Type type);
+    // hands the object over to be deleted once the frame it was released in is done on the GPU
+    void release(Resource_Type type, unsigned int id);
+
+    // records the bytes behind an object, until it's deleted. Tracking it again replaces the size
+    void track(Resource_Type type, unsigned int id, size_t bytes, const std::string& owner);
+    // bytes a texture or renderbuffer of the internal format takes, with its whole mip chain if
+    // mipmapped
+    size_t imageBytes(GLenum internalFormat, int width, int height, bool mipmapped = false);
+
+    // warns whenever the tracked memory goes over this many bytes, 0 for no budget
+    void setBudget(size_t bytes);
+
+    // fences off the frame's releases and deletes those of frames the GPU has finished. Called
+    // after each swap
+    void endFrame();
+
+    // objects made and not yet released or deleted
+    int live(Resource_Type type);
+    // released objects still waiting for their frame
+    int queued();
+    // tracked bytes now and the most there has been, of one type or all of them
+    size_t bytes(Resource_Type type);
+    size_t bytes();
+    size_t highWaterBytes();
+
+    // the tracked memory by type and by owner, largest first
+    void report(std::ostream& out);
+
+    // waits for the GPU, deletes everything queued and prints what's still alive and the bytes
+    // still tracked, which is whatever was never given back
+    void shutdown(std::ostream& out);
+}
@@ -5,9 +5,10 @@ Image::Image() {
     ID = 0;
 }
 
-Image::Image(const char* image_location, GLenum type) {
+Image::Image(const char* image_location, GLenum type) : path(image_location) {
     stbi_set_flip_vertically_on_load(true);
     glGenTextures(1, &ID);
+    GpuResources::created(RESOURCE_TEXTURE);
     glBindTexture(GL_TEXTURE_2D, ID);
 
     // Enabling PNG transparency
@@ -26,6 +27,7 @@ Image::Image(const char* image_location, GLenum type) {
     {
         glTexImage2D(GL_TEXTURE_2D, 0, type, width, height, 0, type, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        GpuResources::track(RESOURCE_TEXTURE, ID, GpuResources::imageBytes(type, width, height, true), path);
     }
     else
     {
@@ -35,6 +37,25 @@ Image::Image(const char* image_location, GLenum type) {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+Image::~Image() {
+    GpuResources::release(RESOURCE_TEXTURE, ID);
+}
+
+Image::Image(Image&& other) noexcept : path(std::move(other.path)) {
+    ID = other.ID;
+    other.ID = 0;
+}
+
+Image& Image::operator=(Image&& other) noexcept {
+    if (this != &other) {
+        GpuResources::release(RESOURCE_TEXTURE, ID);
+        ID = other.ID;
+        path = std::move(other.path);
+        other.ID = 0;
+    }
+    return *this;
+}
+
 void Image::use() {
     glBindTexture(GL_TEXTURE_2D, ID);
 }
@@ -2,13 +2,24 @@
 #include <stb/stb_image.h>
 #include <glad/glad.h>
 #include <iostream>
+#include <string>
+
+#include "GpuResources.h"
 
 class Image {
 public:
 	unsigned int ID;
+	std::string path;  // what its memory is put down to
 
 	Image();
 	Image(const char* image_location, GLenum type);
 
+	// owns the texture, released when the image goes
+	~Image();
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+	Image(Image&& other) noexcept;
+	Image& operator=(Image&& other) noexcept;
+
 	void use();
 };
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "Menu.h"
 
-Menu::Menu(Camera* camera) {
+Menu::Menu(Camera* camera, ShaderCache* shaders) : shaders(shaders) {
 	this->camera = camera;
 
 }
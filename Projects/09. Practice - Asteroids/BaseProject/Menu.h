@@ -5,6 +5,7 @@
 
 #include "GameObject.h"
 #include "Button.h"
+#include "ShaderCache.h"
 
 
 
@@ -14,6 +15,7 @@ private:
 
 public:
 	Camera* camera;
+	ShaderCache* shaders;  // set before the objects below are made
 	GameObject asteroid_text = GameObject(
 		{
 			// Positions          // Texture
@@ -26,7 +28,7 @@ public:
 			0,  1,  2,  // 1st triangle
 			0,  2,  3,  // 2nd triangle
 		},
-		Shader("shaders/button.vs", "shaders/button.fs"),
+		shaders->get("shaders/button.vs", "shaders/button.fs"),
 		Image("assets/title.png", GL_RGBA),
 		glm::vec3(0.0f, 0.8f, 7.0f)
 	);
@@ -43,12 +45,12 @@ public:
 			0,  1,  2,  // 1st triangle
 			0,  2,  3,  // 2nd triangle
 		},
-		Shader("shaders/button.vs", "shaders/button.fs"),
+		shaders->get("shaders/button.vs", "shaders/button.fs"),
 		Image("assets/play-purple.png", GL_RGBA),
 		glm::vec3(0.5f, -2.5f, 5.0f)
 	);
 
-	Menu(Camera* camera);
+	Menu(Camera* camera, ShaderCache* shaders);
 	void update(GLFWwindow* window, float deltaTime);
 	bool game_started();
 
@@ -1,6 +1,6 @@
 #include "Projectile.h"
 
-Projectile::Projectile(float t_direction, glm::vec3 t_position, Projectile_Type t_ptype) :
+Projectile::Projectile(float t_direction, glm::vec3 t_position, Projectile_Type t_ptype, ShaderCache* shaders) :
     GameObject({
             // Positions          // Texture
             -0.2f, -0.2f,  0.0f,  0.0f, 0.0f, // BL
@@ -11,7 +11,7 @@ Projectile::Projectile(float t_direction, glm::vec3 t_position, Projectile_Type
              0,  1,  2,  // 1st triangle
              0,  2,  3,  // 2nd triangle
         },
-        Shader("shaders/projectile.vs", "shaders/projectile.fs"),
+        shaders->get("shaders/projectile.vs", "shaders/projectile.fs"),
         Image("assets/projectile.png", GL_RGBA),
         t_position  // Position
      )
@@ -41,10 +41,10 @@ void Projectile::update(Camera *camera, float deltaTime) {
     view = glm::translate(view, position);
 
     // Uniforms
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
     
     // check if dead
@@ -4,6 +4,7 @@
 #include "Settings.h"
 #include "GameObject.h"
 #include "Image.h"
+#include "ShaderCache.h"
 
 enum Projectile_Type {
     PROJECTILE_PLAYER,
@@ -24,7 +25,7 @@ private:
     bool alive = true;
 
 public: 
-    Projectile(float direction, glm::vec3 t_velocity, Projectile_Type ptype);
+    Projectile(float direction, glm::vec3 t_velocity, Projectile_Type ptype, ShaderCache* shaders);
     void update(Camera *camera, float deltaTime);
     bool isAlive();
     void destroy();
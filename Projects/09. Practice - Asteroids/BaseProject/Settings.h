@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 
 namespace Settings
 {
@@ -8,4 +9,7 @@ namespace Settings
 
     constexpr float FOV{ 90.0f };
     constexpr float ENTITY_DEPTH{ 0.0f };
+
+    // GPU memory the game should stay under, GpuResources warns past it
+    constexpr size_t GPU_MEMORY_BUDGET{ 16 * 1024 * 1024 };
 }
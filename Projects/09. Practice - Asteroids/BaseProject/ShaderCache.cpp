@@ -0,0 +1,132 @@
+#include "ShaderCache.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return std::string();
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+
+ShaderCache::~ShaderCache() {
+    finishReading();
+}
+
+void ShaderCache::load(const std::vector<ShaderFiles>& files) {
+    finishReading();
+    loadStart = std::chrono::steady_clock::now();
+    size_t first = programs.size();
+    for (const ShaderFiles& pair : files) {
+        Program program;
+        program.files = pair;
+        programs.push_back(std::move(program));
+    }
+    // nothing else touches programs until finishReading()
+    reading = std::async(std::launch::async, [this, first]() {
+        for (size_t i = first; i < programs.size(); i++) {
+            programs[i].vertexCode = readFile(programs[i].files.vertex);
+            programs[i].fragmentCode = readFile(programs[i].files.fragment);
+        }
+        readMs = millisecondsSince(loadStart);
+    });
+}
+
+void ShaderCache::submit() {
+    finishReading();
+    submitStart = std::chrono::steady_clock::now();
+    // let the driver use as many threads as it likes
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+
+    for (Program& program : programs) {
+        if (program.submitted)
+            continue;
+        program.shader.reset(new Shader(Shader::submit(program.vertexCode, program.fragmentCode)));
+        program.submitted = true;
+        GpuResources::created(RESOURCE_PROGRAM);
+        // the sources aren't needed once the driver has them
+        program.vertexCode.clear();
+        program.fragmentCode.clear();
+    }
+    submitMs = millisecondsSince(submitStart);
+}
+
+Shader* ShaderCache::get(const std::string& vertexPath, const std::string& fragmentPath) {
+    finishReading();
+    for (Program& program : programs)
+        if (program.files.vertex == vertexPath && program.files.fragment == fragmentPath) {
+            if (!program.submitted)
+                submit();
+            return program.shader.get();
+        }
+
+    // not loaded up front, so read and compiled now
+    Program program;
+    program.files = { vertexPath, fragmentPath };
+    program.shader.reset(new Shader(Shader::submit(readFile(vertexPath), readFile(fragmentPath))));
+    program.submitted = true;
+    GpuResources::created(RESOURCE_PROGRAM);
+    Shader* shader = program.shader.get();
+    programs.push_back(std::move(program));
+    return shader;
+}
+
+void ShaderCache::update() {
+    if (reported)
+        return;
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        for (Program& program : programs) {
+            GLint done = GL_TRUE;
+            if (program.submitted)
+                glGetProgramiv(program.shader->ID, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done)
+                return;
+        }
+    }
+
+    // the errors themselves are printed by the first object to use the program
+    int failed = 0;
+    for (Program& program : programs) {
+        GLint linked = GL_TRUE;
+        if (program.submitted)
+            glGetProgramiv(program.shader->ID, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            std::cout << "ERROR::SHADER_CACHE::NOT_LINKED " << program.files.vertex << ", " << program.files.fragment << std::endl;
+            failed++;
+        }
+    }
+    reported = true;
+
+    std::cout << "Compiled " << programs.size() << " shader programs in " << millisecondsSince(submitStart) << " ms ("
+        << (GLAD_GL_KHR_parallel_shader_compile ? "in parallel" : "no GL_KHR_parallel_shader_compile") << "), "
+        << "read in " << readMs << " ms on a worker thread, submitted in " << submitMs << " ms";
+    if (failed > 0)
+        std::cout << ", " << failed << " failed";
+    std::cout << std::endl;
+}
+
+void ShaderCache::clear() {
+    finishReading();
+    for (Program& program : programs)
+        if (program.submitted)
+            GpuResources::deleted(RESOURCE_PROGRAM);
+    programs.clear();
+}
+
+void ShaderCache::finishReading() {
+    if (reading.valid())
+        reading.get();
+}
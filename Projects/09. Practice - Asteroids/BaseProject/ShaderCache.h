@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+#include <shaders/shader.h>
+
+#include "GpuResources.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ShaderFiles {
+    std::string vertex;
+    std::string fragment;
+};
+
+// Every shader program the game uses, compiled once and handed out to each object that draws with
+// it. load() reads the files on a worker thread, so that happens while the window is being made.
+// submit() starts every compile at once, across the driver's compiler threads where
+// GL_KHR_parallel_shader_compile is supported. A program's status isn't asked for until it's first
+// used, so the compiles run while the images load and the first frame is set up
+class ShaderCache {
+public:
+    ShaderCache() = default;
+    // the programs are deleted with it, or by clear() while there's still a context
+    ~ShaderCache();
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    // starts reading the sources, no GL needed
+    void load(const std::vector<ShaderFiles>& files);
+    // waits for the files and starts compiling every program
+    void submit();
+    // the program for the pair, compiled now if it wasn't loaded up front. It stays the cache's, and
+    // where it is, until clear()
+    Shader* get(const std::string& vertexPath, const std::string& fragmentPath);
+    // once every program has finished, prints any errors and how long compiling took. Called each
+    // frame, it only waits on the driver where there's no way to ask whether the compiles are done
+    void update();
+    // deletes every program
+    void clear();
+
+private:
+    struct Program {
+        ShaderFiles files;
+        std::string vertexCode, fragmentCode;
+        std::unique_ptr<Shader> shader;  // a pointer, so it doesn't move when programs grows
+        bool submitted = false;
+    };
+    std::vector<Program> programs;
+    std::future<void> reading;
+
+    std::chrono::steady_clock::time_point loadStart, submitStart;
+    double readMs = 0.0, submitMs = 0.0;
+    bool reported = false;
+
+    void finishReading();
+};
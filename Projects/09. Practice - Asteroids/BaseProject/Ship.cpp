@@ -1,6 +1,6 @@
 #include "Ship.h"
 
-Ship::Ship() : 
+Ship::Ship(ShaderCache* shaders) : 
     GameObject(  // Default construction inputs
     {
         // Positions          // Texture
@@ -12,7 +12,7 @@ Ship::Ship() :
          0,  1,  2,  // 1st triangle
          0,  2,  3,  // 2nd triangle
     }, 
-    Shader("shaders/ship.vs", "shaders/ship.fs"), 
+    shaders->get("shaders/ship.vs", "shaders/ship.fs"),
     Image("assets/ship.png", GL_RGBA),
     glm::vec3(0.0f, 0.0f, Settings::ENTITY_DEPTH)  // Position
     )
@@ -62,10 +62,10 @@ void Ship::update(Camera *camera, float deltaTime) {
     glm::mat4 projection = glm::perspective(Settings::FOV, (float) Settings::WIDTH / Settings::HEIGHT, 0.1f, 100.0f);
 
     // Uniforms
-    shader.use();
-    shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
     glUseProgram(0);
 }
 
@@ -9,6 +9,7 @@
 #include "Settings.h"
 #include "GameObject.h"
 #include "Image.h"
+#include "ShaderCache.h"
 
 enum Movement {
     SHIP_FORWARD,
@@ -29,7 +30,7 @@ private:
     bool alive = true;
 
 public:
-    Ship();
+    Ship(ShaderCache* shaders);
     void move(Movement dir, float deltaTime);
     void update(Camera *camera, float deltaTime);
     void kill();
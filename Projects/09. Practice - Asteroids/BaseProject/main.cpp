@@ -1,6 +1,16 @@
 #include "main.h"
 
 int main() {
+    // every program the game uses, read while the window is made and compiled together after
+    ShaderCache shaders;
+    shaders.load({
+        { "shaders/background.vs", "shaders/background.fs" },
+        { "shaders/button.vs", "shaders/button.fs" },
+        { "shaders/ship.vs", "shaders/ship.fs" },
+        { "shaders/asteroid.vs", "shaders/asteroid.fs" },
+        { "shaders/projectile.vs", "shaders/projectile.fs" },
+    });
+
     // GLFW WINDOW HINTS
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -24,15 +34,26 @@ int main() {
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    // -----------------------------------------------------------------------------
-    
+    shaders.submit();
+    GpuResources::setBudget(Settings::GPU_MEMORY_BUDGET);
+
+    play(window, shaders);
+
+    // everything the game made is gone by now, whatever is still counted was never given back
+    shaders.clear();
+    GpuResources::shutdown(std::cout);
+    glfwTerminate();
+    return 0;
+}
+
+void play(GLFWwindow* window, ShaderCache& shaders) {
     GameState state = MENU;
     
     Camera camera = Camera(glm::vec3(0.0f, 0.0f, 10.0f));
 
-    Menu menu = Menu(&camera);
+    Menu menu = Menu(&camera, &shaders);
 
-    Game game = Game(&camera);
+    Game game = Game(&camera, &shaders);
     game.reload();
 
     GameObject background = GameObject(
@@ -47,7 +68,7 @@ int main() {
              0,  1,  2,  // 1st triangle
              0,  2,  3,  // 2nd triangle
         },
-        Shader("shaders/background.vs", "shaders/background.fs"),
+        shaders.get("shaders/background.vs", "shaders/background.fs"),
         Image("assets/background.png", GL_RGBA),
         glm::vec3(0.0f, 0.2f, camera.Position.z - 1.0f)
     );
@@ -74,10 +95,11 @@ int main() {
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+        shaders.update();  // logs the compile time once they're all done
+        GpuResources::endFrame();
     }
 
-    glfwTerminate();
-    return 0;
+    GpuResources::report(std::cout);
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
@@ -7,10 +7,13 @@
 #include "Menu.h"
 #include "Game.h"
 #include "Ship.h"
+#include "ShaderCache.h"
+#include "GpuResources.h"
 
 enum GameState {
 	MENU,
 	GAME
 };
 
+void play(GLFWwindow* window, ShaderCache& shaders);  // Runs the menu and the game until the window closes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);  // Handles Window size changes
\ No newline at end of file
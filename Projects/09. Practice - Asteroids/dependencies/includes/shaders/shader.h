@@ -14,8 +14,34 @@ class Shader
 public:
     unsigned int ID;
 
-    Shader() {
-        ID = 0;
+    Shader() : ID(0), pending(false), linked(false) {}
+
+    // owns the program, so it can be moved but not copied
+    ~Shader()
+    {
+        if (ID != 0)
+            glDeleteProgram(ID);
+    }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader&& other) noexcept : ID(other.ID), pending(other.pending), linked(other.linked)
+    {
+        other.ID = 0;
+        other.pending = false;
+    }
+    Shader& operator=(Shader&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (ID != 0)
+                glDeleteProgram(ID);
+            ID = other.ID;
+            pending = other.pending;
+            linked = other.linked;
+            other.ID = 0;
+            other.pending = false;
+        }
+        return *this;
     }
 
     // constructor generates the shader on the fly
@@ -62,49 +88,54 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if (geometryPath != nullptr)
+        submitCompile(vertexCode.c_str(), fragmentCode.c_str(), geometryPath != nullptr ? geometryCode.c_str() : nullptr);
+        resolve();
+    }
+    // starts compiling and linking source code already in memory without waiting for the driver.
+    // Nothing is checked until resolve(), which use() calls the first time, so a driver that
+    // compiles in the background can work on several programs at once
+    // ------------------------------------------------------------------------
+    static Shader submit(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        Shader shader;
+        shader.submitCompile(vertexCode.c_str(), fragmentCode.c_str(), nullptr);
+        return shader;
+    }
+    // waits for a submitted program and prints any errors, once. Returns whether it linked
+    // ------------------------------------------------------------------------
+    bool resolve()
+    {
+        if (!pending)
+            return linked;
+        pending = false;
+        GLint success;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        linked = success != 0;
+
+        GLuint shaders[3];
+        GLsizei count = 0;
+        glGetAttachedShaders(ID, 3, &count, shaders);
+        for (GLsizei i = 0; i < count; i++)
         {
-            const char* gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
+            if (!linked)
+            {
+                GLint type;
+                glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+                checkCompileErrors(shaders[i], type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY");
+            }
+            // they were deleted when submitted, so this frees them
+            glDetachShader(ID, shaders[i]);
         }
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessery
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
-            glDeleteShader(geometry);
-
+        if (!linked)
+            checkCompileErrors(ID, "PROGRAM");
+        return linked;
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
     {
+        if (pending)
+            resolve();
         glUseProgram(ID);
     }
     // utility uniform functions
@@ -167,6 +198,47 @@ public:
     }
 
 private:
+    bool pending;
+    bool linked;
+
+    // compiles and links the program, the geometry shader only if there is one, without asking
+    // how it went
+    // ------------------------------------------------------------------------
+    void submitCompile(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode)
+    {
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        // if geometry shader is given, compile geometry shader
+        unsigned int geometry;
+        if (gShaderCode != nullptr)
+        {
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &gShaderCode, NULL);
+            glCompileShader(geometry);
+        }
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (gShaderCode != nullptr)
+            glAttachShader(ID, geometry);
+        glLinkProgram(ID);
+        // only flagged for deletion while they're attached, resolve() detaches them once it has
+        // their logs
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (gShaderCode != nullptr)
+            glDeleteShader(geometry);
+        pending = true;
+        linked = false;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,381 @@
+#include "CpuShaders.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "NoiseTextures.h"
+#include "Png.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_SHADERS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and clang need the instruction set per function
+#if defined(CPU_SHADERS_X86) && !defined(_MSC_VER)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+// pixels a thread takes at a time, 8KB of RGBA so a tile's writes stay in L1
+const unsigned int TILE_WIDTH = 64, TILE_HEIGHT = 32;
+const int OCTAVES = 6;
+// the lattice of octave i wraps every FBM_PERIOD * 2^i cells, like the shaders' fbm
+const int FBM_PERIOD = NoiseTextures::FBM_PERIOD;
+
+
+// ------------------------------------ dispatch ------------------------------------
+
+static bool cpuHasAvx2() {
+#if !defined(CPU_SHADERS_X86)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS also has to save the ymm registers between context switches
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+Simd_Level bestSimdLevel() {
+    static const Simd_Level best = cpuHasAvx2() ? SIMD_AVX2 : SIMD_SCALAR;
+    return best;
+}
+
+bool simdSupported(Simd_Level level) {
+    return level <= bestSimdLevel();
+}
+
+const char* simdLevelName(Simd_Level level) {
+    switch (level) {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+const char* cpuShaderName(Cpu_Shader shader) {
+    switch (shader) {
+    case CPU_SHADER_NOISE:             return "noise";
+    case CPU_SHADER_FIRE:              return "fire";
+    case CPU_SHADER_DOMAIN_DISTORTION: return "domaindistortion";
+    default:                           return "unknown";
+    }
+}
+
+// the constants of each shader's random()
+static NoiseHash shaderHash(Cpu_Shader shader) {
+    return shader == CPU_SHADER_DOMAIN_DISTORTION ? NoiseHash(glm::vec2(12.983f, 78.233f)) : NoiseHash();
+}
+
+// the uniforms, and the constants of the shader's random()
+struct ShaderInputs {
+    Cpu_Shader shader;
+    NoiseHash hash;
+    glm::vec2 resolution;
+    float time;
+};
+
+static unsigned char toByte(float value) {
+    return (unsigned char) std::lround(glm::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+// the colour a shader ends on from its noise value, for pixel row y (fire's aColor goes from 0 at
+// the top of the quad to 1 at the bottom)
+static void shadePixel(const ShaderInputs& inputs, float value, unsigned int row, unsigned char* pixel) {
+    glm::vec3 color(value);
+    if (inputs.shader == CPU_SHADER_FIRE) {
+        float aColor = 1.0f - (row + 0.5f) / inputs.resolution.y;
+        color *= glm::vec3(0.9f, 0.2f, 0.1f) * aColor;
+    }
+    else if (inputs.shader == CPU_SHADER_DOMAIN_DISTORTION)
+        color *= glm::vec3(0.9f, 0.2f, 0.1f);
+    pixel[0] = toByte(color.x);
+    pixel[1] = toByte(color.y);
+    pixel[2] = toByte(color.z);
+    pixel[3] = 255;
+}
+
+// how far each shader's st scrolls with time
+static float scrollSpeed(Cpu_Shader shader) {
+    return shader == CPU_SHADER_FIRE ? 0.7f : shader == CPU_SHADER_DOMAIN_DISTORTION ? 0.1f : 0.0f;
+}
+
+
+// ------------------------------------- scalar -------------------------------------
+
+static float distortionScalar(glm::vec2 p, const NoiseHash& hash) {
+    glm::vec2 q = glm::vec2(fbmNoise(p + glm::vec2(0.0f, 0.0f), hash, OCTAVES, FBM_PERIOD),
+                            fbmNoise(p + glm::vec2(5.2f, 1.3f), hash, OCTAVES, FBM_PERIOD));
+
+    glm::vec2 r = glm::vec2(fbmNoise(p + 4.0f * q + glm::vec2(1.7f, 9.2f), hash, OCTAVES, FBM_PERIOD),
+                            fbmNoise(p + 4.0f * q + glm::vec2(8.3f, 2.8f), hash, OCTAVES, FBM_PERIOD));
+
+    return fbmNoise(p + 4.0f * r, hash, OCTAVES, FBM_PERIOD);
+}
+
+static void shadeRowScalar(const ShaderInputs& inputs, unsigned int column, unsigned int row, unsigned int count, unsigned char* pixels) {
+    for (unsigned int i = 0; i < count; i++) {
+        glm::vec2 st = glm::vec2(column + i + 0.5f, row + 0.5f) / inputs.resolution;
+        st.x *= inputs.resolution.x / inputs.resolution.y;
+        st.y -= inputs.time * scrollSpeed(inputs.shader);
+
+        float value;
+        if (inputs.shader == CPU_SHADER_NOISE)
+            value = fbmNoise(st * 3.0f, inputs.hash, OCTAVES, FBM_PERIOD);
+        else if (inputs.shader == CPU_SHADER_FIRE)
+            value = distortionScalar(st * 3.0f, inputs.hash) * 18.0f + std::sin(inputs.time * 0.3f) * 3.0f;
+        else
+            value = distortionScalar(st * 3.0f, inputs.hash);
+        shadePixel(inputs, value, row, pixels + 4 * i);
+    }
+}
+
+
+// -------------------------------------- AVX2 --------------------------------------
+
+#ifdef CPU_SHADERS_X86
+
+// 8 pixels' worth of each value, the same operations in the same order as the scalar version
+typedef __m256 Lanes;
+
+static AVX2_TARGET Lanes splat(float value) { return _mm256_set1_ps(value); }
+static AVX2_TARGET Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static AVX2_TARGET Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static AVX2_TARGET Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static AVX2_TARGET Lanes fract(Lanes x) { return _mm256_sub_ps(x, _mm256_floor_ps(x)); }
+// GLSL's mod, exact for the whole cells and power of two periods it's used on
+static AVX2_TARGET Lanes wrap(Lanes x, float period) {
+    return _mm256_sub_ps(x, _mm256_mul_ps(splat(period), _mm256_floor_ps(_mm256_mul_ps(x, splat(1.0f / period)))));
+}
+
+// sin of 4 doubles, x = k*pi + r and sin(x) = (-1)^k sin(r), with sin(r) from its Taylor series to
+// r^15 which is well under a float ulp off for |r| <= pi/2. pi is taken off in three parts of 26
+// bits, so k times each is exact and r stays right for the thousands of pis the hash's dot products reach
+static AVX2_TARGET __m256d sin4(__m256d x) {
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(0.31830988618379067)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(3.1415926218032837)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(3.1786509424591713e-08)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(1.2246467991473532e-16)));
+    __m256d r2 = _mm256_mul_pd(r, r);
+    __m256d p = _mm256_set1_pd(-1.0 / 1307674368000.0);
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(1.0 / 6227020800.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(-1.0 / 39916800.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(1.0 / 362880.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(-1.0 / 5040.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(1.0 / 120.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r2), _mm256_set1_pd(-1.0 / 6.0));
+    __m256d sine = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, r2), p));
+    // k is odd where its lowest bit is set, taken from k as an integer (negative k too) and moved up
+    // to the sign bit
+    __m256i odd = _mm256_cvtepi32_epi64(_mm_and_si128(_mm256_cvtpd_epi32(k), _mm_set1_epi32(1)));
+    return _mm256_xor_pd(sine, _mm256_castsi256_pd(_mm256_slli_epi64(odd, 63)));
+}
+
+// sin4() against std::sin on both sides of 0, over the range the shaders' dot products cover
+static AVX2_TARGET bool sin4Matches() {
+    for (int i = -4000; i < 4000; i += 4) {
+        alignas(32) double x[4], sine[4];
+        for (int j = 0; j < 4; j++)
+            x[j] = (i + j) * 0.25 + 0.1;
+        _mm256_store_pd(sine, sin4(_mm256_load_pd(x)));
+        for (int j = 0; j < 4; j++)
+            if (std::fabs(sine[j] - std::sin(x[j])) > 1e-9)
+                return false;
+    }
+    return true;
+}
+
+// sin of the floats, worked out in double so it comes out as the correctly rounded sinf() does. The
+// hash multiplies any error in it by tens of thousands
+static AVX2_TARGET Lanes sin8(Lanes x) {
+    __m128 low = _mm256_castps256_ps128(x), high = _mm256_extractf128_ps(x, 1);
+    __m128 sinLow = _mm256_cvtpd_ps(sin4(_mm256_cvtps_pd(low)));
+    __m128 sinHigh = _mm256_cvtpd_ps(sin4(_mm256_cvtps_pd(high)));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(sinLow), sinHigh, 1);
+}
+
+static AVX2_TARGET Lanes random8(Lanes x, Lanes y, const NoiseHash& hash) {
+    Lanes dot = add(mul(x, splat(hash.direction.x)), mul(y, splat(hash.direction.y)));
+    return fract(mul(sin8(dot), splat(hash.scale)));
+}
+
+static AVX2_TARGET Lanes noise8(Lanes x, Lanes y, const NoiseHash& hash, float period) {
+    Lanes ix = _mm256_floor_ps(x), iy = _mm256_floor_ps(y);
+    Lanes fx = sub(x, ix), fy = sub(y, iy);
+
+    // Four corners in 2D of a tile, wrapped every period cells
+    Lanes one = splat(1.0f);
+    Lanes x0 = wrap(ix, period), x1 = wrap(add(ix, one), period);
+    Lanes y0 = wrap(iy, period), y1 = wrap(add(iy, one), period);
+    Lanes a = random8(x0, y0, hash);
+    Lanes b = random8(x1, y0, hash);
+    Lanes c = random8(x0, y1, hash);
+    Lanes d = random8(x1, y1, hash);
+
+    Lanes ux = mul(mul(fx, fx), sub(splat(3.0f), mul(splat(2.0f), fx)));
+    Lanes uy = mul(mul(fy, fy), sub(splat(3.0f), mul(splat(2.0f), fy)));
+
+    Lanes value = add(a, mul(sub(b, a), ux));
+    value = add(value, mul(mul(sub(c, a), uy), sub(one, ux)));
+    return add(value, mul(mul(sub(d, b), ux), uy));
+}
+
+static AVX2_TARGET Lanes fbm8(Lanes x, Lanes y, const NoiseHash& hash) {
+    Lanes value = splat(0.0f);
+    float amplitude = 0.5f;
+    float period = (float) FBM_PERIOD;
+    for (int i = 0; i < OCTAVES; i++) {
+        value = add(value, mul(splat(amplitude), noise8(x, y, hash, period)));
+        x = mul(x, splat(2.0f));
+        y = mul(y, splat(2.0f));
+        period *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    return value;
+}
+
+static AVX2_TARGET Lanes distortion8(Lanes x, Lanes y, const NoiseHash& hash) {
+    Lanes four = splat(4.0f);
+    Lanes qx = fbm8(add(x, splat(0.0f)), add(y, splat(0.0f)), hash);
+    Lanes qy = fbm8(add(x, splat(5.2f)), add(y, splat(1.3f)), hash);
+
+    Lanes wx = add(x, mul(four, qx)), wy = add(y, mul(four, qy));
+    Lanes rx = fbm8(add(wx, splat(1.7f)), add(wy, splat(9.2f)), hash);
+    Lanes ry = fbm8(add(wx, splat(8.3f)), add(wy, splat(2.8f)), hash);
+
+    return fbm8(add(x, mul(four, rx)), add(y, mul(four, ry)), hash);
+}
+
+// up to 8 pixels of a row, the lanes past count are worked out and thrown away
+static AVX2_TARGET void shadeRowAvx2(const ShaderInputs& inputs, unsigned int column, unsigned int row, unsigned int count, unsigned char* pixels) {
+    Lanes fragX = add(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), splat(column + 0.5f));
+    Lanes x = _mm256_div_ps(fragX, splat(inputs.resolution.x));
+    float y = (row + 0.5f) / inputs.resolution.y;
+    x = mul(x, splat(inputs.resolution.x / inputs.resolution.y));
+    y -= inputs.time * scrollSpeed(inputs.shader);
+
+    Lanes value;
+    if (inputs.shader == CPU_SHADER_NOISE)
+        value = fbm8(mul(x, splat(3.0f)), splat(y * 3.0f), inputs.hash);
+    else if (inputs.shader == CPU_SHADER_FIRE) {
+        value = mul(distortion8(mul(x, splat(3.0f)), splat(y * 3.0f), inputs.hash), splat(18.0f));
+        value = add(value, splat(std::sin(inputs.time * 0.3f) * 3.0f));
+    }
+    else
+        value = distortion8(mul(x, splat(3.0f)), splat(y * 3.0f), inputs.hash);
+
+    alignas(32) float values[8];
+    _mm256_store_ps(values, value);
+    for (unsigned int i = 0; i < count; i++)
+        shadePixel(inputs, values[i], row, pixels + 4 * i);
+}
+
+#endif
+
+
+std::vector<unsigned char> renderCpuShader(Cpu_Shader shader, unsigned int width, unsigned int height, float time,
+                                           Simd_Level level, unsigned int threads) {
+    std::vector<unsigned char> pixels((size_t) width * height * 4);
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    level = std::min(level, bestSimdLevel());
+    ShaderInputs inputs = { shader, shaderHash(shader), glm::vec2((float) width, (float) height), time };
+
+    unsigned int tilesAcross = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+    unsigned int tiles = tilesAcross * ((height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+    std::atomic<unsigned int> nextTile(0);
+    auto work = [&] {
+        for (unsigned int tile = nextTile++; tile < tiles; tile = nextTile++) {
+            unsigned int left = tile % tilesAcross * TILE_WIDTH, bottom = tile / tilesAcross * TILE_HEIGHT;
+            unsigned int right = std::min(width, left + TILE_WIDTH), top = std::min(height, bottom + TILE_HEIGHT);
+            for (unsigned int row = bottom; row < top; row++) {
+                for (unsigned int column = left; column < right; column += 8) {
+                    unsigned int count = std::min(8u, right - column);
+                    unsigned char* out = pixels.data() + ((size_t) row * width + column) * 4;
+#ifdef CPU_SHADERS_X86
+                    if (level == SIMD_AVX2) {
+                        shadeRowAvx2(inputs, column, row, count, out);
+                        continue;
+                    }
+#endif
+                    shadeRowScalar(inputs, column, row, count, out);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads; t++)
+        workers.emplace_back(work);
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+    return pixels;
+}
+
+bool benchmarkCpuShaders(std::ostream& out, unsigned int width, unsigned int height, float time, const char* directory) {
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool written = true;
+
+#ifdef CPU_SHADERS_X86
+    if (simdSupported(SIMD_AVX2) && !sin4Matches()) {
+        std::cout << "ERROR::CPU_SHADERS::AVX2_SIN_MISMATCH" << std::endl;
+        return false;
+    }
+#endif
+
+    // against the scalar image, in 0-255. sin8() rounds correctly and the C library's sinf() needn't
+    // (glibc's is a bit off for about 1% of floats), and sin() * scale turns a last bit into a
+    // different hash. The lattice corners where the two disagree come out different, more of them as
+    // time scrolls the shaders to larger coordinates, and the rest are within rounding
+    out << "shader,width,height,time,simd,threads,ms,ns_per_pixel,max_difference,percent_over_2\n";
+    for (int s = 0; s < CPU_SHADER_COUNT; s++) {
+        Cpu_Shader shader = (Cpu_Shader) s;
+        std::vector<unsigned char> scalar;
+        for (Simd_Level level : { SIMD_SCALAR, SIMD_AVX2 }) {
+            if (!simdSupported(level))
+                continue;
+            auto start = std::chrono::steady_clock::now();
+            std::vector<unsigned char> pixels = renderCpuShader(shader, width, height, time, level, threads);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            int difference = 0;
+            size_t over = 0;
+            if (level == SIMD_SCALAR)
+                scalar = pixels;
+            for (size_t i = 0; i < pixels.size(); i++) {
+                int channel = std::abs(int(pixels[i]) - int(scalar[i]));
+                difference = std::max(difference, channel);
+                over += channel > 2;
+            }
+            out << cpuShaderName(shader) << ',' << width << ',' << height << ',' << time << ',' << simdLevelName(level) << ','
+                << threads << ',' << ms << ',' << ms * 1e6 / ((double) width * height) << ',' << difference << ','
+                << 100.0 * over / pixels.size() << '\n';
+
+            if (level == bestSimdLevel()) {
+                std::string path = std::string(directory) + "/cpu_" + cpuShaderName(shader) + ".png";
+                written = writePng(path.c_str(), width, height, pixels) && written;
+            }
+        }
+    }
+    return written;
+}
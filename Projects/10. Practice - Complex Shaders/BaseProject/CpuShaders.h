@@ -0,0 +1,36 @@
+#pragma once
+#include <ostream>
+#include <vector>
+
+// The noise, fire and domain distortion shaders ported to C++, for reference images and a CPU
+// baseline where there's no GPU. random, noise, fbm and distortion are the shaders' own, run on 8
+// pixels at once with AVX2 where the CPU has it and one at a time otherwise. The image is split into
+// tiles small enough to stay in cache, handed out to a thread per core.
+
+enum Cpu_Shader {
+    CPU_SHADER_NOISE,
+    CPU_SHADER_FIRE,
+    CPU_SHADER_DOMAIN_DISTORTION,
+    CPU_SHADER_COUNT
+};
+
+enum Simd_Level {
+    SIMD_SCALAR,
+    SIMD_AVX2
+};
+
+bool simdSupported(Simd_Level level);
+Simd_Level bestSimdLevel();
+const char* simdLevelName(Simd_Level level);
+// the name of the shader in shaders/, "noise", "fire" or "domaindistortion"
+const char* cpuShaderName(Cpu_Shader shader);
+
+// What the shader draws at u_resolution (width, height) and u_time, as RGBA8 bottom row first like
+// glReadPixels. A level the CPU doesn't have runs as the best one it does. threads 0 uses every core
+std::vector<unsigned char> renderCpuShader(Cpu_Shader shader, unsigned int width, unsigned int height, float time,
+                                           Simd_Level level, unsigned int threads = 0);
+
+// Renders every shader scalar and with the best SIMD level, writes the SIMD image of each to
+// <directory>/cpu_<name>.png and one CSV row per run in ns per pixel, comparable with the GPU's.
+// Returns false if a PNG couldn't be written
+bool benchmarkCpuShaders(std::ostream& out, unsigned int width, unsigned int height, float time, const char* directory);
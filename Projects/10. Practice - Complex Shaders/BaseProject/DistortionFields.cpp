@@ -0,0 +1,118 @@
+#include "DistortionFields.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+const float DistortionFields::P_PER_UV = 3.0f;
+
+// x mod n, positive for negative x too
+static int wrap(int x, int n) {
+    return ((x % n) + n) % n;
+}
+
+
+DistortionFields::DistortionFields(Quad& quad, ShaderLibrary& library, const NoiseHash& hash, float scale, const std::string& shaderDirectory)
+    : quad(quad), shader(library.get(shaderDirectory + "standard.vs", shaderDirectory + "distortion_fields.fs")),
+      hash(hash), fieldScale(scale), texelSize(0.0f), valid(false), rendered(0) {}
+
+void DistortionFields::update(glm::vec2 resolution, glm::vec2 scrolled) {
+    // square texels, fieldScale of them to a pixel, and a couple spare each way so the frame's texels
+    // always fit however it lines up with them
+    float size = P_PER_UV / (resolution.y * fieldScale);
+    unsigned int width = (unsigned int) std::ceil(resolution.x * fieldScale) + 4;
+    unsigned int height = (unsigned int) std::ceil(resolution.y * fieldScale) + 4;
+    if (!fields || fields->width != width || fields->height != height || size != texelSize) {
+        fields.reset(new RenderTarget(width, height, GL_RGBA32F));
+        glBindTexture(GL_TEXTURE_2D, fields->texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        texelSize = size;
+        valid = false;
+    }
+
+    // the p the frame covers, with a texel more each side for the filtering and the jitter
+    glm::vec2 origin = -P_PER_UV * scrolled;
+    glm::vec2 extent = P_PER_UV * resolution / resolution.y;
+    glm::ivec2 min((int) std::floor(origin.x / texelSize) - 1, (int) std::floor(origin.y / texelSize) - 1);
+    glm::ivec2 max((int) std::ceil((origin.x + extent.x) / texelSize) + 1, (int) std::ceil((origin.y + extent.y) / texelSize) + 1);
+
+    rendered = 0;
+    bool overlaps = valid && min.x < validMax.x && max.x > validMin.x && min.y < validMax.y && max.y > validMin.y;
+    if (overlaps && min.x >= validMin.x && max.x <= validMax.x && min.y >= validMin.y && max.y <= validMax.y)
+        return;
+
+    GLint framebuffer, viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, fields->FBO);
+    shader.use();
+    shader.setFloat("u_texelSize", texelSize);
+    shader.setVec2("u_hashDirection", hash.direction);
+    shader.setFloat("u_hashScale", hash.scale);
+
+    if (!overlaps)
+        render(min, max);
+    else {
+        // rows that have come into view, the whole width of them
+        if (min.y < validMin.y)
+            render(min, glm::ivec2(max.x, validMin.y));
+        if (max.y > validMax.y)
+            render(glm::ivec2(min.x, validMax.y), max);
+        // then columns, over the rows that were there already
+        int rowMin = std::max(min.y, validMin.y), rowMax = std::min(max.y, validMax.y);
+        if (min.x < validMin.x)
+            render(glm::ivec2(min.x, rowMin), glm::ivec2(validMin.x, rowMax));
+        if (max.x > validMax.x)
+            render(glm::ivec2(validMax.x, rowMin), glm::ivec2(max.x, rowMax));
+    }
+    // what was outside the frame may have been written over, whatever was left of it
+    validMin = min;
+    validMax = max;
+    valid = true;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void DistortionFields::invalidate() {
+    valid = false;
+}
+
+void DistortionFields::bind(Shader& shader, unsigned int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, fields ? fields->texture : 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("u_fields", unit);
+    if (fields)
+        shader.setVec2("u_fieldExtent", glm::vec2((float) fields->width, (float) fields->height) * texelSize);
+}
+
+float DistortionFields::scale() const {
+    return fieldScale;
+}
+
+unsigned int DistortionFields::texelsRendered() const {
+    return rendered;
+}
+
+void DistortionFields::render(glm::ivec2 min, glm::ivec2 max) {
+    int width = (int) fields->width, height = (int) fields->height;
+    // where the texels wrap past an edge of the texture they're drawn as separate pieces
+    for (int y = min.y; y < max.y;) {
+        int targetY = wrap(y, height);
+        int rows = std::min(max.y - y, height - targetY);
+        for (int x = min.x; x < max.x;) {
+            int targetX = wrap(x, width);
+            int columns = std::min(max.x - x, width - targetX);
+            glViewport(targetX, targetY, columns, rows);
+            shader.setVec2("u_texelOffset", glm::vec2((float) (x - targetX), (float) (y - targetY)));
+            quad.draw();
+            rendered += columns * rows;
+            x += columns;
+        }
+        y += rows;
+    }
+}
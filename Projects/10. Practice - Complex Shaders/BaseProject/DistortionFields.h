@@ -0,0 +1,53 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <memory>
+#include <string>
+
+#include "NoiseTextures.h"
+#include "Quad.h"
+#include "RenderTarget.h"
+#include "ShaderLibrary.h"
+
+// The warp fields q and r of distortion() in domaindistortion.fs and fire.fs, rendered at a fraction
+// of the resolution into a float texture that the shaders/*_fields.fs versions sample instead of
+// running four of their five fbm()s per pixel. The fields only depend on p, so the texture is laid
+// out in p and wraps round: as the picture scrolls, an update only renders the rows and columns that
+// have come into view and keeps the rest from earlier frames
+class DistortionFields {
+public:
+    static const float P_PER_UV;  // the shaders' distortion(st*3.0)
+
+    DistortionFields(Quad& quad, ShaderLibrary& library, const NoiseHash& hash, float scale = 0.5f, const std::string& shaderDirectory = "shaders/");
+    DistortionFields(const DistortionFields&) = delete;
+    DistortionFields& operator=(const DistortionFields&) = delete;
+
+    // Renders the part of the fields a frame at this resolution needs that isn't there yet. scrolled
+    // is how far the picture has moved, Effect::scroll * u_time. Leaves the framebuffer bound as it was
+    void update(glm::vec2 resolution, glm::vec2 scrolled);
+    // forgets the fields, the next update renders all of them
+    void invalidate();
+    // binds the fields and sets u_fields and u_fieldExtent, shader must be in use
+    void bind(Shader& shader, unsigned int unit = 0) const;
+
+    // fraction of the resolution the fields are rendered at
+    float scale() const;
+    // field texels the last update rendered, all of them after a resize
+    unsigned int texelsRendered() const;
+
+private:
+    Quad& quad;
+    Shader& shader;
+    NoiseHash hash;
+    float fieldScale;
+    std::unique_ptr<RenderTarget> fields;
+    float texelSize;               // p across a texel
+    bool valid;
+    glm::ivec2 validMin, validMax;  // texels of p, counted from p = 0, the texture holds
+    unsigned int rendered;
+
+    // renders texels min up to max, wrapped round the texture
+    void render(glm::ivec2 min, glm::ivec2 max);
+};
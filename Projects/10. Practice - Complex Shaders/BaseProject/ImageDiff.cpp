@@ -0,0 +1,33 @@
+#include "ImageDiff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+
+ImageDiff compareImages(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    ImageDiff diff = { 0.0, 0.0, std::numeric_limits<double>::infinity(), 0 };
+    if (a.size() != b.size() || a.empty()) {
+        std::cout << "ERROR::IMAGE_DIFF::SIZE_MISMATCH " << a.size() << " " << b.size() << std::endl;
+        return diff;
+    }
+
+    double sum = 0.0, squares = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (i % 4 == 3)
+            continue;  // alpha
+        int error = std::abs(int(a[i]) - int(b[i]));
+        sum += error;
+        squares += double(error) * error;
+        diff.maxError = std::max(diff.maxError, error);
+        count++;
+    }
+    diff.meanError = sum / count;
+    diff.rmse = std::sqrt(squares / count);
+    if (diff.rmse > 0.0)
+        diff.psnr = 20.0 * std::log10(255.0 / diff.rmse);
+    return diff;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <vector>
+
+// How far apart two RGBA8 images of the same size are, over the red, green and blue channels in 0-255
+struct ImageDiff {
+    double meanError;
+    double rmse;
+    double psnr;    // dB, infinite when they're identical
+    int maxError;
+};
+
+ImageDiff compareImages(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b);
@@ -0,0 +1,180 @@
+#include "NoiseTextures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+
+float noiseRandom(glm::vec2 cell, const NoiseHash& hash) {
+    // in float like the GPU, sin of a large argument is where the two part ways first
+    float value = std::sin(cell.x * hash.direction.x + cell.y * hash.direction.y) * hash.scale;
+    return value - std::floor(value);
+}
+
+static float wrap(float cell, int period) {
+    if (period <= 0)
+        return cell;
+    float wrapped = std::fmod(cell, float(period));
+    return wrapped < 0.0f ? wrapped + period : wrapped;
+}
+
+float valueNoise(glm::vec2 st, const NoiseHash& hash, int period) {
+    glm::vec2 i = glm::floor(st);
+    glm::vec2 f = st - i;
+
+    // Four corners in 2D of a tile
+    float x0 = wrap(i.x, period), x1 = wrap(i.x + 1.0f, period);
+    float y0 = wrap(i.y, period), y1 = wrap(i.y + 1.0f, period);
+    float a = noiseRandom(glm::vec2(x0, y0), hash);
+    float b = noiseRandom(glm::vec2(x1, y0), hash);
+    float c = noiseRandom(glm::vec2(x0, y1), hash);
+    float d = noiseRandom(glm::vec2(x1, y1), hash);
+
+    glm::vec2 u = f * f * (3.0f - 2.0f * f);
+
+    return a + (b - a) * u.x +
+            (c - a) * u.y * (1.0f - u.x) +
+            (d - b) * u.x * u.y;
+}
+
+float fbmNoise(glm::vec2 st, const NoiseHash& hash, int octaves, int period) {
+    float value = 0.0f;
+    float amplitude = 0.5f;
+    for (int i = 0; i < octaves; i++) {
+        value += amplitude * valueNoise(st, hash, period);
+        st *= 2.0f;
+        period *= 2;
+        amplitude *= 0.5f;
+    }
+    return value;
+}
+
+
+// size x size texels of value(x, y) at the texel centres, the rows split between threads
+static std::vector<uint16_t> bakeTable(int size, unsigned int threads, const std::function<float(float, float)>& value) {
+    std::vector<uint16_t> texels((size_t) size * size);
+    auto bakeRows = [&](int first, int last) {
+        for (int row = first; row < last; row++) {
+            for (int column = 0; column < size; column++) {
+                float v = glm::clamp(value(column + 0.5f, row + 0.5f), 0.0f, 1.0f);
+                texels[(size_t) row * size + column] = (uint16_t) std::lround(v * 65535.0f);
+            }
+        }
+    };
+
+    int chunk = (size + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads && (int) t * chunk < size; t++)
+        workers.emplace_back(bakeRows, t * chunk, std::min(size, (int) (t + 1) * chunk));
+    bakeRows(0, std::min(size, chunk));
+    for (std::thread& worker : workers)
+        worker.join();
+    return texels;
+}
+
+// random() of every cell of a lattice that wraps every period cells. There are far fewer cells than
+// texels, so the texels look their corners up here instead of each hashing four
+static std::vector<float> hashLattice(const NoiseHash& hash, int period) {
+    std::vector<float> lattice((size_t) period * period);
+    for (int y = 0; y < period; y++) {
+        for (int x = 0; x < period; x++)
+            lattice[(size_t) y * period + x] = noiseRandom(glm::vec2((float) x, (float) y), hash);
+    }
+    return lattice;
+}
+
+// valueNoise() with the corners from hashLattice, st >= 0
+static float latticeNoise(const std::vector<float>& lattice, int period, glm::vec2 st) {
+    glm::vec2 i = glm::floor(st);
+    glm::vec2 f = st - i;
+
+    int x0 = int(i.x) % period, x1 = (x0 + 1) % period;
+    int y0 = int(i.y) % period, y1 = (y0 + 1) % period;
+    float a = lattice[(size_t) y0 * period + x0];
+    float b = lattice[(size_t) y0 * period + x1];
+    float c = lattice[(size_t) y1 * period + x0];
+    float d = lattice[(size_t) y1 * period + x1];
+
+    glm::vec2 u = f * f * (3.0f - 2.0f * f);
+
+    return a + (b - a) * u.x +
+            (c - a) * u.y * (1.0f - u.x) +
+            (d - b) * u.x * u.y;
+}
+
+
+NoiseTextures::NoiseTextures(const NoiseHash& hash, unsigned int threads) : threads(threads) {
+    if (this->threads == 0)
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint16_t> noiseTexels = bakeNoise(hash);
+    std::vector<uint16_t> fbmTexels = bakeFbm(hash);
+    noise = upload(noiseTexels, NOISE_PERIOD * NOISE_TEXELS_PER_CELL);
+    fbm = upload(fbmTexels, FBM_PERIOD * FBM_TEXELS_PER_UNIT);
+    bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+NoiseTextures::~NoiseTextures() {
+    glDeleteTextures(1, &noise);
+    glDeleteTextures(1, &fbm);
+}
+
+void NoiseTextures::bind(Shader& shader, unsigned int noiseUnit, unsigned int fbmUnit) const {
+    glActiveTexture(GL_TEXTURE0 + noiseUnit);
+    glBindTexture(GL_TEXTURE_2D, noise);
+    glActiveTexture(GL_TEXTURE0 + fbmUnit);
+    glBindTexture(GL_TEXTURE_2D, fbm);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("u_noise", noiseUnit);
+    shader.setInt("u_fbm", fbmUnit);
+    shader.setFloat("u_noisePeriod", (float) NOISE_PERIOD);
+    shader.setFloat("u_fbmPeriod", (float) FBM_PERIOD);
+}
+
+std::vector<uint16_t> NoiseTextures::bakeNoise(const NoiseHash& hash) const {
+    const float cellsPerTexel = 1.0f / NOISE_TEXELS_PER_CELL;
+    std::vector<float> lattice = hashLattice(hash, NOISE_PERIOD);
+    return bakeTable(NOISE_PERIOD * NOISE_TEXELS_PER_CELL, threads, [&](float x, float y) {
+        return latticeNoise(lattice, NOISE_PERIOD, glm::vec2(x, y) * cellsPerTexel);
+    });
+}
+
+std::vector<uint16_t> NoiseTextures::bakeFbm(const NoiseHash& hash) const {
+    const float unitsPerTexel = 1.0f / FBM_TEXELS_PER_UNIT;
+    // octave i has 2^i cells per unit, so its lattice wraps every FBM_PERIOD * 2^i cells
+    std::vector<std::vector<float>> lattices;
+    for (int i = 0; i < OCTAVES; i++)
+        lattices.push_back(hashLattice(hash, FBM_PERIOD << i));
+    return bakeTable(FBM_PERIOD * FBM_TEXELS_PER_UNIT, threads, [&](float x, float y) {
+        glm::vec2 st = glm::vec2(x, y) * unitsPerTexel;
+        float value = 0.0f;
+        float amplitude = 0.5f;
+        for (int i = 0; i < OCTAVES; i++) {
+            value += amplitude * latticeNoise(lattices[i], FBM_PERIOD << i, st);
+            st *= 2.0f;
+            amplitude *= 0.5f;
+        }
+        return value;
+    });
+}
+
+unsigned int NoiseTextures::upload(const std::vector<uint16_t>& texels, int size) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, size, size, 0, GL_RED, GL_UNSIGNED_SHORT, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    // tiles, so repeating is the noise carrying on
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
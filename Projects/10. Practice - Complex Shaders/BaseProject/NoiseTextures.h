@@ -0,0 +1,57 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <cstdint>
+#include <vector>
+
+// The constants of a shader's random(), which differ from shader to shader:
+// fract(sin(dot(st, direction)) * scale)
+struct NoiseHash {
+    glm::vec2 direction;
+    float scale;
+
+    NoiseHash(glm::vec2 direction = glm::vec2(12.9898f, 78.233f), float scale = 43758.5453123f)
+        : direction(direction), scale(scale) {}
+};
+
+// The shaders' random, noise and fbm on the CPU. A period > 0 wraps the lattice every period cells
+// so the noise tiles, 0 leaves it as the shaders have it
+float noiseRandom(glm::vec2 cell, const NoiseHash& hash);
+float valueNoise(glm::vec2 st, const NoiseHash& hash, int period = 0);
+// octave i wraps every period * 2^i cells, so the sum tiles every period
+float fbmNoise(glm::vec2 st, const NoiseHash& hash, int octaves, int period = 0);
+
+// Value noise and fBm baked once into tileable GL_REPEAT textures, for the shaders/*_baked.fs
+// versions of the shaders that look them up instead of hashing every lattice corner per pixel.
+// Texel centres are baked so that texture(u_noise, st / u_noisePeriod) matches noise(st) and
+// texture(u_fbm, st / u_fbmPeriod) matches fbm(st). The shaders' lattice wraps at the same
+// periods (NOISE_PERIOD and FBM_PERIOD in shaders/include/noise.glsl), so that holds for any st,
+// negative too, however far the shaders scroll. The rows are split between worker threads
+class NoiseTextures {
+public:
+    static const int OCTAVES = 6;                // the shaders' #define OCTAVES
+    static const int NOISE_PERIOD = 256;         // lattice cells before the value noise repeats, NOISE_PERIOD in noise.glsl
+    static const int NOISE_TEXELS_PER_CELL = 4;
+    static const int FBM_PERIOD = 16;            // units of st before the fBm repeats, FBM_PERIOD in noise.glsl
+    static const int FBM_TEXELS_PER_UNIT = 128;  // 4 per cell of the last octave
+
+    unsigned int noise, fbm;  // GL_R16 textures
+    double bakeMilliseconds;
+
+    NoiseTextures(const NoiseHash& hash, unsigned int threads = 0);
+    ~NoiseTextures();
+    NoiseTextures(const NoiseTextures&) = delete;
+    NoiseTextures& operator=(const NoiseTextures&) = delete;
+
+    // binds the textures to two units and sets u_noise, u_fbm and their periods, shader must be in use
+    void bind(Shader& shader, unsigned int noiseUnit = 0, unsigned int fbmUnit = 1) const;
+
+private:
+    unsigned int threads;
+
+    std::vector<uint16_t> bakeNoise(const NoiseHash& hash) const;
+    std::vector<uint16_t> bakeFbm(const NoiseHash& hash) const;
+    static unsigned int upload(const std::vector<uint16_t>& texels, int size);
+};
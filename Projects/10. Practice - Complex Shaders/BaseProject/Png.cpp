@@ -0,0 +1,98 @@
+#include "Png.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+
+static uint32_t crc32(const unsigned char* data, size_t length, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back((unsigned char) (value >> 24));
+    out.push_back((unsigned char) (value >> 16));
+    out.push_back((unsigned char) (value >> 8));
+    out.push_back((unsigned char) value);
+}
+
+static void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putBigEndian(chunk, (uint32_t) data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    // the CRC covers the type and the data, not the length
+    putBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write((const char*) chunk.data(), chunk.size());
+}
+
+
+bool writePng(const char* path, unsigned int width, unsigned int height, const std::vector<unsigned char>& pixels) {
+    if (pixels.size() != (size_t) width * height * 4) {
+        std::cout << "ERROR::PNG::SIZE_MISMATCH " << path << std::endl;
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::PNG::FILE_NOT_OPENED " << path << std::endl;
+        return false;
+    }
+
+    // every row starts with its filter type, 0 for none, and PNG rows go top to bottom
+    std::vector<unsigned char> raw;
+    size_t rowBytes = (size_t) width * 4;
+    raw.reserve((rowBytes + 1) * height);
+    for (unsigned int row = 0; row < height; row++) {
+        const unsigned char* source = pixels.data() + (size_t) (height - 1 - row) * rowBytes;
+        raw.push_back(0);
+        raw.insert(raw.end(), source, source + rowBytes);
+    }
+
+    // zlib stream of stored deflate blocks, each up to 65535 bytes
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    const size_t BLOCK = 65535;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += BLOCK) {
+        size_t length = std::min(BLOCK, raw.size() - offset);
+        bool last = offset + length >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((unsigned char) length);
+        zlib.push_back((unsigned char) (length >> 8));
+        zlib.push_back((unsigned char) ~length);
+        zlib.push_back((unsigned char) (~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        if (last)
+            break;
+    }
+    uint32_t a = 1, b = 0;
+    for (unsigned char byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBigEndian(zlib, (b << 16) | a);
+
+    const unsigned char SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write((const char*) SIGNATURE, sizeof(SIGNATURE));
+    std::vector<unsigned char> header;
+    putBigEndian(header, width);
+    putBigEndian(header, height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });  // 8 bit RGBA, deflate, no filtering, no interlace
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", std::vector<unsigned char>());
+    return (bool) file;
+}
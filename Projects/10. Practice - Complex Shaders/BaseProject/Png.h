@@ -0,0 +1,7 @@
+#pragma once
+#include <vector>
+
+// Writes an RGBA8 image, bottom row first as glReadPixels gives it, to a PNG. The pixels go in
+// uncompressed deflate blocks, so it needs no zlib and the files are about the size of the pixels.
+// Returns false if the file couldn't be written
+bool writePng(const char* path, unsigned int width, unsigned int height, const std::vector<unsigned char>& pixels);
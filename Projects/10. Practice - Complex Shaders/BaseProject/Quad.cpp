@@ -0,0 +1,56 @@
+#include "Quad.h"
+
+
+Quad::Quad() {
+    // VERTEX DATA
+    float vertices[] = {
+         // positions       // Colors
+        -1.0f,  1.0f, 0.0f,  0.0f,   // top left
+         1.0f,  1.0f, 0.0f,  0.0f,   // top right
+         1.0f, -1.0f, 0.0f,  1.0f,   // bottom right
+        -1.0f, -1.0f, 0.0f,  1.0f,   // bottom left
+    };
+    unsigned int indices[]{
+        0, 1, 2,  // 1st triangle
+        0, 2, 3,  // 2nd triangle
+    };
+
+    // Creating Objects to send to GPU
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    // Binding VAO
+    glBindVertexArray(VAO);
+
+    // Adding vertices to VBO
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // Positions
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*) 0);
+    glEnableVertexAttribArray(0);
+
+    // Color
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*) (3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Unbinding
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+Quad::~Quad() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+void Quad::draw() const {
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <glad/glad.h>
+
+// The quad every shader here is drawn on, covering the whole viewport. Attribute 0 is the position,
+// attribute 1 a colour going from 0 at the top to 1 at the bottom (fire.vs passes it on)
+class Quad {
+public:
+    Quad();
+    ~Quad();
+    Quad(const Quad&) = delete;
+    Quad& operator=(const Quad&) = delete;
+
+    void draw() const;
+
+private:
+    unsigned int VBO, VAO, EBO;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <vector>
+
+// A framebuffer with one colour texture, for drawing the shaders somewhere other than the window
+class RenderTarget {
+public:
+    unsigned int FBO, texture;
+    unsigned int width, height;
+
+    RenderTarget(unsigned int width, unsigned int height, GLenum internalFormat = GL_RGBA8);
+    ~RenderTarget();
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    // binds the framebuffer and sets the viewport to cover it
+    void bind() const;
+    // the colour texture as RGBA8, bottom row first
+    std::vector<unsigned char> readPixels() const;
+};
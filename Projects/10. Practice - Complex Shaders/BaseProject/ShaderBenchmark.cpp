@@ -0,0 +1,118 @@
+#include "ShaderBenchmark.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Quad.h"
+#include "RenderTarget.h"
+
+
+// median and mean of the frame times
+static void summarise(std::vector<double> ms, double& median, double& mean) {
+    std::sort(ms.begin(), ms.end());
+    size_t middle = ms.size() / 2;
+    median = ms.size() % 2 ? ms[middle] : (ms[middle - 1] + ms[middle]) * 0.5;
+    mean = 0.0;
+    for (double frame : ms)
+        mean += frame;
+    mean /= ms.size();
+}
+
+
+bool runShaderBenchmark(std::ostream& out, ShaderLibrary& library, const std::string& vertexPath, const std::string& fragmentPath,
+                        const BenchmarkSettings& settings, const BenchmarkSetup& setup) {
+    Quad quad;
+    int timedFrames = std::max(1, settings.timedFrames);
+    std::vector<unsigned int> queries(timedFrames);
+    glGenQueries(timedFrames, queries.data());
+
+    // the define values as indices, counted through like the digits of a number
+    std::vector<size_t> choice(settings.defines.size(), 0);
+    bool compiled = true;
+    out << "vertex,fragment,defines,width,height,frames,median_ms,mean_ms,ns_per_pixel\n";
+    while (true) {
+        ShaderDefines variant;
+        std::string defines;
+        for (size_t i = 0; i < settings.defines.size(); i++) {
+            const BenchmarkDefine& define = settings.defines[i];
+            variant[define.name] = define.values[choice[i]];
+            // ; between them, the column is already split on ,
+            defines += (i > 0 ? ";" : "") + define.name + "=" + define.values[choice[i]];
+        }
+
+        Shader& shader = library.get(vertexPath, fragmentPath, variant);
+        GLint linked;
+        glGetProgramiv(shader.ID, GL_LINK_STATUS, &linked);
+        compiled = compiled && linked;
+        for (size_t r = 0; r < settings.resolutions.size() && linked; r++) {
+            glm::uvec2 size = settings.resolutions[r];
+            RenderTarget target(size.x, size.y);
+            target.bind();
+            shader.use();
+            setup(shader, glm::vec2((float) size.x, (float) size.y));
+
+            // untimed frames first, so compiling on first use and allocating the target aren't counted
+            for (int i = 0; i < settings.warmupFrames; i++)
+                quad.draw();
+            glFinish();
+
+            for (int i = 0; i < timedFrames; i++) {
+                glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+                quad.draw();
+                glFlush();
+                glEndQuery(GL_TIME_ELAPSED);
+            }
+            std::vector<double> ms(timedFrames);
+            for (int i = 0; i < timedFrames; i++) {
+                GLuint64 elapsed;
+                glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsed);
+                ms[i] = elapsed / 1e6;
+            }
+            double median, mean;
+            summarise(ms, median, mean);
+            out << vertexPath << ',' << fragmentPath << ',' << defines << ',' << size.x << ',' << size.y << ',' << timedFrames << ','
+                << median << ',' << mean << ',' << median * 1e6 / ((double) size.x * size.y) << '\n';
+        }
+
+        // next combination, the last define changing fastest
+        size_t i = choice.size();
+        while (i > 0 && ++choice[i - 1] == settings.defines[i - 1].values.size())
+            choice[--i] = 0;
+        if (i == 0)
+            break;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteQueries(timedFrames, queries.data());
+    return compiled;
+}
+
+bool parseBenchmarkDefine(const char* text, BenchmarkDefine& define) {
+    std::string definition(text);
+    size_t equals = definition.find('=');
+    if (equals == 0 || equals == std::string::npos)
+        return false;
+    define.name = definition.substr(0, equals);
+    define.values.clear();
+    std::istringstream values(definition.substr(equals + 1));
+    std::string value;
+    while (std::getline(values, value, ','))
+        if (!value.empty())
+            define.values.push_back(value);
+    return !define.values.empty();
+}
+
+bool parseBenchmarkResolutions(const char* text, std::vector<glm::uvec2>& resolutions) {
+    resolutions.clear();
+    std::istringstream list(text);
+    std::string resolution;
+    while (std::getline(list, resolution, ',')) {
+        int width = 0, height = 0;
+        char x = 0;
+        std::istringstream(resolution) >> width >> x >> height;
+        if (width <= 0 || height <= 0 || (x != 'x' && x != 'X'))
+            return false;
+        resolutions.push_back(glm::uvec2(width, height));
+    }
+    return !resolutions.empty();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ShaderLibrary.h"
+
+// A #define to try several values of, like OCTAVES. Each combination is a ShaderLibrary variant
+struct BenchmarkDefine {
+    std::string name;
+    std::vector<std::string> values;
+};
+
+struct BenchmarkSettings {
+    std::vector<glm::uvec2> resolutions;
+    std::vector<BenchmarkDefine> defines;  // every combination of their values is run
+    int warmupFrames;
+    int timedFrames;
+
+    BenchmarkSettings()
+        : resolutions({ glm::uvec2(320, 240), glm::uvec2(640, 480), glm::uvec2(1280, 720), glm::uvec2(1920, 1080) }),
+          warmupFrames(2), timedFrames(20) {}
+};
+
+// Sets the uniforms and binds the textures the shader needs, it's already in use
+typedef std::function<void(Shader& shader, glm::vec2 resolution)> BenchmarkSetup;
+
+// Draws a vertex/fragment pair from the library on the Quad into an offscreen target at every resolution, with every
+// combination of the define values. Each frame is timed with its own GL timer query and flushed, as
+// llvmpipe and other software drivers only draw at a flush. Writes a CSV row per configuration with
+// the median and mean GPU ms of a frame and the ns per pixel of the median. Returns false if a
+// variant didn't compile, the rest are still run
+bool runShaderBenchmark(std::ostream& out, ShaderLibrary& library, const std::string& vertexPath, const std::string& fragmentPath,
+                        const BenchmarkSettings& settings, const BenchmarkSetup& setup);
+// "OCTAVES=1,2,4,8" to a define, false if there's no name or no values
+bool parseBenchmarkDefine(const char* text, BenchmarkDefine& define);
+// "640x480,1920x1080" to resolutions, false if any of them isn't one
+bool parseBenchmarkResolutions(const char* text, std::vector<glm::uvec2>& resolutions);
@@ -0,0 +1,172 @@
+#include "ShaderLibrary.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+// FNV-1a, enough to tell the sources of a few dozen variants apart
+static uint64_t hashText(const std::string& text, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// the directory of path with its /, or nothing
+static std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static std::string describe(const ShaderDefines& defines) {
+    std::string text;
+    for (const auto& define : defines)
+        text += " " + define.first + "=" + define.second;
+    return text;
+}
+
+
+std::string setDefine(const std::string& source, const std::string& name, const std::string& value) {
+    std::istringstream lines(source);
+    std::string line, result;
+    bool found = false;
+    size_t versionEnd = 0;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string directive, word;
+        words >> directive >> word;
+        if (directive == "#define" && word == name) {
+            line = "#define " + name + " " + value;
+            found = true;
+        }
+        result += line + '\n';
+        if (directive == "#version" && versionEnd == 0)
+            versionEnd = result.size();
+    }
+    if (!found)
+        result.insert(versionEnd, "#define " + name + " " + value + '\n');
+    return result;
+}
+
+
+ShaderLibrary::~ShaderLibrary() {
+    for (auto& variant : variants)
+        glDeleteProgram(variant.second->ID);
+    if (unreadable)
+        glDeleteProgram(unreadable->ID);
+}
+
+void ShaderLibrary::addFile(const std::string& path, const std::string& source) {
+    files[path] = source;
+}
+
+bool ShaderLibrary::preprocess(const std::string& path, const ShaderDefines& defines, std::string& source) {
+    std::vector<std::string> included;
+    return preprocess(path, defines, source, included);
+}
+
+Shader& ShaderLibrary::get(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines) {
+    std::string vertexCode, fragmentCode;
+    std::vector<std::string> vertexFiles, fragmentFiles;
+    // the missing file and what included it have been printed by then
+    if (!preprocess(vertexPath, defines, vertexCode, vertexFiles) || !preprocess(fragmentPath, defines, fragmentCode, fragmentFiles)) {
+        std::cout << "ERROR::SHADER_LIBRARY::VARIANT_NOT_READ " << vertexPath << " + " << fragmentPath << describe(defines) << std::endl;
+        if (!unreadable)
+            unreadable.reset(new Shader(Shader::unlinked()));
+        return *unreadable;
+    }
+    // the defines are in the sources now, so they're all there is to tell variants apart
+    uint64_t key = hashText(fragmentCode, hashText(vertexCode + '\0'));
+    auto found = variants.find(key);
+    if (found != variants.end())
+        return *found->second;
+
+    std::unique_ptr<Shader> shader(new Shader(Shader::fromSource(vertexCode, fragmentCode)));
+    GLint linked;
+    glGetProgramiv(shader->ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // the errors give lines as source:line, the source being the file's number here
+        std::cout << "ERROR::SHADER_LIBRARY::VARIANT_NOT_COMPILED " << fragmentPath << describe(defines) << "\n";
+        for (size_t i = 0; i < fragmentFiles.size(); i++)
+            std::cout << "  " << i << ": " << fragmentFiles[i] << "\n";
+        std::cout << std::flush;
+    }
+    Shader& variant = *shader;
+    variants[key] = std::move(shader);
+    return variant;
+}
+
+size_t ShaderLibrary::variantCount() const {
+    return variants.size();
+}
+
+bool ShaderLibrary::preprocess(const std::string& path, const ShaderDefines& defines, std::string& source, std::vector<std::string>& included) {
+    source.clear();
+    included.assign(1, path);
+    if (!expand(path, included, source))
+        return false;
+    for (const auto& define : defines)
+        source = setDefine(source, define.first, define.second);
+    return true;
+}
+
+const std::string* ShaderLibrary::findFile(const std::string& path) {
+    auto found = files.find(path);
+    if (found != files.end())
+        return &found->second;
+    std::ifstream file(path);
+    if (!file)
+        return nullptr;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return &(files[path] = stream.str());
+}
+
+bool ShaderLibrary::expand(const std::string& path, std::vector<std::string>& included, std::string& out) {
+    const std::string* source = findFile(path);
+    if (source == nullptr) {
+        std::cout << "ERROR::SHADER_LIBRARY::FILE_NOT_FOUND " << path << std::endl;
+        return false;
+    }
+    // the number of this file among the shader's sources, for #line
+    size_t index = included.size() - 1;
+
+    std::istringstream lines(*source);
+    std::string line;
+    int number = 0;
+    while (std::getline(lines, line)) {
+        number++;
+        std::istringstream words(line);
+        std::string directive;
+        words >> directive;
+        if (directive != "#include") {
+            out += line + '\n';
+            continue;
+        }
+
+        size_t open = line.find('"'), close = line.rfind('"');
+        if (open == std::string::npos || close == open) {
+            std::cout << "ERROR::SHADER_LIBRARY::BAD_INCLUDE " << path << ":" << number << std::endl;
+            return false;
+        }
+        std::string includePath = directoryOf(path) + line.substr(open + 1, close - open - 1);
+        bool already = false;
+        for (const std::string& file : included)
+            already = already || file == includePath;
+        if (already) {
+            // an empty line keeps the numbering
+            out += '\n';
+            continue;
+        }
+        included.push_back(includePath);
+        out += "#line 1 " + std::to_string(included.size() - 1) + '\n';
+        if (!expand(includePath, included, out)) {
+            std::cout << "  included from " << path << ":" << number << std::endl;
+            return false;
+        }
+        out += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + '\n';
+    }
+    return true;
+}
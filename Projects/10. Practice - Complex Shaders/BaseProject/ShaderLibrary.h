@@ -0,0 +1,56 @@
+#pragma once
+#include <glad/glad.h>
+#include <shaders/shader.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// #defines a variant is built with, name to value. Kept sorted so the same set always comes out the same
+typedef std::map<std::string, std::string> ShaderDefines;
+
+// The source with each "#define name" line set to value, or one added after #version if it has none
+std::string setDefine(const std::string& source, const std::string& name, const std::string& value);
+
+// Shader programs built from a base vertex/fragment pair and a set of #defines. Sources come from a
+// virtual file system: files added in memory, and anything else read from disk the first time it's
+// needed. #include "path" pulls in another file, relative to the one including it, at most once per
+// shader. A variant is compiled the first time it's asked for and kept by a hash of its sources with
+// the includes and defines in, so asking again, or for another set that comes out the same, costs no
+// compile
+class ShaderLibrary {
+public:
+    ShaderLibrary() = default;
+    ~ShaderLibrary();
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    // adds a file to the virtual file system, or replaces it. Programs already built keep the old source
+    void addFile(const std::string& path, const std::string& source);
+
+    // The source of path with its #includes resolved and the defines set. Returns false if it or an
+    // include couldn't be found
+    bool preprocess(const std::string& path, const ShaderDefines& defines, std::string& source);
+
+    // The program for the pair with these defines, built the first time. If it didn't compile the
+    // program is still returned, without a valid link status, and the error printed. If a file or
+    // include couldn't be read an unlinked program is returned instead and nothing is kept, so it's
+    // tried again next time
+    Shader& get(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines = ShaderDefines());
+
+    // programs built so far
+    size_t variantCount() const;
+
+private:
+    std::unordered_map<std::string, std::string> files;
+    std::unordered_map<uint64_t, std::unique_ptr<Shader>> variants;
+    std::unique_ptr<Shader> unreadable;  // what get() hands out for sources it couldn't read
+
+    // as the public one, with the files it took in, their numbers in #line
+    bool preprocess(const std::string& path, const ShaderDefines& defines, std::string& source, std::vector<std::string>& included);
+    const std::string* findFile(const std::string& path);
+    bool expand(const std::string& path, std::vector<std::string>& included, std::string& out);
+};
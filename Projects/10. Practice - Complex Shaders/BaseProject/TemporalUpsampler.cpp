@@ -0,0 +1,160 @@
+#include "TemporalUpsampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// i-th number of the Halton sequence in base b, spread evenly over 0-1 however many are taken
+static float halton(unsigned int i, unsigned int base) {
+    float result = 0.0f, fraction = 1.0f;
+    while (i > 0) {
+        fraction /= base;
+        result += fraction * (i % base);
+        i /= base;
+    }
+    return result;
+}
+
+
+TemporalUpsampler::TemporalUpsampler(Quad& quad, unsigned int width, unsigned int height, const std::string& shaderDirectory)
+    : quad(quad), shader((shaderDirectory + "standard.vs").c_str(), (shaderDirectory + "upsample.fs").c_str()),
+      width(width), height(height), currentScale(settings.scale), historyIndex(0), historyValid(false), frame(0),
+      queriesStarted(0), queriesRead(0), firstAtScale(0), timing(false), lastMs(0.0), summedMs(0.0), summedFrames(0) {
+    glGenQueries(QUERY_COUNT, queries);
+    resize(width, height);
+}
+
+TemporalUpsampler::~TemporalUpsampler() {
+    // a query still being waited on is deleted along with the rest
+    glDeleteQueries(QUERY_COUNT, queries);
+    glDeleteProgram(shader.ID);
+}
+
+void TemporalUpsampler::resize(unsigned int width, unsigned int height) {
+    if (history[0] && width == this->width && height == this->height)
+        return;
+    this->width = std::max(1u, width);
+    this->height = std::max(1u, height);
+    // the history keeps fractions of samples for a while, so it's kept in half floats
+    history[0].reset(new RenderTarget(this->width, this->height, GL_RGBA16F));
+    history[1].reset(new RenderTarget(this->width, this->height, GL_RGBA16F));
+    historyValid = false;
+    createLowTarget();
+}
+
+void TemporalUpsampler::begin() {
+    // against the clamped scale, or one out of range would make a new target every frame
+    float fixedScale = glm::clamp(settings.scale, settings.minScale, settings.maxScale);
+    if (!settings.autoScale && fixedScale != currentScale) {
+        currentScale = fixedScale;
+        createLowTarget();
+    }
+
+    // timings are read a few frames late so nothing waits on the GPU, and skipped if they fall behind
+    timing = queriesStarted - queriesRead < QUERY_COUNT;
+    if (timing)
+        glBeginQuery(GL_TIME_ELAPSED, queries[queriesStarted % QUERY_COUNT]);
+    low->bind();
+}
+
+void TemporalUpsampler::resolve(glm::vec2 motion, unsigned int framebuffer) {
+    RenderTarget& previous = *history[historyIndex];
+    RenderTarget& next = *history[1 - historyIndex];
+
+    next.bind();
+    shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, low->texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, previous.texture);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("u_current", 0);
+    shader.setInt("u_history", 1);
+    shader.setVec2("u_resolution", glm::vec2((float) width, (float) height));
+    shader.setVec2("u_lowResolution", lowResolution());
+    shader.setVec2("u_jitter", jitter());
+    shader.setVec2("u_motion", motion);
+    shader.setFloat("u_blend", settings.blend);
+    shader.setBool("u_historyValid", historyValid);
+    quad.draw();
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, next.FBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queriesStarted++;
+    }
+    readTimings();
+    adjustScale();
+
+    historyIndex = 1 - historyIndex;
+    historyValid = true;
+    frame++;
+}
+
+glm::vec2 TemporalUpsampler::lowResolution() const {
+    return glm::vec2((float) low->width, (float) low->height);
+}
+
+glm::vec2 TemporalUpsampler::jitter() const {
+    unsigned int i = frame % JITTER_COUNT + 1;
+    return glm::vec2(halton(i, 2), halton(i, 3)) - 0.5f;
+}
+
+float TemporalUpsampler::scale() const {
+    return currentScale;
+}
+
+double TemporalUpsampler::frameMilliseconds() const {
+    return lastMs;
+}
+
+void TemporalUpsampler::createLowTarget() {
+    unsigned int lowWidth = std::max(1u, (unsigned int) std::lround(width * currentScale));
+    unsigned int lowHeight = std::max(1u, (unsigned int) std::lround(height * currentScale));
+    low.reset(new RenderTarget(lowWidth, lowHeight));
+    // frames still in flight were drawn at the old size
+    firstAtScale = queriesStarted;
+    summedMs = 0.0;
+    summedFrames = 0;
+}
+
+void TemporalUpsampler::readTimings() {
+    while (queriesRead < queriesStarted) {
+        unsigned int query = queries[queriesRead % QUERY_COUNT];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        lastMs = elapsed / 1e6;
+        if (queriesRead >= firstAtScale) {
+            summedMs += lastMs;
+            summedFrames++;
+        }
+        queriesRead++;
+    }
+}
+
+void TemporalUpsampler::adjustScale() {
+    if (!settings.autoScale || summedFrames < ADJUST_FRAMES)
+        return;
+    double averageMs = summedMs / summedFrames;
+    summedMs = 0.0;
+    summedFrames = 0;
+
+    // the shader's cost goes with its pixels, the square of the scale. A step at a time so one slow
+    // frame doesn't throw it, and in 1/32s so it doesn't reallocate for every small wobble
+    float step = (float) std::sqrt(settings.targetMs / std::max(averageMs, 0.001));
+    float scale = currentScale * glm::clamp(step, 0.8f, 1.25f);
+    scale = glm::clamp(std::round(scale * 32.0f) / 32.0f, settings.minScale, settings.maxScale);
+    if (scale != currentScale) {
+        currentScale = scale;
+        createLowTarget();
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <memory>
+#include <string>
+
+#include "Quad.h"
+#include "RenderTarget.h"
+
+struct UpsampleSettings {
+    float scale = 0.5f;       // of the output resolution in each direction, what the shader renders at
+    bool autoScale = true;    // change scale to hold targetMs
+    float targetMs = 16.0f;   // GPU time of a frame, the shader plus the reconstruction
+    float minScale = 0.25f;
+    float maxScale = 1.0f;
+    float blend = 0.2f;       // how much of a fully weighted new sample goes into the history
+};
+
+// Draws a shader at a fraction of the resolution and rebuilds the full resolution picture from
+// several frames. Every frame samples a different point inside each low resolution pixel (a Halton
+// sequence), and shaders/upsample.fs blends those samples into a full resolution history: moved by
+// how far the picture moved, clamped to the colours around it in the new frame so what's no longer
+// there fades out, and weighted by how close the nearest new sample fell to each output pixel.
+//
+// A frame is begin(), draw the shader with lowResolution() as u_resolution and jitter() as
+// u_jitter, then resolve()
+class TemporalUpsampler {
+public:
+    UpsampleSettings settings;
+
+    TemporalUpsampler(Quad& quad, unsigned int width, unsigned int height, const std::string& shaderDirectory = "shaders/");
+    ~TemporalUpsampler();
+    TemporalUpsampler(const TemporalUpsampler&) = delete;
+    TemporalUpsampler& operator=(const TemporalUpsampler&) = delete;
+
+    // output size, starts the history over if it changed
+    void resize(unsigned int width, unsigned int height);
+
+    // binds the low resolution target for the shader to draw into
+    void begin();
+    // reconstructs this frame into framebuffer, motion is how far in uv (0-1) the picture moved since
+    // the last frame
+    void resolve(glm::vec2 motion, unsigned int framebuffer = 0);
+
+    glm::vec2 lowResolution() const;
+    // in low resolution pixels from the centre, -0.5 to 0.5
+    glm::vec2 jitter() const;
+    float scale() const;
+    // GPU time of the last frame that's been measured, 0 until there is one
+    double frameMilliseconds() const;
+
+private:
+    static const int QUERY_COUNT = 4;   // frames in flight before a timing is waited on
+    static const int JITTER_COUNT = 8;
+    static const int ADJUST_FRAMES = 8; // frames of timings between scale changes
+
+    Quad& quad;
+    Shader shader;
+    unsigned int width, height;
+    float currentScale;
+    std::unique_ptr<RenderTarget> low;
+    std::unique_ptr<RenderTarget> history[2];
+    int historyIndex;
+    bool historyValid;
+    unsigned int frame;
+
+    unsigned int queries[QUERY_COUNT];
+    unsigned int queriesStarted, queriesRead;
+    unsigned int firstAtScale;  // first query of a frame drawn at currentScale
+    bool timing;                // this frame's query has begun
+    double lastMs, summedMs;
+    int summedFrames;
+
+    void createLowTarget();
+    void readTimings();
+    void adjustScale();
+};
@@ -10,7 +10,72 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CpuShaders.h"
+#include "DistortionFields.h"
+#include "ImageDiff.h"
+#include "NoiseTextures.h"
+#include "Quad.h"
+#include "RenderTarget.h"
+#include "ShaderBenchmark.h"
+#include "ShaderLibrary.h"
+#include "TemporalUpsampler.h"
+
+// A shader of this project, drawn on the Quad. Its fragment shader is shaders/<name>.fs, the
+// version that reads its noise from NoiseTextures is shaders/<name>_baked.fs, and for those with
+// distortion() the version that reads q and r from DistortionFields is shaders/<name>_fields.fs
+struct Effect {
+    const char* name;
+    const char* vertexPath;
+    NoiseHash hash;    // the constants of the fragment shader's random()
+    glm::vec2 scroll;  // uv per second the picture moves up the screen, for TemporalUpsampler
+    bool distorted;    // has distortion(), and a _fields version
+};
+
+const Effect EFFECTS[] = {
+    { "noise",            "shaders/mousefire.vs", NoiseHash(),                                                  glm::vec2(0.0f),        false },
+    { "fire",             "shaders/fire.vs",      NoiseHash(),                                                  glm::vec2(0.0f, 0.7f),  true },
+    { "domaindistortion", "shaders/mousefire.vs", NoiseHash(glm::vec2(12.983f, 78.233f)),                       glm::vec2(0.0f, 0.1f),  true },
+    { "mousefire",        "shaders/mousefire.vs", NoiseHash(glm::vec2(43.2442f, 33.233f), 46388.5453123f),      glm::vec2(0.0f),        false },
+};
+const int EFFECT_COUNT = sizeof(EFFECTS) / sizeof(EFFECTS[0]);
+
+enum Shader_Variant {
+    VARIANT_ANALYTIC,
+    VARIANT_BAKED,
+    VARIANT_FIELDS
+};
+
+// --noise-diff draws every effect both ways at this size, at each of these times unless given one.
+// By 10 seconds fire has scrolled well past a period of the fBm
+const unsigned int DIFF_WIDTH = 800, DIFF_HEIGHT = 600;
+const float DIFF_TIMES[] = { 0.0f, 1.5f, 10.0f, 60.0f };
+const int DIFF_TIMED_FRAMES = 20;
+// --fields-diff renders the fields at these fractions of the resolution
+const float FIELD_SCALES[] = { 0.5f, 0.25f };
+
+const Effect* findEffect(const char* name);
+std::string fragmentPath(const Effect& effect, Shader_Variant variant);
+// Sets the uniforms every shader here reads
+void setUniforms(Shader& shader, glm::vec2 resolution, glm::vec2 mouse, float time);
+// Draws each effect analytic and baked offscreen at each time and writes one CSV row per effect and
+// time with the image difference between the two and the GPU time of each. Returns false if a shader
+// didn't load
+bool runNoiseDiff(std::ostream& out, ShaderLibrary& shaders, const std::vector<float>& times);
+// Draws each distorted effect in one pass and with DistortionFields, for every field scale and with
+// q or both q and r cached, scrolling for a run of frames. Writes one CSV row per configuration with
+// the GPU time of a frame each way and the image difference at the end. Returns false if a shader
+// didn't load
+bool runFieldsDiff(std::ostream& out, ShaderLibrary& shaders, float time);
+// Runs ShaderBenchmark on the shader named after --benchmark, with the options after it. Returns false
+// if an option wasn't understood or a shader didn't load
+bool runBenchmark(std::ostream& out, ShaderLibrary& shaders, int argc, char** argv);
 
 // Handles Window size changes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -23,12 +88,58 @@ unsigned int WIDTH  = 800;
 unsigned int HEIGHT = 600;
 
 
-int main() {
+int main(int argc, char** argv) {
+    // BaseProject [effect] [--baked | --fields [scale]] [--upsample [scale]]
+    // or  BaseProject --noise-diff [time]  or  BaseProject --fields-diff [time]
+    // (--noise-diff without a time goes through DIFF_TIMES)
+    // or  BaseProject --cpu-render [time] [width] [height]
+    // or  BaseProject --benchmark <fragment> [--vertex <vertex>] [--resolutions 640x480,...] [--define NAME=1,2,...]... [--frames n] [--time t]
+    if (argc > 1 && std::strcmp(argv[1], "--cpu-render") == 0) {
+        // no window or GL at all, the shaders run on the CPU
+        float time = argc > 2 ? (float) std::atof(argv[2]) : 0.0f;
+        unsigned int width = argc > 3 ? (unsigned int) std::atoi(argv[3]) : WIDTH;
+        unsigned int height = argc > 4 ? (unsigned int) std::atoi(argv[4]) : HEIGHT;
+        return benchmarkCpuShaders(std::cout, width, height, time, ".") ? 0 : -1;
+    }
+    bool noiseDiff = argc > 1 && std::strcmp(argv[1], "--noise-diff") == 0;
+    bool fieldsDiff = argc > 1 && std::strcmp(argv[1], "--fields-diff") == 0;
+    bool benchmark = argc > 1 && std::strcmp(argv[1], "--benchmark") == 0;
+    float diffTime = (noiseDiff || fieldsDiff) && argc > 2 ? (float) std::atof(argv[2]) : 0.0f;
+    const Effect* effect = findEffect("mousefire");
+    bool baked = false;
+    float fieldScale = 0.0f;  // 0 draws distortion() in one pass
+    bool upsample = false;
+    float upsampleScale = 0.0f;  // 0 picks it to hold the frame time
+    for (int i = 1; i < argc && !noiseDiff && !fieldsDiff && !benchmark; i++) {
+        if (std::strcmp(argv[i], "--baked") == 0)
+            baked = true;
+        else if (std::strcmp(argv[i], "--fields") == 0) {
+            fieldScale = 0.5f;
+            if (i + 1 < argc && std::atof(argv[i + 1]) > 0.0)
+                fieldScale = (float) std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--upsample") == 0) {
+            upsample = true;
+            if (i + 1 < argc && std::atof(argv[i + 1]) > 0.0)
+                upsampleScale = (float) std::atof(argv[++i]);
+        }
+        else if (findEffect(argv[i]) != nullptr)
+            effect = findEffect(argv[i]);
+        else
+            std::cout << "Unknown argument " << argv[i] << std::endl;
+    }
+    if (fieldScale > 0.0f && (baked || !effect->distorted)) {
+        std::cout << "--fields is for the analytic fire and domaindistortion, drawing " << effect->name << " without it\n";
+        fieldScale = 0.0f;
+    }
+
     // GLFW WINDOW HINTS
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (noiseDiff || fieldsDiff || benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     // GLFW WINDOW CREATION
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "The Real", NULL, NULL);
@@ -46,102 +157,373 @@ int main() {
     }
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
+    // Every program here is built through this, from shaders/ and its includes
+    ShaderLibrary shaders;
 
-    // COMPILE AND CREATE SHADERS
-    Shader shaderProgram = Shader("shaders/mousefire.vs", "shaders/mousefire.fs");
-
-    // VERTEX DATA
-    float vertices[] = {
-         // positions       // Colors
-        -1.0f,  1.0f, 0.0f,  0.0f,   // top left
-         1.0f,  1.0f, 0.0f,  0.0f,   // top right
-         1.0f, -1.0f, 0.0f,  1.0f,   // bottom right
-        -1.0f, -1.0f, 0.0f,  1.0f,   // bottom left
-    };
-    unsigned int indices[]{
-        0, 1, 2,  // 1st triangle
-        0, 2, 3,  // 2nd triangle
-    };
-
-    // Creating Objects to send to GPU
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    // Binding VAO 
-    glBindVertexArray(VAO);
-
-    // Adding vertices to VBO
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    if (noiseDiff) {
+        std::vector<float> times(std::begin(DIFF_TIMES), std::end(DIFF_TIMES));
+        if (argc > 2)
+            times.assign(1, diffTime);
+        bool loaded = runNoiseDiff(std::cout, shaders, times);
+        glfwTerminate();
+        return loaded ? 0 : 1;
+    }
+    if (fieldsDiff) {
+        bool loaded = runFieldsDiff(std::cout, shaders, diffTime);
+        glfwTerminate();
+        return loaded ? 0 : 1;
+    }
+    if (benchmark) {
+        bool ran = runBenchmark(std::cout, shaders, argc, argv);
+        glfwTerminate();
+        return ran ? 0 : 1;
+    }
 
-    // Specifies the location and data format of the bound VBO to use when rendering
-    // Positions
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*) 0);
-    glEnableVertexAttribArray(0);
+    // COMPILE AND CREATE SHADERS
+    Shader_Variant variant = baked ? VARIANT_BAKED : fieldScale > 0.0f ? VARIANT_FIELDS : VARIANT_ANALYTIC;
+    ShaderDefines defines;
+    Shader* shaderProgram = &shaders.get(effect->vertexPath, fragmentPath(*effect, variant), defines);
+    int octaves = NoiseTextures::OCTAVES;  // what the shaders have unless a variant sets OCTAVES
+
+    // Baked once here rather than per pixel every frame
+    std::unique_ptr<NoiseTextures> noiseTextures;
+    if (baked) {
+        noiseTextures.reset(new NoiseTextures(effect->hash));
+        std::cout << "Baked the noise of " << effect->name << " in " << noiseTextures->bakeMilliseconds << " ms\n";
+    }
 
-    // Color
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*) (3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Unbinding
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    Quad quad;
+
+    // q and r of distortion() at a fraction of the resolution, kept while they're in view
+    std::unique_ptr<DistortionFields> fields;
+    if (fieldScale > 0.0f)
+        fields.reset(new DistortionFields(quad, shaders, effect->hash, fieldScale));
+
+    // The shader at a fraction of the resolution, built back up over several frames
+    std::unique_ptr<TemporalUpsampler> upsampler;
+    if (upsample) {
+        upsampler.reset(new TemporalUpsampler(quad, WIDTH, HEIGHT));
+        if (upsampleScale > 0.0f) {
+            upsampler->settings.autoScale = false;
+            upsampler->settings.scale = upsampleScale;
+        }
+    }
+    float lastTime = (float) glfwGetTime();
+    double lastTitle = 0.0;
 
 
     // RENDER LOOP
     while (!glfwWindowShouldClose(window)) {
         // Key Input
         handleInput(window);
+        // 1-9 switch to a variant with that many octaves, compiled the first time
+        for (int key = GLFW_KEY_1; key <= GLFW_KEY_9; key++) {
+            if (glfwGetKey(window, key) != GLFW_PRESS || key - GLFW_KEY_0 == octaves)
+                continue;
+            octaves = key - GLFW_KEY_0;
+            defines["OCTAVES"] = std::to_string(octaves);
+            size_t built = shaders.variantCount();
+            shaderProgram = &shaders.get(effect->vertexPath, fragmentPath(*effect, variant), defines);
+            std::cout << "OCTAVES " << octaves << (shaders.variantCount() > built ? ", compiled" : ", already built")
+                      << (baked ? " (the baked fBm stays at " + std::to_string(NoiseTextures::OCTAVES) + ")" : "") << std::endl;
+        }
+
+        float time = (float) glfwGetTime();
+        glm::vec2 resolution((float) WIDTH, (float) HEIGHT);
+        double mouse_x, mouse_y;
+        glfwGetCursorPos(window, &mouse_x, &mouse_y);
+        // std::cout << mouse_x << " " << mouse_y << std::endl;
+        glm::vec2 mouse((float) mouse_x, (float) mouse_y);
 
         // Rendering
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        if (upsampler) {
+            upsampler->resize(WIDTH, HEIGHT);
+            upsampler->begin();
+            // the shader only knows the low resolution, the mouse is scaled down to it
+            glm::vec2 lowResolution = upsampler->lowResolution();
+            shaderProgram->use();
+            setUniforms(*shaderProgram, lowResolution, mouse * lowResolution / resolution, time);
+            shaderProgram->setVec2("u_jitter", upsampler->jitter());
+        }
+        else {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // Activate shader
+            shaderProgram->use();
+            setUniforms(*shaderProgram, resolution, mouse, time);
+        }
+        if (noiseTextures)
+            noiseTextures->bind(*shaderProgram);
+        if (fields) {
+            fields->update(upsampler ? upsampler->lowResolution() : resolution, effect->scroll * time);
+            shaderProgram->use();
+            fields->bind(*shaderProgram);
+        }
 
-        // Activate shader
-        shaderProgram.use();
+        // Draw triangle
+        quad.draw();
+
+        if (upsampler) {
+            upsampler->resolve(effect->scroll * (time - lastTime));
+            if (time - lastTitle > 1.0) {
+                std::string title = "The Real - " + std::to_string(int(upsampler->scale() * 100.0f + 0.5f)) + "% scale, "
+                    + std::to_string(upsampler->frameMilliseconds()) + " ms";
+                glfwSetWindowTitle(window, title.c_str());
+                lastTitle = time;
+            }
+        }
+        lastTime = time;
 
-        // Transforms
-        glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        glm::mat4 view = glm::mat4(1.0f);
-        glm::mat4 projection = glm::mat4(1.0f);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
 
-        model = glm::rotate(model, /* Note that -55, this angle, is in degrees. */ -55.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-        view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
-        projection = glm::perspective( /* Angle in degrees */ 45.0f, (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
+    glfwTerminate();
+    return 0;
+}
 
-        shaderProgram.setMat4("u_mvp", projection * view * model);
 
-        // Send resolution data to GPU
-        shaderProgram.setVec2("u_resolution", glm::vec2((float) WIDTH, (float) HEIGHT));
+const Effect* findEffect(const char* name) {
+    for (int i = 0; i < EFFECT_COUNT; i++) {
+        if (std::strcmp(EFFECTS[i].name, name) == 0)
+            return &EFFECTS[i];
+    }
+    return nullptr;
+}
 
-        double mouse_x, mouse_y;
-        glfwGetCursorPos(window, &mouse_x, &mouse_y);
-        // std::cout << mouse_x << " " << mouse_y << std::endl;
+std::string fragmentPath(const Effect& effect, Shader_Variant variant) {
+    const char* suffix = variant == VARIANT_BAKED ? "_baked.fs" : variant == VARIANT_FIELDS ? "_fields.fs" : ".fs";
+    return std::string("shaders/") + effect.name + suffix;
+}
 
-        shaderProgram.setVec2("u_mouse", glm::vec2((float) mouse_x, (float) mouse_y));
-        shaderProgram.setFloat("u_time", (float)glfwGetTime());
+void setUniforms(Shader& shader, glm::vec2 resolution, glm::vec2 mouse, float time) {
+    // Transforms
+    glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
 
-        // Bind the VAO
-        glBindVertexArray(VAO);
+    model = glm::rotate(model, /* Note that -55, this angle, is in degrees. */ -55.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+    projection = glm::perspective( /* Angle in degrees */ 45.0f, resolution.x / resolution.y, 0.1f, 100.0f);
 
-        // Draw triangle
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    shader.setMat4("u_mvp", projection * view * model);
 
-        glBindVertexArray(0);
+    // Send resolution data to GPU
+    shader.setVec2("u_resolution", resolution);
+    shader.setVec2("u_mouse", mouse);
+    shader.setFloat("u_time", time);
+}
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+bool runNoiseDiff(std::ostream& out, ShaderLibrary& shaders, const std::vector<float>& times) {
+    Quad quad;
+    RenderTarget analyticTarget(DIFF_WIDTH, DIFF_HEIGHT), bakedTarget(DIFF_WIDTH, DIFF_HEIGHT);
+    glm::vec2 resolution((float) DIFF_WIDTH, (float) DIFF_HEIGHT);
+    glm::vec2 mouse = resolution * 0.5f;
+    unsigned int query;
+    glGenQueries(1, &query);
+
+    // average GPU time of a frame, after one untimed one so nothing is still being set up
+    auto timeDraws = [&](const RenderTarget& target) {
+        target.bind();
+        quad.draw();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        // flushed like a frame each, some drivers (llvmpipe) only draw at a flush and would time nothing
+        for (int i = 0; i < DIFF_TIMED_FRAMES; i++) {
+            quad.draw();
+            glFlush();
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        return elapsed / 1e6 / DIFF_TIMED_FRAMES;
+    };
+
+    bool loaded = true;
+    out << "effect,width,height,time,bake_ms,analytic_ms,baked_ms,mean_error,rmse,psnr_db,max_error\n";
+    for (int i = 0; i < EFFECT_COUNT; i++) {
+        const Effect& effect = EFFECTS[i];
+        Shader& analytic = shaders.get(effect.vertexPath, fragmentPath(effect, VARIANT_ANALYTIC));
+        Shader& baked = shaders.get(effect.vertexPath, fragmentPath(effect, VARIANT_BAKED));
+        GLint linkedAnalytic, linkedBaked;
+        glGetProgramiv(analytic.ID, GL_LINK_STATUS, &linkedAnalytic);
+        glGetProgramiv(baked.ID, GL_LINK_STATUS, &linkedBaked);
+        if (!linkedAnalytic || !linkedBaked) {
+            loaded = false;
+            continue;
+        }
+        NoiseTextures noiseTextures(effect.hash);
+
+        for (float time : times) {
+            analytic.use();
+            setUniforms(analytic, resolution, mouse, time);
+            double analyticMs = timeDraws(analyticTarget);
+
+            baked.use();
+            setUniforms(baked, resolution, mouse, time);
+            noiseTextures.bind(baked);
+            double bakedMs = timeDraws(bakedTarget);
+
+            ImageDiff diff = compareImages(analyticTarget.readPixels(), bakedTarget.readPixels());
+            out << effect.name << ',' << DIFF_WIDTH << ',' << DIFF_HEIGHT << ',' << time << ',' << noiseTextures.bakeMilliseconds << ','
+                << analyticMs << ',' << bakedMs << ',' << diff.meanError << ',' << diff.rmse << ',' << diff.psnr << ',' << diff.maxError << '\n';
+        }
     }
 
-    glfwTerminate();
-    return 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteQueries(1, &query);
+    return loaded;
 }
 
+bool runFieldsDiff(std::ostream& out, ShaderLibrary& shaders, float time) {
+    Quad quad;
+    RenderTarget singleTarget(DIFF_WIDTH, DIFF_HEIGHT), fieldsTarget(DIFF_WIDTH, DIFF_HEIGHT);
+    glm::vec2 resolution((float) DIFF_WIDTH, (float) DIFF_HEIGHT);
+    glm::vec2 mouse = resolution * 0.5f;
+    unsigned int query;
+    glGenQueries(1, &query);
+
+    // frames go on from time at 60 a second, so the picture scrolls and the fields have rows to fill in
+    auto frameTime = [&](int frame) { return time + frame / 60.0f; };
+    // GPU ms of drawFrame(frame), averaged over DIFF_TIMED_FRAMES frames after frame 0
+    auto timeFrames = [&](auto drawFrame) {
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        // flushed like a frame each, some drivers (llvmpipe) only draw at a flush and would time nothing
+        for (int i = 1; i <= DIFF_TIMED_FRAMES; i++) {
+            drawFrame(i);
+            glFlush();
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        return elapsed / 1e6 / DIFF_TIMED_FRAMES;
+    };
+
+    bool loaded = true;
+    out << "effect,width,height,time,field_scale,cached,single_ms,fields_full_ms,frame_ms,speedup,texels_per_frame,mean_error,rmse,psnr_db,max_error\n";
+    for (int i = 0; i < EFFECT_COUNT; i++) {
+        const Effect& effect = EFFECTS[i];
+        if (!effect.distorted)
+            continue;
+        Shader& single = shaders.get(effect.vertexPath, fragmentPath(effect, VARIANT_ANALYTIC));
+        GLint linked;
+        glGetProgramiv(single.ID, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            loaded = false;
+            continue;
+        }
+
+        auto drawSingle = [&](int frame) {
+            singleTarget.bind();
+            single.use();
+            setUniforms(single, resolution, mouse, frameTime(frame));
+            quad.draw();
+        };
+        drawSingle(0);
+        double singleMs = timeFrames(drawSingle);
+        std::vector<unsigned char> singleImage = singleTarget.readPixels();
+
+        for (float scale : FIELD_SCALES) {
+            for (bool cacheR : { false, true }) {
+                ShaderDefines defines = { { "CACHED_R", cacheR ? "1" : "0" } };
+                Shader& fieldsShader = shaders.get(effect.vertexPath, fragmentPath(effect, VARIANT_FIELDS), defines);
+                glGetProgramiv(fieldsShader.ID, GL_LINK_STATUS, &linked);
+                if (!linked) {
+                    loaded = false;
+                    continue;
+                }
+                DistortionFields fields(quad, shaders, effect.hash, scale);
+                unsigned long long texels = 0;
+                auto drawFields = [&](int frame) {
+                    fieldsTarget.bind();
+                    fields.update(resolution, effect.scroll * frameTime(frame));
+                    texels += fields.texelsRendered();
+                    fieldsShader.use();
+                    setUniforms(fieldsShader, resolution, mouse, frameTime(frame));
+                    fields.bind(fieldsShader);
+                    quad.draw();
+                };
+
+                // the first frame renders all of the fields, timed after one that compiles the shaders
+                drawFields(0);
+                glFinish();
+                fields.invalidate();
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                drawFields(0);
+                glFlush();
+                glEndQuery(GL_TIME_ELAPSED);
+                GLuint64 elapsed;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                double fullMs = elapsed / 1e6;
+                texels = 0;
+                double frameMs = timeFrames(drawFields);
+
+                ImageDiff diff = compareImages(singleImage, fieldsTarget.readPixels());
+                out << effect.name << ',' << DIFF_WIDTH << ',' << DIFF_HEIGHT << ',' << frameTime(DIFF_TIMED_FRAMES) << ',' << scale << ','
+                    << (cacheR ? "q+r" : "q") << ',' << singleMs << ',' << fullMs << ',' << frameMs << ',' << singleMs / frameMs << ','
+                    << texels / DIFF_TIMED_FRAMES << ',' << diff.meanError << ',' << diff.rmse << ',' << diff.psnr << ',' << diff.maxError << '\n';
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteQueries(1, &query);
+    return loaded;
+}
+
+bool runBenchmark(std::ostream& out, ShaderLibrary& shaders, int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "--benchmark needs a fragment shader" << std::endl;
+        return false;
+    }
+    // a name is looked for in shaders/, anything with a / or an extension is taken as a path
+    auto shaderPath = [](const std::string& name, const char* extension) {
+        return name.find_first_of("/.") == std::string::npos ? "shaders/" + name + extension : name;
+    };
+    std::string fragment = shaderPath(argv[2], ".fs");
+    std::string vertex;
+    BenchmarkSettings settings;
+    float time = 1.0f;
+    for (int i = 3; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--vertex") == 0 && hasValue)
+            vertex = shaderPath(argv[++i], ".vs");
+        else if (std::strcmp(argv[i], "--resolutions") == 0 && hasValue && parseBenchmarkResolutions(argv[i + 1], settings.resolutions))
+            i++;
+        else if (std::strcmp(argv[i], "--define") == 0 && hasValue) {
+            BenchmarkDefine define;
+            if (!parseBenchmarkDefine(argv[++i], define)) {
+                std::cout << "Expected NAME=value,... after --define, got " << argv[i] << std::endl;
+                return false;
+            }
+            settings.defines.push_back(define);
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            settings.timedFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--time") == 0 && hasValue)
+            time = (float) std::atof(argv[++i]);
+        else {
+            std::cout << "Unknown or incomplete benchmark argument " << argv[i] << std::endl;
+            return false;
+        }
+    }
+
+    // one of the effects, analytic or baked, is drawn with its own vertex shader and noise textures
+    std::string name = argv[2];
+    bool baked = name.size() > 6 && name.compare(name.size() - 6, 6, "_baked") == 0;
+    const Effect* effect = findEffect(baked ? name.substr(0, name.size() - 6).c_str() : name.c_str());
+    if (vertex.empty())
+        vertex = effect != nullptr ? effect->vertexPath : "shaders/standard.vs";
+    std::unique_ptr<NoiseTextures> noiseTextures;
+    if (baked && effect != nullptr)
+        noiseTextures.reset(new NoiseTextures(effect->hash));
+
+    return runShaderBenchmark(out, shaders, vertex, fragment, settings, [&](Shader& shader, glm::vec2 resolution) {
+        setUniforms(shader, resolution, resolution * 0.5f, time);
+        if (noiseTextures)
+            noiseTextures->bind(shader);
+    });
+}
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -0,0 +1,24 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// q and r of distortion() for DistortionFields, at a texel of the fields a fixed distance apart in p.
+// The texture repeats, so a texel holds whichever p lands on it, texel + u_texelOffset
+uniform vec2 u_texelOffset;
+uniform float u_texelSize;      // p across a texel
+uniform vec2 u_hashDirection;   // the constants of the shader's own random()
+uniform float u_hashScale;
+
+#define HASH_DIRECTION u_hashDirection
+#define HASH_SCALE u_hashScale
+#include "include/noise.glsl"
+#include "include/distortion.glsl"
+
+void main() {
+    vec2 p = (gl_FragCoord.xy + u_texelOffset) * u_texelSize;
+
+    vec2 q = warpQ(p);
+    vec2 r = warpR(p, q);
+
+    FragColor = vec4(q, r);
+}
@@ -3,62 +3,23 @@
 out vec4 FragColor;
 
 uniform vec2 u_resolution;
+uniform vec2 u_jitter;  // where in the pixel to sample, from its centre, for TemporalUpsampler
 uniform float u_time;
 
-float random (in vec2 st) {
-    return fract(sin(dot(st.xy,
-                         vec2(12.983,78.233)))*
-        43758.5453123);
-}
-
-// Based on Morgan McGuire @morgan3d
-// https://www.shadertoy.com/view/4dS3Wd
-float noise (in vec2 st) {
-    vec2 i = floor(st);
-    vec2 f = fract(st);
-
-    // Four corners in 2D of a tile
-    float a = random(i);
-    float b = random(i + vec2(1.0, 0.0));
-    float c = random(i + vec2(0.0, 1.0));
-    float d = random(i + vec2(1.0, 1.0));
-
-    vec2 u = f * f * (3.0 - 2.0 * f);
-
-    return mix(a, b, u.x) +
-            (c - a)* u.y * (1.0 - u.x) +
-            (d - b) * u.x * u.y;
-}
-
-#define OCTAVES 6
-float fbm (in vec2 st) {
-    // Initial values
-    float value = 0.0;
-    float amplitude = .5;
-    float frequency = 0.;
-    //
-    // Loop of octaves
-    for (int i = 0; i < OCTAVES; i++) {
-        value += amplitude * noise(st);
-        st *= 2.;
-        amplitude *= .5;
-    }
-    return value;
-}
+#define HASH_DIRECTION vec2(12.983,78.233)
+#include "include/noise.glsl"
+#include "include/distortion.glsl"
 
 float distortion( in vec2 p )
 {
-    vec2 q = vec2( fbm( p + vec2(0.0,0.0) ),
-                   fbm( p + vec2(5.2,1.3) ) );
-
-    vec2 r = vec2( fbm( p + 4.0*q + vec2(1.7,9.2) ),
-                   fbm( p + 4.0*q + vec2(8.3,2.8) ) );
+    vec2 q = warpQ(p);
+    vec2 r = warpR(p, q);
 
     return fbm( p + 4.0*r );
 }
 
 void main() {
-    vec2 st = gl_FragCoord.xy/u_resolution.xy;
+    vec2 st = (gl_FragCoord.xy + u_jitter)/u_resolution.xy;
     st.x *= u_resolution.x/u_resolution.y;
     st.y -= u_time*0.1;
 
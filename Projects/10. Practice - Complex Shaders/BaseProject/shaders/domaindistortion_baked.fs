@@ -0,0 +1,35 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;  // where in the pixel to sample, from its centre, for TemporalUpsampler
+uniform float u_time;
+
+#include "include/noise_baked.glsl"
+#include "include/distortion.glsl"
+
+float distortion( in vec2 p )
+{
+    vec2 q = warpQ(p);
+    vec2 r = warpR(p, q);
+
+    return fbm( p + 4.0*r );
+}
+
+void main() {
+    vec2 st = (gl_FragCoord.xy + u_jitter)/u_resolution.xy;
+    st.x *= u_resolution.x/u_resolution.y;
+    st.y -= u_time*0.1;
+
+    float pixel_multiplier = 1.0f;
+    st *= pixel_multiplier;
+
+    vec3 red = vec3(0.9f, 0.2f, 0.1f);
+
+    vec3 color = vec3(0.0);
+    color += distortion(st*3.0);
+    color *= red;
+
+    FragColor = vec4(color,1.0);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 330 core
+
+out vec4 FragColor;
+in float aColor;
+
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;  // where in the pixel to sample, from its centre, for TemporalUpsampler
+uniform float u_time;
+uniform sampler2D u_fields;  // q in rg and r in ba at p / u_fieldExtent, from DistortionFields
+uniform vec2 u_fieldExtent;
+
+// 1 reads r from u_fields as well, 0 only q and works r out here. A #define rather than a uniform as
+// some drivers (llvmpipe) run both sides of a branch even when every pixel takes the same one
+#define CACHED_R 1
+
+#include "include/noise.glsl"
+#include "include/distortion.glsl"
+
+float distortion( in vec2 p )
+{
+    vec4 fields = texture(u_fields, p / u_fieldExtent);
+#if CACHED_R
+    vec2 r = fields.ba;
+#else
+    vec2 r = warpR(p, fields.rg);
+#endif
+
+    return fbm( p + 4.0*r ) * 18.0f + sin(u_time*0.3) * 3.0f;
+}
+
+void main() {
+    vec2 st = (gl_FragCoord.xy + u_jitter)/u_resolution.xy;
+    st.x *= u_resolution.x/u_resolution.y;
+    st.y -= u_time*0.7;
+
+    float pixel_multiplier = 1.0f;
+    st *= pixel_multiplier;
+
+    vec3 red = vec3(0.9f, 0.2f, 0.1f);
+
+    vec3 color = vec3(0.0);
+    color += distortion(st*3.0);
+    color *= red * aColor;
+
+    FragColor = vec4(color,1.0);
+}
\ No newline at end of file
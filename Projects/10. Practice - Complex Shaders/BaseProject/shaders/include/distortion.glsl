@@ -0,0 +1,11 @@
+// The warp fields of distortion(), q at p and r at p warped by q. Include after the fbm() to use
+
+vec2 warpQ (in vec2 p) {
+    return vec2( fbm( p + vec2(0.0,0.0) ),
+                 fbm( p + vec2(5.2,1.3) ) );
+}
+
+vec2 warpR (in vec2 p, in vec2 q) {
+    return vec2( fbm( p + 4.0*q + vec2(1.7,9.2) ),
+                 fbm( p + 4.0*q + vec2(8.3,2.8) ) );
+}
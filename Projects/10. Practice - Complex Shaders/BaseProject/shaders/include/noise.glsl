@@ -0,0 +1,67 @@
+// random, noise and fbm shared by the noise shaders. Before including this a shader can set
+// HASH_DIRECTION and HASH_SCALE to the constants of its own random(), and OCTAVES, or have
+// ShaderLibrary set them for a variant. The lattice wraps every NOISE_PERIOD cells for noise and every
+// FBM_PERIOD units for fbm, the periods NoiseTextures bakes, so the baked shaders match these wherever
+// they scroll to
+
+#ifndef HASH_DIRECTION
+#define HASH_DIRECTION vec2(12.9898,78.233)
+#endif
+#ifndef HASH_SCALE
+#define HASH_SCALE 43758.5453123
+#endif
+#ifndef OCTAVES
+#define OCTAVES 6
+#endif
+#ifndef NOISE_PERIOD
+#define NOISE_PERIOD 256.0
+#endif
+#ifndef FBM_PERIOD
+#define FBM_PERIOD 16.0
+#endif
+
+float random (in vec2 st) {
+    return fract(sin(dot(st.xy,
+                         HASH_DIRECTION))*
+        HASH_SCALE);
+}
+
+// Based on Morgan McGuire @morgan3d
+// https://www.shadertoy.com/view/4dS3Wd
+float noise (in vec2 st, in float period) {
+    vec2 i = floor(st);
+    vec2 f = fract(st);
+
+    // Four corners in 2D of a tile, wrapped every period cells
+    float a = random(mod(i, period));
+    float b = random(mod(i + vec2(1.0, 0.0), period));
+    float c = random(mod(i + vec2(0.0, 1.0), period));
+    float d = random(mod(i + vec2(1.0, 1.0), period));
+
+    vec2 u = f * f * (3.0 - 2.0 * f);
+
+    return mix(a, b, u.x) +
+            (c - a)* u.y * (1.0 - u.x) +
+            (d - b) * u.x * u.y;
+}
+
+float noise (in vec2 st) {
+    return noise(st, NOISE_PERIOD);
+}
+
+float fbm (in vec2 st) {
+    // Initial values
+    float value = 0.0;
+    float amplitude = .5;
+    float frequency = 0.;
+    float period = FBM_PERIOD;
+    //
+    // Loop of octaves
+    for (int i = 0; i < OCTAVES; i++) {
+        value += amplitude * noise(st, period);
+        st *= 2.;
+        period *= 2.;
+        amplitude *= .5;
+    }
+    return value;
+}
@@ -0,0 +1,16 @@
+// noise and fbm looked up in the tables NoiseTextures bakes from the shader's random(), instead of
+// hashing the corners of every cell per pixel. Both tile, every u_noisePeriod cells and every
+// u_fbmPeriod units. OCTAVES is baked into u_fbm, NoiseTextures::OCTAVES, and setting it does nothing
+
+uniform sampler2D u_noise;
+uniform sampler2D u_fbm;
+uniform float u_noisePeriod;
+uniform float u_fbmPeriod;
+
+float noise (in vec2 st) {
+    return texture(u_noise, st / u_noisePeriod).r;
+}
+
+float fbm (in vec2 st) {
+    return texture(u_fbm, st / u_fbmPeriod).r;
+}
@@ -0,0 +1,28 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;  // where in the pixel to sample, from its centre, for TemporalUpsampler
+uniform vec2 u_mouse;
+uniform float u_time;
+
+#include "include/noise_baked.glsl"
+
+
+void main() {
+    vec2 st = (gl_FragCoord.xy + u_jitter)/u_resolution;
+    
+    float pct = 0.0;
+
+    vec2 mouse_pos = vec2(u_mouse.x/u_resolution.x, -u_mouse.y/u_resolution.y + 1.0f);  // getting the relative mouse position
+
+    // a. The DISTANCE from the pixel to the center
+    pct = distance(st, mouse_pos)*10.0f;
+
+    vec3 color = vec3(pct) + fbm(st * 3.0f);
+    color = vec3(1.0f) - color; // inverse color
+    color *= vec3(0.8f, 0.3f, 0.1f);
+
+    FragColor = vec4(color, 1.0f);
+}
\ No newline at end of file
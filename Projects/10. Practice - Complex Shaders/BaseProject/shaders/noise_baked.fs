@@ -0,0 +1,20 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;  // where in the pixel to sample, from its centre, for TemporalUpsampler
+uniform float u_time;
+
+#include "include/noise_baked.glsl"
+
+void main() {
+    vec2 st = (gl_FragCoord.xy + u_jitter)/u_resolution.xy;
+    st.x *= u_resolution.x/u_resolution.y;
+    // st.x += u_time*0.25;
+
+    vec3 color = vec3(0.0);
+    color += fbm(st*3.0);
+
+    FragColor = vec4(color,1.0);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform sampler2D u_current;    // this frame, at the low resolution
+uniform sampler2D u_history;    // the last frame this put out
+uniform vec2 u_resolution;
+uniform vec2 u_lowResolution;
+uniform vec2 u_jitter;          // where this frame sampled in each low resolution pixel
+uniform vec2 u_motion;          // uv the picture moved since the last frame
+uniform float u_blend;
+uniform bool u_historyValid;
+
+const float MIN_CONFIDENCE = 0.25;  // pixels between samples still follow the clamp
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / u_resolution;
+
+    // the low resolution pixel whose sample fell nearest, and how far off it fell in output pixels
+    vec2 lowPosition = uv * u_lowResolution - u_jitter;
+    ivec2 maxTexel = ivec2(u_lowResolution) - 1;
+    ivec2 texel = clamp(ivec2(floor(lowPosition)), ivec2(0), maxTexel);
+    vec2 offset = (lowPosition - (vec2(texel) + 0.5)) * u_resolution / u_lowResolution;
+    vec3 nearest = texelFetch(u_current, texel, 0).rgb;
+
+    // the new frame upscaled, for where there's no history to go on
+    vec2 historyUV = uv - u_motion;
+    if (!u_historyValid || any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0)))) {
+        FragColor = vec4(texture(u_current, uv - u_jitter / u_lowResolution).rgb, 1.0);
+        return;
+    }
+
+    // the new frame filtered from the samples around, each weighted by how far it fell from this
+    // pixel in low resolution pixels. Their colour range is what the history is clamped to, history
+    // outside it is of something that's moved on or changed
+    vec3 current = vec3(0.0);
+    float total = 0.0;
+    vec3 low = nearest;
+    vec3 high = nearest;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec3 neighbour = texelFetch(u_current, clamp(texel + ivec2(x, y), ivec2(0), maxTexel), 0).rgb;
+            vec2 distance = lowPosition - (vec2(texel + ivec2(x, y)) + 0.5);
+            float weight = exp(-2.29 * dot(distance, distance));
+            current += neighbour * weight;
+            total += weight;
+            low = min(low, neighbour);
+            high = max(high, neighbour);
+        }
+    }
+    current /= total;
+    vec3 history = clamp(texture(u_history, historyUV).rgb, low, high);
+
+    // a sample right on this pixel makes the new frame count fully, further off it counts for less
+    float confidence = max(exp(-2.0 * dot(offset, offset)), MIN_CONFIDENCE);
+    FragColor = vec4(mix(history, current, u_blend * confidence), 1.0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+// The bounds of everything that might be drawn, a sphere and an axis aligned box around the same
+// centre for each object. Stored as separate x / y / z / radius / extent arrays padded to a multiple
+// of 4, so the frustum tests 4 objects per SSE instruction
+class CullBounds {
+public:
+    // adds an object and returns its index
+    size_t add(glm::vec3 centre, float radius, glm::vec3 halfExtent);
+    // moves an object that's already been added
+    void set(size_t index, glm::vec3 centre, float radius, glm::vec3 halfExtent);
+    void clear();
+
+    size_t size() const { return count; }
+
+private:
+    friend class Frustum;
+    size_t count = 0;
+    std::vector<float> x, y, z, radius;
+    std::vector<float> extentX, extentY, extentZ;
+};
+
+// The six planes of the camera's view volume, taken from projection * view with their normals
+// pointing in. Something is culled only when it's entirely behind one of them, so a few objects
+// near the corners are kept that are really off screen, but nothing on screen is ever culled
+class Frustum {
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    void update(const glm::mat4& viewProjection);
+
+    // Each set visible[i] to whether object i may be on screen and return how many are. cull() tests
+    // the spheres, then the boxes of only those batches a sphere got through
+    size_t cullSpheres(const CullBounds& bounds, std::vector<unsigned char>& visible) const;
+    size_t cullBoxes(const CullBounds& bounds, std::vector<unsigned char>& visible) const;
+    size_t cull(const CullBounds& bounds, std::vector<unsigned char>& visible) const;
+
+    // left, right, bottom, top, near, far: xyz the unit normal and w the distance
+    const glm::vec4& plane(int index) const { return planes[index]; }
+
+private:
+    glm::vec4 planes[6];
+
+    size_t test(const CullBounds& bounds, std::vector<unsigned char>& visible, bool spheres, bool boxes) const;
+};
+
+// The half extents of the axis aligned box around a box of halfExtent after transform, for objects
+// that rotate
+glm::vec3 transformedExtent(const glm::mat4& transform, glm::vec3 halfExtent);
@@ -12,6 +12,10 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
+#include <string>
+#include <vector>
+
+#include "Frustum.h"
 
 // Handles Window size changes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -236,6 +240,17 @@ int main() {
     }
     stbi_image_free(data);
 
+    // Culling
+    const int CUBES = 3;
+    const float CUBE_RADIUS = 0.8660254f;  // half the diagonal of a unit cube
+    glm::vec3 cubePos[CUBES];
+    glm::mat4 cubeModel[CUBES];
+    CullBounds cubeBounds;
+    for (int i = 0; i < CUBES; i++)
+        cubeBounds.add(glm::vec3(0.0f), CUBE_RADIUS, glm::vec3(0.5f));
+    Frustum frustum;
+    std::vector<unsigned char> cubeVisible;
+
     // RENDER LOOP
     while (!glfwWindowShouldClose(window)) {
 
@@ -260,7 +275,6 @@ int main() {
         glBindTexture(GL_TEXTURE_2D, chadTexture);
 
         // Matrices
-        glm::mat4 model = glm::mat4(1.0f);
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::perspective(45.0f, (float)WIDTH / HEIGHT, 0.1f, 100.0f);  // projection remains the same for all cubes
 
@@ -272,76 +286,46 @@ int main() {
         float velocity;
 
         // Cube 1 (Center)
-
-        // Rotations
         rotDir = glm::vec3(0.3f, 0.7f, 0.2f);
         rotVelocity = 20.0f;
-        // Position
-        glm::vec3 cube1Pos = glm::vec3(0.0f, 0.0f, 0.0f);;
-
-        // Transforms
-        model = glm::rotate(model, (float)glfwGetTime() * rotVelocity, rotDir);
-        view = glm::translate(view, cube1Pos);
-
-        // Uniforms
-        triangleProgram.setMat4("model", model);
-        triangleProgram.setMat4("view", view);
-        triangleProgram.setMat4("projection", projection);
-
-        // Draw triangle
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
+        cubePos[0] = glm::vec3(0.0f, 0.0f, 0.0f);
+        cubeModel[0] = glm::rotate(glm::mat4(1.0f), (float) glfwGetTime() * rotVelocity, rotDir);
 
         // Cube 2 (Rotating around Cube 1)
-
-        // Matrices
-        model = glm::mat4(1.0f);
-        view = camera.GetViewMatrix();
-
-        // Rotations
         rotDir = glm::vec3(0.5f, 0.2f, 0.4f);
         rotVelocity = 50.0f;
-        // Position
         velocity = 3.0f;
-        glm::vec3 cube2Pos = glm::vec3(sin((float)glfwGetTime() * velocity) * 4, cos((float)glfwGetTime() * velocity) * 2, -cos((float)glfwGetTime() * velocity) * 8) + cube1Pos;
-
-        // Transforms
-        model = glm::rotate(model, (float)glfwGetTime() * rotVelocity, rotDir);
-        view = glm::translate(view, cube2Pos);
-
-        // Uniforms
-        triangleProgram.setMat4("model", model);
-        triangleProgram.setMat4("view", view);
-        triangleProgram.setMat4("projection", projection);
-
-        // Draw triangle
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
+        cubePos[1] = glm::vec3(sin((float)glfwGetTime() * velocity) * 4, cos((float)glfwGetTime() * velocity) * 2, -cos((float)glfwGetTime() * velocity) * 8) + cubePos[0];
+        cubeModel[1] = glm::rotate(glm::mat4(1.0f), (float) glfwGetTime() * rotVelocity, rotDir);
 
         // Cube 3 (Rotating around Cube 1)
-
-        // Matrices
-        model = glm::mat4(1.0f);
-        view = camera.GetViewMatrix();
-
-        // Rotations
         rotDir = glm::vec3(0.1f, 0.2f, 0.9f);
         rotVelocity = 100.0f;
-        // Position
         velocity = 2.0f;
-        glm::vec3 cube3Pos = glm::vec3(sin((float)glfwGetTime() * velocity) * 8, cos((float)glfwGetTime() * velocity) * 2, cos((float)glfwGetTime() * velocity) * 10) + cube1Pos;
-
-        // Transforms
-        model = glm::rotate(model, (float)glfwGetTime() * rotVelocity, rotDir);
-        view = glm::translate(view, cube3Pos);
-
-        // Uniforms
-        triangleProgram.setMat4("model", model);
-        triangleProgram.setMat4("view", view);
-        triangleProgram.setMat4("projection", projection);
-
-        // Draw triangle
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        cubePos[2] = glm::vec3(sin((float)glfwGetTime() * velocity) * 8, cos((float)glfwGetTime() * velocity) * 2, cos((float)glfwGetTime() * velocity) * 10) + cubePos[0];
+        cubeModel[2] = glm::rotate(glm::mat4(1.0f), (float) glfwGetTime() * rotVelocity, rotDir);
+
+        // Culling - only the cubes the camera can see are drawn
+        for (int i = 0; i < CUBES; i++)
+            cubeBounds.set(i, cubePos[i], CUBE_RADIUS, transformedExtent(cubeModel[i], glm::vec3(0.5f)));
+        frustum.update(projection * view);
+        size_t drawn = frustum.cull(cubeBounds, cubeVisible);
+
+        for (int i = 0; i < CUBES; i++) {
+            if (!cubeVisible[i])
+                continue;
+
+            // Uniforms
+            triangleProgram.setMat4("model", cubeModel[i]);
+            triangleProgram.setMat4("view", glm::translate(view, cubePos[i]));
+            triangleProgram.setMat4("projection", projection);
+
+            // Draw triangle
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        }
+
+        std::string title = "The Real - " + std::to_string(drawn) + " / " + std::to_string(CUBES) + " cubes drawn";
+        glfwSetWindowTitle(window, title.c_str());
         // ----------------- DRAWING SCENE TO FRAMEBUFFER END
 
         // ----------------- RENDERING SCENE ON SCREEN
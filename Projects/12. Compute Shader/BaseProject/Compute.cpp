@@ -1,7 +1,17 @@
 #include "Compute.h"
 
-ComputeShader::ComputeShader(const char* computePath, unsigned int textureWidth, unsigned int textureHeight, unsigned int activeTexture) {
-	std::string computeCode;
+#include <limits>
+
+// workgroup sizes autotune tries, the multiples of 32/64 invocations first
+const glm::uvec2 AUTOTUNE_CANDIDATES[] = {
+    glm::uvec2(8, 8), glm::uvec2(16, 16), glm::uvec2(32, 8), glm::uvec2(8, 32), glm::uvec2(16, 8),
+    glm::uvec2(32, 32), glm::uvec2(64, 1), glm::uvec2(256, 1), glm::uvec2(4, 4), glm::uvec2(1, 1),
+};
+// dispatches timed per candidate
+const int AUTOTUNE_DISPATCHES = 20;
+
+ComputeShader::ComputeShader(const char* computePath, unsigned int textureWidth, unsigned int textureHeight, unsigned int activeTexture,
+                             glm::uvec2 localSize) {
 	std::ifstream computeShaderFile;
 	computeShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try
@@ -14,27 +24,16 @@ ComputeShader::ComputeShader(const char* computePath, unsigned int textureWidth,
         // close file handlers
         computeShaderFile.close();
         // convert stream into string
-        computeCode = computeShaderStream.str();
+        source = computeShaderStream.str();
     }
     catch (std::ifstream::failure& e)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
     }
-    const char* computeShaderCode = computeCode.c_str();
-    // 2. compile shaders
-    unsigned int compute;
-    // vertex shader
-    compute = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(compute, 1, &computeShaderCode, NULL);
-    glCompileShader(compute);
-    checkCompileErrors(compute, "COMPUTE");
-    // shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, compute);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
-    // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(compute);
+    path = computePath;
+    this->localSize = localSize;
+    this->activeTexture = activeTexture;
+    compile();
 
     // --------------------------------------------------------------------------------
     texDim = glm::vec2(textureWidth, textureHeight);
@@ -54,8 +53,18 @@ ComputeShader::ComputeShader(const char* computePath, unsigned int textureWidth,
     glUseProgram(0);
 }
 
+ComputeShader::~ComputeShader() {
+    glDeleteProgram(ID);
+    glDeleteTextures(1, &texture);
+}
+
 void ComputeShader::setValues(float* values, glm::vec3 dim) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, dim.x, dim.y, dim.z, GL_RED, GL_FLOAT, values);
+    // fills the red channel of the RGBA32F texture in place, keeping the format the image unit expects
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, dim.x, dim.y, GL_RED, GL_FLOAT, values);
+    // the shader reads what was uploaded, so its output is stale
+    dirty = true;
+    generation++;
 }
 
 std::vector<float> ComputeShader::getValues(glm::vec3 dim) {
@@ -73,13 +82,199 @@ void ComputeShader::use() {
 }
 
 void ComputeShader::dispatch() {
-    glDispatchCompute(texDim.x, texDim.y, 1);
+    glm::uvec2 groups = groupCount();
+    glDispatchCompute(groups.x, groups.y, 1);
 }
 
 void ComputeShader::wait() {
     glMemoryBarrier(GL_ALL_BARRIER_BITS);
 }
 
+void ComputeShader::setLocalSize(glm::uvec2 size) {
+    if (size == localSize)
+        return;
+    localSize = size;
+    glDeleteProgram(ID);
+    compile();
+}
+
+glm::uvec2 ComputeShader::groupCount() const {
+    glm::uvec2 dim = glm::uvec2(texDim);
+    return (dim + localSize - 1u) / localSize;
+}
+
+glm::uvec2 ComputeShader::autotune(const char* cachePath) {
+    // results only carry over to the same kernel at the same size on the same GPU and driver
+    std::stringstream keyStream;
+    keyStream << glGetString(GL_VENDOR) << ' ' << glGetString(GL_RENDERER) << ' ' << glGetString(GL_VERSION) << '\t'
+              << path << '\t' << (unsigned int) texDim.x << 'x' << (unsigned int) texDim.y;
+    std::string key = keyStream.str();
+
+    // one line per kernel: "<device>\t<kernel>\t<width>x<height>\t<x> <y>"
+    std::vector<std::string> lines;
+    std::ifstream cacheFile(cachePath);
+    std::string line;
+    while (std::getline(cacheFile, line)) {
+        if (line.size() > key.size() && line.compare(0, key.size(), key) == 0 && line[key.size()] == '\t') {
+            glm::uvec2 size(0, 0);
+            std::stringstream(line.substr(key.size() + 1)) >> size.x >> size.y;
+            if (size.x > 0 && size.y > 0) {
+                setLocalSize(size);
+                return size;
+            }
+            continue;
+        }
+        lines.push_back(line);
+    }
+    cacheFile.close();
+
+    GLint maxInvocations, maxX, maxY;
+    glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxInvocations);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &maxX);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &maxY);
+
+    unsigned int query;
+    glGenQueries(1, &query);
+    glm::uvec2 best = localSize;
+    GLuint64 bestTime = std::numeric_limits<GLuint64>::max();
+    for (glm::uvec2 candidate : AUTOTUNE_CANDIDATES) {
+        if (candidate.x * candidate.y > (unsigned int) maxInvocations || candidate.x > (unsigned int) maxX || candidate.y > (unsigned int) maxY)
+            continue;
+        setLocalSize(candidate);
+        use();
+        // the first dispatch pays for any lazy driver compilation
+        dispatch();
+        wait();
+
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        for (int i = 0; i < AUTOTUNE_DISPATCHES; i++) {
+            dispatch();
+            wait();
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 time;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time);
+        std::cout << "workgroup " << candidate.x << "x" << candidate.y << ": " << time / 1000.0 / AUTOTUNE_DISPATCHES << " us per dispatch\n";
+        if (time < bestTime) {
+            bestTime = time;
+            best = candidate;
+        }
+    }
+    glDeleteQueries(1, &query);
+    setLocalSize(best);
+
+    std::ofstream out(cachePath);
+    for (const std::string& kept : lines)
+        out << kept << '\n';
+    out << key << '\t' << best.x << ' ' << best.y << '\n';
+    if (!out)
+        std::cout << "ERROR::COMPUTE::AUTOTUNE_CACHE_NOT_WRITTEN: " << cachePath << std::endl;
+    return best;
+}
+
+bool ComputeShader::update() {
+    for (std::pair<const uint64_t*, uint64_t>& input : inputs) {
+        if (*input.first != input.second) {
+            input.second = *input.first;
+            dirty = true;
+        }
+    }
+    if (!dirty) {
+        dispatchesSkipped++;
+        return false;
+    }
+
+    use();
+    dispatch();
+    dirty = false;
+    dispatchesRun++;
+    generation++;
+    for (uint64_t* output : outputs)
+        (*output)++;
+    return true;
+}
+
+void ComputeShader::invalidate() {
+    dirty = true;
+}
+
+void ComputeShader::dependsOn(const uint64_t* inputGeneration) {
+    inputs.push_back(std::make_pair(inputGeneration, *inputGeneration));
+    dirty = true;
+}
+
+void ComputeShader::writes(uint64_t* outputGeneration) {
+    outputs.push_back(outputGeneration);
+}
+
+void ComputeShader::setInt(const std::string& name, int value) {
+    setUniform(name, 1, true, glm::vec4((float) value, 0.0f, 0.0f, 0.0f));
+}
+
+void ComputeShader::setFloat(const std::string& name, float value) {
+    setUniform(name, 1, false, glm::vec4(value, 0.0f, 0.0f, 0.0f));
+}
+
+void ComputeShader::setVec2(const std::string& name, glm::vec2 value) {
+    setUniform(name, 2, false, glm::vec4(value, 0.0f, 0.0f));
+}
+
+void ComputeShader::setVec4(const std::string& name, glm::vec4 value) {
+    setUniform(name, 4, false, value);
+}
+
+void ComputeShader::setUniform(const std::string& name, int components, bool isInt, glm::vec4 value) {
+    std::map<std::string, Uniform>::iterator found = uniforms.find(name);
+    if (found != uniforms.end() && found->second.value == value)
+        return;
+    Uniform& uniform = uniforms[name];
+    uniform = { components, isInt, value };
+    applyUniform(name, uniform);
+    dirty = true;
+}
+
+void ComputeShader::applyUniform(const std::string& name, const Uniform& uniform) {
+    // glProgramUniform so the program doesn't have to be bound
+    GLint location = glGetUniformLocation(ID, name.c_str());
+    if (uniform.isInt)
+        glProgramUniform1i(ID, location, (int) uniform.value.x);
+    else if (uniform.components == 1)
+        glProgramUniform1f(ID, location, uniform.value.x);
+    else if (uniform.components == 2)
+        glProgramUniform2f(ID, location, uniform.value.x, uniform.value.y);
+    else
+        glProgramUniform4f(ID, location, uniform.value.x, uniform.value.y, uniform.value.z, uniform.value.w);
+}
+
+void ComputeShader::compile() {
+    // the workgroup size goes in as defines straight after the #version line
+    std::stringstream defines;
+    defines << "#define LOCAL_SIZE_X " << localSize.x << "\n#define LOCAL_SIZE_Y " << localSize.y << "\n";
+    std::string computeCode = source;
+    size_t versionEnd = computeCode.find('\n', computeCode.find("#version"));
+    computeCode.insert(versionEnd == std::string::npos ? computeCode.size() : versionEnd + 1, defines.str());
+
+    const char* computeShaderCode = computeCode.c_str();
+    // 2. compile shaders
+    unsigned int compute;
+    // vertex shader
+    compute = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compute, 1, &computeShaderCode, NULL);
+    glCompileShader(compute);
+    checkCompileErrors(compute, "COMPUTE");
+    // shader Program
+    ID = glCreateProgram();
+    glAttachShader(ID, compute);
+    glLinkProgram(ID);
+    checkCompileErrors(ID, "PROGRAM");
+    // delete the shaders as they're linked into our program now and no longer necessary
+    glDeleteShader(compute);
+
+    // a new program starts with default uniforms
+    for (const std::pair<const std::string, Uniform>& uniform : uniforms)
+        applyUniform(uniform.first, uniform.second);
+}
+
 void ComputeShader::checkCompileErrors(GLuint shader, std::string type) {
     GLint success;
     GLchar infoLog[1024];
@@ -101,4 +296,51 @@ void ComputeShader::checkCompileErrors(GLuint shader, std::string type) {
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
-}
\ No newline at end of file
+}
+
+unsigned int loadComputeProgram(const std::string& path, const std::string& defines) {
+    std::string code;
+    std::ifstream file;
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        file.open(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        file.close();
+        code = stream.str();
+    }
+    catch (std::ifstream::failure& e)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << " " << e.what() << std::endl;
+    }
+
+    size_t versionEnd = code.find('\n', code.find("#version"));
+    code.insert(versionEnd == std::string::npos ? code.size() : versionEnd + 1, defines);
+    return compileComputeProgram(code, path);
+}
+
+unsigned int compileComputeProgram(const std::string& code, const std::string& name) {
+    const char* source = code.c_str();
+    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint success;
+    GLchar infoLog[1024];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+        std::cout << "ERROR::SHADER_COMPILATION_ERROR of " << name << "\n" << infoLog << std::endl;
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cout << "ERROR::PROGRAM_LINKING_ERROR of " << name << "\n" << infoLog << std::endl;
+    }
+    glDeleteShader(shader);
+    return program;
+}
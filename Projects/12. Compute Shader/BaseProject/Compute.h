@@ -7,6 +7,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <map>
 #include <vector>
 
 
@@ -14,14 +15,70 @@ class ComputeShader {
 public:
 	unsigned int ID, texture, activeTexture;
 	glm::vec2 texDim;
+	glm::uvec2 localSize;  // workgroup size, compiled in as LOCAL_SIZE_X / LOCAL_SIZE_Y
 	// A compute shader reading and writing to a texture of size width x height
-	ComputeShader(const char* computePath, unsigned int textureWidth, unsigned int textureHeight, unsigned int activeTexture);
+	ComputeShader(const char* computePath, unsigned int textureWidth, unsigned int textureHeight, unsigned int activeTexture,
+	              glm::uvec2 localSize = glm::uvec2(8, 8));
+	// deletes the program and the texture. Not copyable, and not movable either since other
+	// shaders may hold a pointer to its generation
+	~ComputeShader();
+	ComputeShader(const ComputeShader&) = delete;
+	ComputeShader& operator=(const ComputeShader&) = delete;
 	void setValues(float* values, glm::vec3 dim);
+	// blocks until the GPU is done, use a ComputeBuffer readback to keep the CPU going
 	std::vector<float> getValues(glm::vec3 dim);
 	void use();
 	void dispatch();
 	void wait();
 
+	// recompiles the shader for another workgroup size
+	void setLocalSize(glm::uvec2 size);
+	// workgroups needed to cover the texture, the shader skips the invocations past its edge
+	glm::uvec2 groupCount() const;
+
+	// Times every candidate workgroup size and keeps the fastest. The winner is saved in cachePath
+	// per kernel, texture size and device, later runs on the same device just read it back
+	glm::uvec2 autotune(const char* cachePath = "workgroups.cache");
+
+	// Lazy recomputation: the texture is a cached product of the uniforms, setValues and every
+	// generation counter passed to dependsOn. update() only dispatches when one of them changed
+	// since its last run, then bumps `generation` and every counter passed to writes
+	uint64_t generation = 0;
+	uint64_t dispatchesRun = 0;
+	uint64_t dispatchesSkipped = 0;
+	bool update();
+	// forces the next update() to dispatch
+	void invalidate();
+	void dependsOn(const uint64_t* inputGeneration);
+	void writes(uint64_t* outputGeneration);
+
+	// only change the program (and count as a change) when the value differs from the last one set
+	void setInt(const std::string& name, int value);
+	void setFloat(const std::string& name, float value);
+	void setVec2(const std::string& name, glm::vec2 value);
+	void setVec4(const std::string& name, glm::vec4 value);
+
 private:
+	struct Uniform {
+		int components;
+		bool isInt;
+		glm::vec4 value;
+	};
+
+	std::string path;
+	std::string source;
+	std::map<std::string, Uniform> uniforms;
+	std::vector<std::pair<const uint64_t*, uint64_t>> inputs;  // watched counter, its value at the last run
+	std::vector<uint64_t*> outputs;
+	bool dirty = true;
+
+	void setUniform(const std::string& name, int components, bool isInt, glm::vec4 value);
+	void applyUniform(const std::string& name, const Uniform& uniform);
+	void compile();
 	void checkCompileErrors(GLuint shader, std::string type);
 };
+
+// Compiles the compute shader at path into a program, with defines inserted after its #version line
+unsigned int loadComputeProgram(const std::string& path, const std::string& defines = "");
+// Compiles compute shader source into a program, name is only used in error messages
+unsigned int compileComputeProgram(const std::string& code, const std::string& name);
@@ -0,0 +1,129 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// A typed shader storage buffer of `count` T's. The storage is immutable (glBufferStorage), only its
+// contents change: update() rewrites a sub-range in place and readback() copies a range into a
+// persistently mapped staging buffer behind a fence, so the CPU can keep going and pick the
+// results up once ready() says the GPU is done. T has to match the std430 layout of the shader's
+// buffer block (scalars, vec2/vec4-like structs; vec3 pads to 16 bytes).
+template <typename T>
+class ComputeBuffer {
+public:
+    unsigned int ID;
+    // bumped by update(). Pass it to ComputeShader::dependsOn to recompute when the buffer changes,
+    // and to ComputeShader::writes if a shader fills it
+    uint64_t generation = 0;
+
+    ComputeBuffer(size_t count, const T* values = nullptr) : count(count) {
+        // GL won't create empty storage
+        size_t storage = count > 0 ? bytes() : sizeof(T);
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, storage, values, GL_DYNAMIC_STORAGE_BIT);
+
+        // written by the GPU, read straight through the mapping by the CPU
+        glGenBuffers(1, &staging);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, storage, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+        mapped = (const T*) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, storage, flags);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ComputeBuffer(const std::vector<T>& values) : ComputeBuffer(values.size(), values.data()) {}
+
+    ~ComputeBuffer() {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &staging);
+        glDeleteBuffers(1, &ID);
+    }
+
+    ComputeBuffer(const ComputeBuffer&) = delete;
+    ComputeBuffer& operator=(const ComputeBuffer&) = delete;
+
+    size_t size() const { return count; }
+    size_t bytes() const { return count * sizeof(T); }
+
+    // binds the buffer to `layout(std430, binding = n) buffer` n
+    void bind(unsigned int binding) const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ID);
+    }
+
+    // overwrites values [first, first + n)
+    void update(size_t first, const T* values, size_t n) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, first * sizeof(T), n * sizeof(T), values);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        generation++;
+    }
+
+    void update(const std::vector<T>& values) { update(0, values.data(), values.size()); }
+
+    // Queues a copy of values [first, first + n) (n = 0 for the rest of the buffer) into the staging
+    // buffer and returns straight away. Starting another readback before this one is ready drops it.
+    // A range past the end is cut short at it. Shader writes to the buffer must be made visible with
+    // GL_BUFFER_UPDATE_BARRIER_BIT first
+    void readback(size_t first = 0, size_t n = 0) {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        readFirst = std::min(first, count);
+        readCount = n == 0 ? count - readFirst : std::min(n, count - readFirst);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readFirst * sizeof(T), readFirst * sizeof(T), readCount * sizeof(T));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        flushed = false;
+    }
+
+    // true once the last readback has landed in the staging buffer. Never blocks
+    bool ready() {
+        if (fence == nullptr)
+            return true;
+        // the first poll flushes so the fence is guaranteed to signal eventually
+        GLenum status = glClientWaitSync(fence, flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        flushed = true;
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glDeleteSync(fence);
+            fence = nullptr;
+            return true;
+        }
+        return false;
+    }
+
+    // the values the last readback copied, only valid while ready() is true
+    const T* results() const { return mapped + readFirst; }
+    size_t resultCount() const { return readCount; }
+
+    // blocks until the last readback is done and returns a copy of it
+    std::vector<T> wait() {
+        if (fence != nullptr) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        return std::vector<T>(results(), results() + readCount);
+    }
+
+private:
+    size_t count;
+    unsigned int staging;
+    const T* mapped;
+    GLsync fence = nullptr;
+    bool flushed = false;
+    size_t readFirst = 0;
+    size_t readCount = 0;
+};
@@ -0,0 +1,166 @@
+#include "CpuParticles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_PARTICLES_SSE
+#include <xmmintrin.h>
+#endif
+
+// bodies per SSE register
+const size_t LANES = 4;
+
+
+void makeGalaxy(size_t count, uint32_t seed, std::vector<glm::vec4>& positions, std::vector<glm::vec4>& velocities) {
+    const float RADIUS = 1.0f, THICKNESS = 0.02f, CENTRE_MASS = 1.0f, DISC_MASS = 1.0f;
+    positions.resize(count);
+    velocities.resize(count);
+    if (count == 0)
+        return;
+
+    // xorshift so every platform gets the same bodies
+    uint32_t state = seed != 0 ? seed : 2463534242u;
+    auto random = [&state] {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) / 16777216.0f;
+    };
+
+    positions[0] = glm::vec4(0.0f, 0.0f, 0.0f, CENTRE_MASS);
+    velocities[0] = glm::vec4(0.0f);
+    float mass = DISC_MASS / count;
+    for (size_t i = 1; i < count; i++) {
+        float r = RADIUS * (0.1f + 0.9f * std::sqrt(random()));
+        float angle = 6.2831853f * random();
+        float height = THICKNESS * (random() - 0.5f);
+        positions[i] = glm::vec4(r * std::cos(angle), height, r * std::sin(angle), mass);
+        // roughly circular orbits around the centre and the disc inside r
+        float enclosed = CENTRE_MASS + DISC_MASS * (r / RADIUS) * (r / RADIUS);
+        float speed = std::sqrt(enclosed / r);
+        velocities[i] = glm::vec4(-std::sin(angle) * speed, 0.0f, std::cos(angle) * speed, 0.0f);
+    }
+}
+
+
+CpuParticles::CpuParticles(const std::vector<glm::vec4>& positions, const std::vector<glm::vec4>& velocities, unsigned int threads)
+    : count(positions.size()), threads(threads) {
+    if (this->threads == 0)
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // the padding bodies have no mass, so they add nothing to anyone's acceleration
+    size_t padded = (count + LANES - 1) / LANES * LANES;
+    for (std::vector<float>* values : { &x, &y, &z, &mass, &vx, &vy, &vz, &nextX, &nextY, &nextZ })
+        values->assign(padded, 0.0f);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = positions[i].x;
+        y[i] = positions[i].y;
+        z[i] = positions[i].z;
+        mass[i] = positions[i].w;
+        vx[i] = velocities[i].x;
+        vy[i] = velocities[i].y;
+        vz[i] = velocities[i].z;
+    }
+}
+
+void CpuParticles::step(const ParticleSettings& settings) {
+    // every thread reads all of the old positions and writes its own range of the new ones
+    size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads && t * chunk < count; t++)
+        workers.emplace_back(&CpuParticles::integrate, this, t * chunk, std::min(count, (t + 1) * chunk), std::cref(settings));
+    integrate(0, std::min(count, chunk), settings);
+    for (std::thread& worker : workers)
+        worker.join();
+
+    x.swap(nextX);
+    y.swap(nextY);
+    z.swap(nextZ);
+}
+
+void CpuParticles::integrate(size_t first, size_t last, const ParticleSettings& settings) {
+    const size_t padded = x.size();
+#ifdef CPU_PARTICLES_SSE
+    const __m128 softening2 = _mm_set1_ps(settings.softening * settings.softening);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (size_t i = first; i < last; i++) {
+        const __m128 px = _mm_set1_ps(x[i]), py = _mm_set1_ps(y[i]), pz = _mm_set1_ps(z[i]);
+        __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps(), az = _mm_setzero_ps();
+        // 4 other bodies at a time, the body itself is 0 away and adds nothing
+        for (size_t j = 0; j < padded; j += LANES) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(&x[j]), px);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(&y[j]), py);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(&z[j]), pz);
+            __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_add_ps(_mm_mul_ps(dz, dz), softening2));
+            // a full precision 1 / sqrt, _mm_rsqrt_ps is too rough to compare against the GPU
+            __m128 inverse = _mm_div_ps(one, _mm_sqrt_ps(distance2));
+            __m128 strength = _mm_mul_ps(_mm_loadu_ps(&mass[j]), _mm_mul_ps(inverse, _mm_mul_ps(inverse, inverse)));
+            ax = _mm_add_ps(ax, _mm_mul_ps(strength, dx));
+            ay = _mm_add_ps(ay, _mm_mul_ps(strength, dy));
+            az = _mm_add_ps(az, _mm_mul_ps(strength, dz));
+        }
+        float sums[3][LANES];
+        _mm_storeu_ps(sums[0], ax);
+        _mm_storeu_ps(sums[1], ay);
+        _mm_storeu_ps(sums[2], az);
+#else
+    const float softening2 = settings.softening * settings.softening;
+
+    for (size_t i = first; i < last; i++) {
+        // a sum per lane as the SSE version keeps, so both add up in the same order
+        float sums[3][LANES] = {};
+        for (size_t j = 0; j < padded; j += LANES) {
+            for (size_t lane = 0; lane < LANES; lane++) {
+                float dx = x[j + lane] - x[i], dy = y[j + lane] - y[i], dz = z[j + lane] - z[i];
+                float distance2 = (dx * dx + dy * dy) + (dz * dz + softening2);
+                float inverse = 1.0f / std::sqrt(distance2);
+                float strength = mass[j + lane] * (inverse * (inverse * inverse));
+                sums[0][lane] += strength * dx;
+                sums[1][lane] += strength * dy;
+                sums[2][lane] += strength * dz;
+            }
+        }
+#endif
+
+        float scale = settings.gravity * settings.dt;
+        vx[i] += scale * (sums[0][0] + sums[0][1] + sums[0][2] + sums[0][3]);
+        vy[i] += scale * (sums[1][0] + sums[1][1] + sums[1][2] + sums[1][3]);
+        vz[i] += scale * (sums[2][0] + sums[2][1] + sums[2][2] + sums[2][3]);
+        nextX[i] = x[i] + vx[i] * settings.dt;
+        nextY[i] = y[i] + vy[i] * settings.dt;
+        nextZ[i] = z[i] + vz[i] * settings.dt;
+    }
+}
+
+std::vector<glm::vec4> CpuParticles::positions() const {
+    std::vector<glm::vec4> values(count);
+    for (size_t i = 0; i < count; i++)
+        values[i] = glm::vec4(x[i], y[i], z[i], mass[i]);
+    return values;
+}
+
+std::vector<glm::vec4> CpuParticles::velocities() const {
+    std::vector<glm::vec4> values(count);
+    for (size_t i = 0; i < count; i++)
+        values[i] = glm::vec4(vx[i], vy[i], vz[i], 0.0f);
+    return values;
+}
+
+
+void benchmarkCpuParticles(std::ostream& out, size_t count, int steps) {
+    std::vector<glm::vec4> positions, velocities;
+    makeGalaxy(count, 0, positions, velocities);
+    CpuParticles cpu(positions, velocities);
+    ParticleSettings settings;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++)
+        cpu.step(settings);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out << count << " bodies, " << steps << " steps, " << cpu.threadCount() << " CPU threads: " << seconds * 1000.0 << " ms, "
+        << (double) count * count * steps / seconds / 1e6 << " M pairs/s\n";
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+// Simulation constants shared by the GPU and CPU integrators
+struct ParticleSettings {
+    float dt = 0.002f;
+    float gravity = 1.0f;
+    float softening = 0.05f;  // keeps close encounters finite, its square is added to every squared distance
+};
+
+// A rotating disc of count bodies of equal mass around a heavier centre, xyz position with mass in w
+// and xyz velocity. The same seed always gives the same bodies
+void makeGalaxy(size_t count, uint32_t seed, std::vector<glm::vec4>& positions, std::vector<glm::vec4>& velocities);
+
+// All pairs gravity on the CPU, the reference for the compute shader when there is no GPU to
+// compare against. Bodies are stored as separate x / y / z / mass arrays padded to a multiple of
+// 4 with massless bodies, so the inner loop does 4 pairs per SSE instruction (4 at a time in plain
+// C++ off x86). The bodies are split
+// between all hardware threads.
+// A step is the same as shaders/particles/nbody.cs: softened acceleration from every body, then
+// velocity and position integrated with semi-implicit Euler
+class CpuParticles {
+public:
+    CpuParticles(const std::vector<glm::vec4>& positions, const std::vector<glm::vec4>& velocities, unsigned int threads = 0);
+
+    void step(const ParticleSettings& settings);
+
+    size_t size() const { return count; }
+    unsigned int threadCount() const { return threads; }
+    std::vector<glm::vec4> positions() const;
+    std::vector<glm::vec4> velocities() const;
+
+private:
+    size_t count;
+    unsigned int threads;
+    std::vector<float> x, y, z, mass;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> nextX, nextY, nextZ;
+
+    void integrate(size_t first, size_t last, const ParticleSettings& settings);
+};
+
+// Times count bodies for a number of steps without any GL, for machines with no GPU to compare against
+void benchmarkCpuParticles(std::ostream& out, size_t count, int steps);
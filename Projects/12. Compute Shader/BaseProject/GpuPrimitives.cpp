@@ -0,0 +1,292 @@
+#include "GpuPrimitives.h"
+#include "Compute.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+// workgroups the grid-stride kernels are launched with at most
+const unsigned int MAX_STRIDE_GROUPS = 1024;
+// calls timed per primitive and size
+const int CHECK_ITERATIONS = 10;
+
+
+// Compiles the kernel at path with the workgroup size and bin count defined after #version
+static unsigned int loadKernel(const std::string& path) {
+    std::stringstream defines;
+    defines << "#define WORKGROUP_SIZE " << GpuPrimitives::WORKGROUP_SIZE << "\n#define MAX_BINS " << GpuPrimitives::MAX_BINS << "\n";
+    return loadComputeProgram(path, defines.str());
+}
+
+static void setUint(unsigned int program, const char* name, uint32_t value) {
+    glProgramUniform1ui(program, glGetUniformLocation(program, name), value);
+}
+
+static unsigned int blockCount(size_t count) {
+    return (unsigned int) ((count + 2 * GpuPrimitives::WORKGROUP_SIZE - 1) / (2 * GpuPrimitives::WORKGROUP_SIZE));
+}
+
+static unsigned int strideGroups(size_t count) {
+    return (unsigned int) std::max<size_t>(1, std::min<size_t>(MAX_STRIDE_GROUPS, (count + GpuPrimitives::WORKGROUP_SIZE - 1) / GpuPrimitives::WORKGROUP_SIZE));
+}
+
+
+GpuPrimitives::GpuPrimitives(const std::string& shaderDirectory) {
+    reduceProgram = loadKernel(shaderDirectory + "reduce.cs");
+    scanProgram = loadKernel(shaderDirectory + "scan.cs");
+    scanAddProgram = loadKernel(shaderDirectory + "scan_add.cs");
+    compactProgram = loadKernel(shaderDirectory + "compact.cs");
+    histogramProgram = loadKernel(shaderDirectory + "histogram.cs");
+    total.reset(new ComputeBuffer<uint32_t>(1));
+}
+
+GpuPrimitives::~GpuPrimitives() {
+    glDeleteProgram(reduceProgram);
+    glDeleteProgram(scanProgram);
+    glDeleteProgram(scanAddProgram);
+    glDeleteProgram(compactProgram);
+    glDeleteProgram(histogramProgram);
+}
+
+ComputeBuffer<uint32_t>& GpuPrimitives::scratch(std::vector<std::unique_ptr<ComputeBuffer<uint32_t>>>& buffers, size_t level, size_t count) {
+    if (level >= buffers.size())
+        buffers.resize(level + 1);
+    if (buffers[level] == nullptr || buffers[level]->size() < count)
+        buffers[level].reset(new ComputeBuffer<uint32_t>(count));
+    return *buffers[level];
+}
+
+uint32_t GpuPrimitives::reduce(ComputeBuffer<uint32_t>& input) {
+    size_t count = input.size();
+    if (count == 0)
+        return 0;
+    if (count > MAX_COUNT) {
+        std::cout << "ERROR::PRIMITIVES::TOO_MANY_VALUES " << count << std::endl;
+        return 0;
+    }
+
+    // each pass leaves one sum per workgroup until a single one is left
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUseProgram(reduceProgram);
+    ComputeBuffer<uint32_t>* from = &input;
+    for (size_t level = 0; level == 0 || count > 1; level++) {
+        unsigned int groups = blockCount(count);
+        ComputeBuffer<uint32_t>& to = scratch(sums, level, groups);
+        from->bind(0);
+        to.bind(1);
+        setUint(reduceProgram, "count", (uint32_t) count);
+        glDispatchCompute(groups, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        from = &to;
+        count = groups;
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    from->readback(0, 1);
+    return from->wait()[0];
+}
+
+void GpuPrimitives::scan(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, bool inclusive) {
+    if (input.size() == 0)
+        return;
+    if (input.size() > MAX_COUNT) {
+        std::cout << "ERROR::PRIMITIVES::TOO_MANY_VALUES " << input.size() << std::endl;
+        return;
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    scan(input, output, input.size(), inclusive, 0);
+}
+
+void GpuPrimitives::scan(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, size_t count, bool inclusive, size_t level) {
+    unsigned int groups = blockCount(count);
+    ComputeBuffer<uint32_t>& blockSums = scratch(sums, level, groups);
+
+    glUseProgram(scanProgram);
+    input.bind(0);
+    output.bind(1);
+    blockSums.bind(2);
+    setUint(scanProgram, "count", (uint32_t) count);
+    glProgramUniform1i(scanProgram, glGetUniformLocation(scanProgram, "inclusive"), inclusive);
+    glDispatchCompute(groups, 1, 1);
+    if (groups == 1)
+        return;
+
+    // every block after the first starts from the total of the blocks before it
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    ComputeBuffer<uint32_t>& blockOffsets = scratch(scannedSums, level, groups);
+    scan(blockSums, blockOffsets, groups, false, level + 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(scanAddProgram);
+    output.bind(0);
+    blockOffsets.bind(1);
+    setUint(scanAddProgram, "count", (uint32_t) count);
+    glDispatchCompute(groups, 1, 1);
+}
+
+size_t GpuPrimitives::compact(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, uint32_t threshold) {
+    size_t count = input.size();
+    if (count == 0)
+        return 0;
+    if (count > MAX_COUNT) {
+        std::cout << "ERROR::PRIMITIVES::TOO_MANY_VALUES " << count << std::endl;
+        return 0;
+    }
+    if (flags == nullptr || flags->size() < count) {
+        flags.reset(new ComputeBuffer<uint32_t>(count));
+        positions.reset(new ComputeBuffer<uint32_t>(count));
+    }
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUseProgram(compactProgram);
+    input.bind(0);
+    flags->bind(1);
+    output.bind(2);
+    total->bind(3);
+    setUint(compactProgram, "count", (uint32_t) count);
+    setUint(compactProgram, "threshold", threshold);
+    glProgramUniform1i(compactProgram, glGetUniformLocation(compactProgram, "scatter"), 0);
+    glDispatchCompute(strideGroups(count), 1, 1);
+
+    // the exclusive scan of the flags is where each kept value goes
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    scan(*flags, *positions, count, false, 0);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(compactProgram);
+    input.bind(0);
+    positions->bind(1);
+    output.bind(2);
+    total->bind(3);
+    glProgramUniform1i(compactProgram, glGetUniformLocation(compactProgram, "scatter"), 1);
+    glDispatchCompute(strideGroups(count), 1, 1);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    total->readback(0, 1);
+    return total->wait()[0];
+}
+
+void GpuPrimitives::histogram(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& bins, unsigned int shift) {
+    if (bins.size() == 0 || bins.size() > MAX_BINS || (bins.size() & (bins.size() - 1)) != 0) {
+        std::cout << "ERROR::PRIMITIVES::BAD_BIN_COUNT " << bins.size() << std::endl;
+        return;
+    }
+    bins.update(std::vector<uint32_t>(bins.size(), 0));
+    if (input.size() == 0)
+        return;
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUseProgram(histogramProgram);
+    input.bind(0);
+    bins.bind(1);
+    setUint(histogramProgram, "count", (uint32_t) input.size());
+    setUint(histogramProgram, "shift", shift);
+    setUint(histogramProgram, "binMask", (uint32_t) bins.size() - 1);
+    glDispatchCompute(strideGroups(input.size()), 1, 1);
+}
+
+
+uint32_t referenceReduce(const std::vector<uint32_t>& values) {
+    uint32_t sum = 0;
+    for (uint32_t value : values)
+        sum += value;
+    return sum;
+}
+
+std::vector<uint32_t> referenceScan(const std::vector<uint32_t>& values, bool inclusive) {
+    std::vector<uint32_t> result(values.size());
+    uint32_t sum = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (inclusive)
+            sum += values[i];
+        result[i] = sum;
+        if (!inclusive)
+            sum += values[i];
+    }
+    return result;
+}
+
+std::vector<uint32_t> referenceCompact(const std::vector<uint32_t>& values, uint32_t threshold) {
+    std::vector<uint32_t> result;
+    for (uint32_t value : values) {
+        if (value < threshold)
+            result.push_back(value);
+    }
+    return result;
+}
+
+std::vector<uint32_t> referenceHistogram(const std::vector<uint32_t>& values, size_t bins, unsigned int shift) {
+    std::vector<uint32_t> result(bins, 0);
+    for (uint32_t value : values)
+        result[(value >> shift) & (bins - 1)]++;
+    return result;
+}
+
+
+// the first n values of a buffer, blocking
+static std::vector<uint32_t> readBuffer(ComputeBuffer<uint32_t>& buffer, size_t n) {
+    if (n == 0)
+        return {};
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    buffer.readback(0, n);
+    return buffer.wait();
+}
+
+bool checkGpuPrimitives(std::ostream& out) {
+    const size_t SIZES[] = { 1, 2, 511, 512, 513, 1000, 262145, 1 << 20, 1 << 22 };
+    const unsigned int BINS = 256, SHIFT = 24;
+    const uint32_t THRESHOLD = 1u << 31;
+
+    GpuPrimitives primitives;
+    unsigned int query;
+    glGenQueries(1, &query);
+    bool allMatch = true;
+
+    out << "primitive,size,matches,gpu_ms,melem_per_s\n";
+    for (size_t size : SIZES) {
+        // xorshift, every bit of the values used so the wrapping sums and bins get exercised
+        std::vector<uint32_t> values(size);
+        uint32_t state = 2463534242u;
+        for (uint32_t& value : values) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            value = state;
+        }
+        ComputeBuffer<uint32_t> input(values);
+        ComputeBuffer<uint32_t> output(size);
+        ComputeBuffer<uint32_t> bins(BINS);
+
+        // runs one primitive once for its result, then times it
+        auto check = [&](const char* name, bool matches, const std::function<void()>& run) {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for (int i = 0; i < CHECK_ITERATIONS; i++)
+                run();
+            glEndQuery(GL_TIME_ELAPSED);
+            GLuint64 time;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time);
+            double ms = time / 1e6 / CHECK_ITERATIONS;
+            out << name << ',' << size << ',' << (matches ? "yes" : "no") << ',' << ms << ',' << size / (ms * 1000.0) << '\n';
+            allMatch = allMatch && matches;
+        };
+
+        check("reduce", primitives.reduce(input) == referenceReduce(values), [&] { primitives.reduce(input); });
+
+        primitives.scan(input, output, true);
+        check("inclusive-scan", readBuffer(output, size) == referenceScan(values, true), [&] { primitives.scan(input, output, true); });
+
+        primitives.scan(input, output, false);
+        check("exclusive-scan", readBuffer(output, size) == referenceScan(values, false), [&] { primitives.scan(input, output, false); });
+
+        std::vector<uint32_t> expected = referenceCompact(values, THRESHOLD);
+        size_t kept = primitives.compact(input, output, THRESHOLD);
+        check("compact", kept == expected.size() && readBuffer(output, kept) == expected, [&] { primitives.compact(input, output, THRESHOLD); });
+
+        primitives.histogram(input, bins, SHIFT);
+        check("histogram", readBuffer(bins, BINS) == referenceHistogram(values, BINS, SHIFT), [&] { primitives.histogram(input, bins, SHIFT); });
+        out.flush();
+    }
+    glDeleteQueries(1, &query);
+    return allMatch;
+}
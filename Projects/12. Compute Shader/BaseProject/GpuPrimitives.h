@@ -0,0 +1,56 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ComputeBuffer.h"
+
+// Parallel building blocks on uint buffers, all shared memory kernels in shaders/primitives/:
+//   reduce     sum of every value (wrapping like uint32_t)
+//   scan       inclusive or exclusive prefix sums, work-efficient per block plus a scan of the block totals
+//   compact    stream compaction of the values below a threshold, order kept
+//   histogram  counts of (value >> shift) & (bins - 1)
+// Only core GL 4.3 compute is used (no subgroup extensions), so llvmpipe and other software
+// implementations give the same results as a GPU. Each has a plain C++ reference below.
+class GpuPrimitives {
+public:
+    // threads per workgroup, the block kernels handle twice as many values per workgroup
+    static const unsigned int WORKGROUP_SIZE = 256;
+    static const unsigned int MAX_BINS = 4096;
+    // the block kernels need one workgroup per 2 * WORKGROUP_SIZE values
+    static const size_t MAX_COUNT = (size_t) 65535 * 2 * WORKGROUP_SIZE;
+
+    GpuPrimitives(const std::string& shaderDirectory = "shaders/primitives/");
+    ~GpuPrimitives();
+
+    uint32_t reduce(ComputeBuffer<uint32_t>& input);
+    // output must be a different buffer at least as large as input
+    void scan(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, bool inclusive);
+    // writes the values of input below threshold to the front of output, returns how many
+    size_t compact(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, uint32_t threshold);
+    // bins.size() must be a power of two no larger than MAX_BINS, it's overwritten
+    void histogram(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& bins, unsigned int shift);
+
+private:
+    unsigned int reduceProgram, scanProgram, scanAddProgram, compactProgram, histogramProgram;
+    // scratch per recursion level of scan/reduce, grown on demand
+    std::vector<std::unique_ptr<ComputeBuffer<uint32_t>>> sums, scannedSums;
+    std::unique_ptr<ComputeBuffer<uint32_t>> flags, positions, total;  // compaction
+
+    ComputeBuffer<uint32_t>& scratch(std::vector<std::unique_ptr<ComputeBuffer<uint32_t>>>& buffers, size_t level, size_t count);
+    void scan(ComputeBuffer<uint32_t>& input, ComputeBuffer<uint32_t>& output, size_t count, bool inclusive, size_t level);
+};
+
+uint32_t referenceReduce(const std::vector<uint32_t>& values);
+std::vector<uint32_t> referenceScan(const std::vector<uint32_t>& values, bool inclusive);
+std::vector<uint32_t> referenceCompact(const std::vector<uint32_t>& values, uint32_t threshold);
+std::vector<uint32_t> referenceHistogram(const std::vector<uint32_t>& values, size_t bins, unsigned int shift);
+
+// Checks every primitive against its reference at awkward and large sizes and times it with GL
+// timer queries, one row per primitive and size. Returns false if anything didn't match
+bool checkGpuPrimitives(std::ostream& out);
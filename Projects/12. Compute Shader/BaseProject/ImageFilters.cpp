@@ -0,0 +1,274 @@
+#include "ImageFilters.h"
+#include "Compute.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <vector>
+#include <stb/stb_image.h>
+
+// runs timed per filter and path
+const int BENCHMARK_ITERATIONS = 10;
+// the two paths round differently (and the blurs go through a half float texture), 0-255
+const int BENCHMARK_TOLERANCE = 2;
+
+
+static unsigned int createTexture(GLenum format, unsigned int width, unsigned int height) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+static unsigned int createFramebuffer(unsigned int texture) {
+    unsigned int FBO;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return FBO;
+}
+
+static unsigned int groupsFor(unsigned int size, int tile) {
+    return (size + tile - 1) / tile;
+}
+
+
+ImageFilters::ImageFilters(unsigned int width, unsigned int height, const std::string& shaderDirectory)
+    : width(width), height(height) {
+    std::stringstream defines;
+    defines << "#define LINE_TILE " << LINE_TILE << "\n#define TILE " << TILE << "\n#define MAX_RADIUS " << MAX_RADIUS
+            << "\n#define MAX_BILATERAL_RADIUS " << MAX_BILATERAL_RADIUS << "\n";
+    separableProgram = loadComputeProgram(shaderDirectory + "separable.cs", defines.str());
+    sobelProgram = loadComputeProgram(shaderDirectory + "sobel.cs", defines.str());
+    bilateralProgram = loadComputeProgram(shaderDirectory + "bilateral.cs", defines.str());
+    gradeProgram = loadComputeProgram(shaderDirectory + "grade.cs", defines.str());
+
+    std::string vertex = shaderDirectory + "fullscreen.vs";
+    separableShader.reset(new Shader(vertex.c_str(), (shaderDirectory + "separable.fs").c_str()));
+    sobelShader.reset(new Shader(vertex.c_str(), (shaderDirectory + "sobel.fs").c_str()));
+    bilateralShader.reset(new Shader(vertex.c_str(), (shaderDirectory + "bilateral.fs").c_str()));
+    gradeShader.reset(new Shader(vertex.c_str(), (shaderDirectory + "grade.fs").c_str()));
+    presentShader.reset(new Shader(vertex.c_str(), (shaderDirectory + "present.fs").c_str()));
+
+    // the blurs' first pass keeps full precision for the second
+    intermediate = createTexture(GL_RGBA16F, width, height);
+    computeResult = createTexture(GL_RGBA8, width, height);
+    fragmentResult = createTexture(GL_RGBA8, width, height);
+    intermediateFBO = createFramebuffer(intermediate);
+    fragmentFBO = createFramebuffer(fragmentResult);
+    // core profile draws need a VAO bound even without attributes
+    glGenVertexArrays(1, &VAO);
+}
+
+ImageFilters::~ImageFilters() {
+    for (unsigned int program : { separableProgram, sobelProgram, bilateralProgram, gradeProgram })
+        glDeleteProgram(program);
+    unsigned int textures[] = { intermediate, computeResult, fragmentResult };
+    glDeleteTextures(3, textures);
+    unsigned int framebuffers[] = { intermediateFBO, fragmentFBO };
+    glDeleteFramebuffers(2, framebuffers);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+const char* ImageFilters::name(Filter_Type filter) {
+    switch (filter) {
+    case FILTER_GAUSSIAN:  return "gaussian";
+    case FILTER_BOX:       return "box";
+    case FILTER_SOBEL:     return "sobel";
+    case FILTER_BILATERAL: return "bilateral";
+    case FILTER_GRADE:     return "grade";
+    default:               return "none";
+    }
+}
+
+void ImageFilters::setWeights(unsigned int program, Filter_Type filter) {
+    int radius = std::min(std::max(settings.blurRadius, 0), MAX_RADIUS);
+    float weights[MAX_RADIUS + 1] = {};
+    float total = 0.0f;
+    for (int k = 0; k <= radius; k++) {
+        weights[k] = filter == FILTER_BOX ? 1.0f : std::exp(-float(k * k) / (2.0f * settings.gaussianSigma * settings.gaussianSigma));
+        total += k == 0 ? weights[k] : 2.0f * weights[k];
+    }
+    for (int k = 0; k <= radius; k++)
+        weights[k] /= total;
+    glProgramUniform1i(program, glGetUniformLocation(program, "radius"), radius);
+    glProgramUniform1fv(program, glGetUniformLocation(program, "weights"), MAX_RADIUS + 1, weights);
+}
+
+void ImageFilters::setUniforms(unsigned int program, Filter_Type filter) {
+    if (filter == FILTER_GAUSSIAN || filter == FILTER_BOX)
+        setWeights(program, filter);
+    else if (filter == FILTER_BILATERAL) {
+        glProgramUniform1i(program, glGetUniformLocation(program, "radius"), std::min(std::max(settings.bilateralRadius, 0), MAX_BILATERAL_RADIUS));
+        glProgramUniform1f(program, glGetUniformLocation(program, "spatialSigma"), settings.spatialSigma);
+        glProgramUniform1f(program, glGetUniformLocation(program, "rangeSigma"), settings.rangeSigma);
+    }
+    else if (filter == FILTER_GRADE) {
+        glProgramUniform1f(program, glGetUniformLocation(program, "exposure"), settings.exposure);
+        glProgramUniform1f(program, glGetUniformLocation(program, "contrast"), settings.contrast);
+        glProgramUniform1f(program, glGetUniformLocation(program, "saturation"), settings.saturation);
+        glProgramUniform3f(program, glGetUniformLocation(program, "lift"), settings.lift.x, settings.lift.y, settings.lift.z);
+        glProgramUniform3f(program, glGetUniformLocation(program, "gamma"), settings.gamma.x, settings.gamma.y, settings.gamma.z);
+        glProgramUniform3f(program, glGetUniformLocation(program, "gain"), settings.gain.x, settings.gain.y, settings.gain.z);
+    }
+}
+
+unsigned int ImageFilters::applyCompute(Filter_Type filter, unsigned int source) {
+    glActiveTexture(GL_TEXTURE0);
+    if (filter == FILTER_GAUSSIAN || filter == FILTER_BOX) {
+        glUseProgram(separableProgram);
+        setUniforms(separableProgram, filter);
+        // along the rows into the intermediate texture, then along its columns
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindImageTexture(0, intermediate, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glProgramUniform2i(separableProgram, glGetUniformLocation(separableProgram, "direction"), 1, 0);
+        glDispatchCompute(groupsFor(width, LINE_TILE), height, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        glBindTexture(GL_TEXTURE_2D, intermediate);
+        glBindImageTexture(0, computeResult, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        glProgramUniform2i(separableProgram, glGetUniformLocation(separableProgram, "direction"), 0, 1);
+        glDispatchCompute(groupsFor(height, LINE_TILE), width, 1);
+        return computeResult;
+    }
+
+    unsigned int program = filter == FILTER_SOBEL ? sobelProgram : filter == FILTER_BILATERAL ? bilateralProgram : gradeProgram;
+    glUseProgram(program);
+    setUniforms(program, filter);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glBindImageTexture(0, computeResult, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glDispatchCompute(groupsFor(width, TILE), groupsFor(height, TILE), 1);
+    return computeResult;
+}
+
+unsigned int ImageFilters::applyFragment(Filter_Type filter, unsigned int source) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, width, height);
+
+    if (filter == FILTER_GAUSSIAN || filter == FILTER_BOX) {
+        setUniforms(separableShader->ID, filter);
+        glProgramUniform2i(separableShader->ID, glGetUniformLocation(separableShader->ID, "direction"), 1, 0);
+        draw(*separableShader, source, intermediateFBO);
+        glProgramUniform2i(separableShader->ID, glGetUniformLocation(separableShader->ID, "direction"), 0, 1);
+        draw(*separableShader, intermediate, fragmentFBO);
+    }
+    else {
+        Shader& shader = filter == FILTER_SOBEL ? *sobelShader : filter == FILTER_BILATERAL ? *bilateralShader : *gradeShader;
+        setUniforms(shader.ID, filter);
+        draw(shader, source, fragmentFBO);
+    }
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return fragmentResult;
+}
+
+void ImageFilters::draw(Shader& shader, unsigned int source, unsigned int framebuffer) {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    shader.use();
+    shader.setInt("source", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ImageFilters::present(unsigned int texture) {
+    presentShader->use();
+    presentShader->setInt("tex", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+}
+
+
+unsigned int loadImage(const char* path, int* width, int* height) {
+    int channels;
+    // GL's first row is the bottom one
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path, width, height, &channels, 4);
+    if (data == nullptr) {
+        std::cout << "Failed to load texture " << path << std::endl;
+        return 0;
+    }
+    unsigned int texture = createTexture(GL_RGBA8, *width, *height);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, *width, *height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    stbi_image_free(data);
+    return texture;
+}
+
+static std::vector<unsigned char> readTexture(unsigned int texture, int width, int height) {
+    std::vector<unsigned char> pixels((size_t) width * height * 4);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return pixels;
+}
+
+bool benchmarkFilters(std::ostream& out, const char* imagePath) {
+    int width, height;
+    unsigned int source = loadImage(imagePath, &width, &height);
+    if (source == 0)
+        return false;
+    ImageFilters filters(width, height);
+    unsigned int query;
+    glGenQueries(1, &query);
+    double megapixels = width * (double) height / 1e6;
+    bool allMatch = true;
+
+    auto time = [&](const std::function<void()>& run) {
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+            run();
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        return elapsed / 1e6 / BENCHMARK_ITERATIONS / megapixels;
+    };
+
+    out << "filter,width,height,compute_ms_per_mp,fragment_ms_per_mp,max_difference,faster\n";
+    for (int f = 0; f < FILTER_COUNT; f++) {
+        Filter_Type filter = (Filter_Type) f;
+        // each path once for its result, which also gets any lazy compilation out of the way
+        unsigned int result = filters.applyCompute(filter, source);
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        std::vector<unsigned char> computed = readTexture(result, width, height);
+        std::vector<unsigned char> rendered = readTexture(filters.applyFragment(filter, source), width, height);
+        int difference = 0;
+        for (size_t i = 0; i < computed.size(); i++)
+            difference = std::max(difference, std::abs(computed[i] - rendered[i]));
+
+        // as if whatever comes next samples the result
+        double computeMs = time([&] {
+            filters.applyCompute(filter, source);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        });
+        double fragmentMs = time([&] { filters.applyFragment(filter, source); });
+
+        out << ImageFilters::name(filter) << ',' << width << ',' << height << ',' << computeMs << ',' << fragmentMs << ','
+            << difference << ',' << (computeMs < fragmentMs ? "compute" : "fragment") << '\n';
+        allMatch = allMatch && difference <= BENCHMARK_TOLERANCE;
+    }
+
+    glDeleteQueries(1, &query);
+    glDeleteTextures(1, &source);
+    return allMatch;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+enum Filter_Type {
+    FILTER_GAUSSIAN,
+    FILTER_BOX,
+    FILTER_SOBEL,
+    FILTER_BILATERAL,
+    FILTER_GRADE,
+    FILTER_COUNT
+};
+
+struct FilterSettings {
+    int blurRadius = 6;           // Gaussian and box, up to ImageFilters::MAX_RADIUS
+    float gaussianSigma = 3.0f;
+    int bilateralRadius = 4;      // up to ImageFilters::MAX_BILATERAL_RADIUS
+    float spatialSigma = 2.5f;
+    float rangeSigma = 0.1f;
+    float exposure = 0.3f;
+    float contrast = 1.15f;
+    float saturation = 0.8f;
+    glm::vec3 lift = glm::vec3(0.02f, 0.0f, 0.04f);
+    glm::vec3 gamma = glm::vec3(1.0f, 1.0f, 1.05f);
+    glm::vec3 gain = glm::vec3(1.05f, 1.0f, 0.95f);
+};
+
+// Image filters of an RGBA8 texture, each both as compute shaders in shaders/filters/*.cs and as
+// fragment shaders in shaders/filters/*.fs, so the faster one can be picked per effect. The compute
+// versions cache a tile of the image plus the apron their neighbourhood reaches past it in shared
+// memory, the fragment versions fetch every tap from the texture.
+// The blurs are separable, a pass along the rows into a half float texture then one along the columns
+class ImageFilters {
+public:
+    static const int LINE_TILE = 256;  // pixels per workgroup of a separable pass
+    static const int TILE = 16;        // TILE x TILE pixels per workgroup of the 2D filters
+    static const int MAX_RADIUS = 8;
+    static const int MAX_BILATERAL_RADIUS = 6;
+
+    FilterSettings settings;
+
+    ImageFilters(unsigned int width, unsigned int height, const std::string& shaderDirectory = "shaders/filters/");
+    ~ImageFilters();
+
+    // filter source (width x height) into one of ImageFilters' own textures and return it. The
+    // caller puts a GL_TEXTURE_FETCH_BARRIER_BIT barrier before sampling what applyCompute returns
+    unsigned int applyCompute(Filter_Type filter, unsigned int source);
+    unsigned int applyFragment(Filter_Type filter, unsigned int source);
+    // draws a texture over the whole viewport
+    void present(unsigned int texture);
+
+    static const char* name(Filter_Type filter);
+
+private:
+    unsigned int width, height;
+    unsigned int separableProgram, sobelProgram, bilateralProgram, gradeProgram;
+    std::unique_ptr<Shader> separableShader, sobelShader, bilateralShader, gradeShader, presentShader;
+    unsigned int intermediate, computeResult, fragmentResult;  // textures
+    unsigned int intermediateFBO, fragmentFBO, VAO;
+
+    void setWeights(unsigned int program, Filter_Type filter);
+    void setUniforms(unsigned int program, Filter_Type filter);
+    void draw(Shader& shader, unsigned int source, unsigned int framebuffer);
+};
+
+// Loads an image and times every filter both ways in ms per megapixel, with the largest difference
+// between the two results (0-255). Returns false if they disagree by more than rounding
+bool benchmarkFilters(std::ostream& out, const char* imagePath);
+// Loads an image into an RGBA8 texture, 0 if it couldn't be read
+unsigned int loadImage(const char* path, int* width, int* height);
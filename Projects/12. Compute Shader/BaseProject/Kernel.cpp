@@ -0,0 +1,75 @@
+#include "Kernel.h"
+#include "Compute.h"
+
+#include <fstream>
+#include <sstream>
+#include <glm/gtc/type_ptr.hpp>
+
+const char* GpuKernel::PRELUDE =
+    "#version 430 core\n"
+    "#define KERNEL_LOCAL_SIZE(x, y, z) layout(local_size_x = x, local_size_y = y, local_size_z = z) in;\n"
+    "#define KERNEL_BUFFER(b, type, name) layout(std430, binding = b) buffer Kernel_##name { type name[]; };\n"
+    "#define KERNEL_UNIFORM(type, name) uniform type name;\n"
+    "#define KERNEL_SHARED(type, name, count) shared type name[count];\n"
+    "#define KERNEL_MAIN void main() {\n"
+    // the CPU sees every write of the other invocations after a barrier, so the GPU has to as well
+    "#define KERNEL_BARRIER groupMemoryBarrier(); barrier();\n"
+    "#define KERNEL_END }\n"
+    "#line 1\n";
+
+
+GpuKernel::GpuKernel(const std::string& path) {
+    std::string code;
+    std::ifstream file;
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        file.open(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        file.close();
+        code = stream.str();
+    }
+    catch (std::ifstream::failure& e)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << " " << e.what() << std::endl;
+    }
+    ID = compileComputeProgram(PRELUDE + code, path);
+}
+
+GpuKernel::~GpuKernel() {
+    glDeleteProgram(ID);
+}
+
+void GpuKernel::set(const std::string& name, unsigned int value) {
+    glProgramUniform1ui(ID, glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void GpuKernel::set(const std::string& name, int value) {
+    glProgramUniform1i(ID, glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void GpuKernel::set(const std::string& name, float value) {
+    glProgramUniform1f(ID, glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void GpuKernel::set(const std::string& name, glm::vec2 value) {
+    glProgramUniform2fv(ID, glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void GpuKernel::set(const std::string& name, glm::vec4 value) {
+    glProgramUniform4fv(ID, glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void GpuKernel::dispatch(glm::uvec3 groups) {
+    for (const std::pair<const unsigned int, unsigned int>& buffer : buffers)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, buffer.first, buffer.second);
+    glUseProgram(ID);
+    glDispatchCompute(groups.x, groups.y, groups.z);
+}
+
+glm::uvec3 GpuKernel::localSize() const {
+    GLint size[3];
+    glGetProgramiv(ID, GL_COMPUTE_WORK_GROUP_SIZE, size);
+    return glm::uvec3(size[0], size[1], size[2]);
+}
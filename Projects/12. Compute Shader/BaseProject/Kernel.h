@@ -0,0 +1,210 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ComputeBuffer.h"
+#include "ThreadPool.h"
+
+// Kernels written once and run either as a GLSL compute shader (GpuKernel) or on the CPU
+// (CpuKernel). A kernel is a file in shaders/kernels/ written against these macros:
+//
+//   KERNEL_LOCAL_SIZE(x, y, z)          the workgroup size
+//   KERNEL_BUFFER(binding, type, name)  a std430 storage buffer read as name[i]
+//   KERNEL_UNIFORM(type, name)
+//   KERNEL_SHARED(type, name, count)    workgroup shared memory
+//   KERNEL_MAIN { ... }                 the body, gl_GlobalInvocationID and friends are in scope
+//   KERNEL_BARRIER { ... }              barrier() between two blocks, any number of them
+//   KERNEL_END
+//
+// GpuKernel compiles the file as GLSL behind a prelude that turns the macros into the usual
+// declarations. For the CPU the file is #included into a struct deriving from KernelBase (see
+// Kernels.h), where the macros become members and the body a method, so the source has to be the
+// common subset of GLSL and C++: glm types and functions, float literals with an f, no swizzles
+// beyond .x .y .z .w and no .length().
+//
+// The CPU runs every invocation of a workgroup up to a barrier before any continues past it. For
+// that each block between barriers is run as a whole, so nothing declared in one block is seen in
+// the next (GLSL's scoping says the same), values that cross a barrier go through shared memory,
+// and barriers can't sit inside loops or behind an early return.
+
+// Buffers and uniforms of a CpuKernel dispatch, every kernel instance reads them at construction
+struct KernelBindings {
+    std::map<unsigned int, void*> buffers;
+    std::map<std::string, std::vector<char>> uniforms;
+};
+
+// What the kernel body sees on the CPU, the names match GLSL
+class KernelBase {
+public:
+    typedef unsigned int uint;
+    typedef glm::vec2 vec2;
+    typedef glm::vec3 vec3;
+    typedef glm::vec4 vec4;
+    typedef glm::ivec2 ivec2;
+    typedef glm::ivec3 ivec3;
+    typedef glm::ivec4 ivec4;
+    typedef glm::uvec2 uvec2;
+    typedef glm::uvec3 uvec3;
+    typedef glm::uvec4 uvec4;
+
+    uvec3 gl_GlobalInvocationID, gl_LocalInvocationID, gl_WorkGroupID, gl_NumWorkGroups, gl_WorkGroupSize;
+    uint gl_LocalInvocationIndex;
+    // set by KERNEL_MAIN / KERNEL_BARRIER when the block asked for exists
+    bool kernelBlockFound;
+
+    KernelBase(const KernelBindings& bindings) : bindings(bindings) {}
+
+protected:
+    template <typename T>
+    T* buffer(unsigned int binding) const {
+        auto found = bindings.buffers.find(binding);
+        if (found == bindings.buffers.end()) {
+            std::cout << "ERROR::KERNEL::BUFFER_NOT_BOUND " << binding << std::endl;
+            return nullptr;
+        }
+        return (T*) found->second;
+    }
+
+    template <typename T>
+    T uniform(const char* name) const {
+        T value = T();
+        auto found = bindings.uniforms.find(name);
+        if (found == bindings.uniforms.end() || found->second.size() != sizeof(T))
+            std::cout << "ERROR::KERNEL::UNIFORM_NOT_SET " << name << std::endl;
+        else
+            std::memcpy(&value, found->second.data(), sizeof(T));
+        return value;
+    }
+
+    // other workgroups run on other threads at the same time
+    static uint atomicAdd(uint& memory, uint value) {
+        return reinterpret_cast<std::atomic<uint>*>(&memory)->fetch_add(value);
+    }
+
+private:
+    const KernelBindings& bindings;
+};
+
+#define KERNEL_LOCAL_SIZE(x, y, z) static glm::uvec3 kernelLocalSize() { return glm::uvec3(x, y, z); }
+#define KERNEL_BUFFER(binding, type, name) type* name = buffer<type>(binding);
+#define KERNEL_UNIFORM(type, name) type name = uniform<type>(#name);
+#define KERNEL_SHARED(type, name, count) type name[count];
+#define KERNEL_MAIN \
+    void kernelMain(unsigned int block) { \
+        unsigned int nextBlock = 0; \
+        if (block == nextBlock++ && (kernelBlockFound = true))
+#define KERNEL_BARRIER if (block == nextBlock++ && (kernelBlockFound = true))
+#define KERNEL_END }
+
+
+// Runs kernel K on a thread pool. Workgroups are split between the pool's threads, each thread with
+// its own instance of K and so its own shared memory. Within a workgroup the invocations run in
+// order, one block at a time
+template <typename K>
+class CpuKernel {
+public:
+    CpuKernel(ThreadPool& pool) : pool(pool) {}
+
+    // the vector must stay alive and keep its size until dispatch returns
+    template <typename T>
+    void bind(unsigned int binding, std::vector<T>& values) {
+        bindings.buffers[binding] = values.data();
+    }
+
+    // T has to be the exact type the kernel declared
+    template <typename T>
+    void set(const std::string& name, T value) {
+        std::vector<char>& bytes = bindings.uniforms[name];
+        bytes.resize(sizeof(T));
+        std::memcpy(bytes.data(), &value, sizeof(T));
+    }
+
+    // blocks until every workgroup is done
+    void dispatch(glm::uvec3 groups) {
+        size_t total = (size_t) groups.x * groups.y * groups.z;
+        if (total == 0)
+            return;
+        // a few ranges per thread so a slow one doesn't hold everyone up
+        size_t ranges = std::min<size_t>(total, pool.size() * 4);
+        TaskGroup tasks(pool);
+        for (size_t r = 0; r < ranges; r++) {
+            size_t first = total * r / ranges, last = total * (r + 1) / ranges;
+            tasks.run([this, groups, first, last] {
+                std::unique_ptr<K> kernel(new K(bindings));
+                for (size_t group = first; group < last; group++)
+                    runGroup(*kernel, groups, group);
+            });
+        }
+        tasks.wait();
+    }
+
+private:
+    ThreadPool& pool;
+    KernelBindings bindings;
+
+    static void runGroup(K& kernel, glm::uvec3 groups, size_t group) {
+        glm::uvec3 size = K::kernelLocalSize();
+        kernel.gl_NumWorkGroups = groups;
+        kernel.gl_WorkGroupSize = size;
+        kernel.gl_WorkGroupID = glm::uvec3(group % groups.x, group / groups.x % groups.y, group / groups.x / groups.y);
+        // every invocation runs a block before any starts the next, until there's no next block
+        for (unsigned int block = 0; ; block++) {
+            kernel.kernelBlockFound = false;
+            for (unsigned int z = 0; z < size.z; z++) {
+                for (unsigned int y = 0; y < size.y; y++) {
+                    for (unsigned int x = 0; x < size.x; x++) {
+                        kernel.gl_LocalInvocationID = glm::uvec3(x, y, z);
+                        kernel.gl_LocalInvocationIndex = (z * size.y + y) * size.x + x;
+                        kernel.gl_GlobalInvocationID = kernel.gl_WorkGroupID * size + kernel.gl_LocalInvocationID;
+                        kernel.kernelMain(block);
+                    }
+                }
+            }
+            if (!kernel.kernelBlockFound)
+                return;
+        }
+    }
+};
+
+
+// Runs a kernel file as a GLSL compute shader
+class GpuKernel {
+public:
+    GpuKernel(const std::string& path);
+    ~GpuKernel();
+    GpuKernel(const GpuKernel&) = delete;
+    GpuKernel& operator=(const GpuKernel&) = delete;
+
+    // bound to its binding point on every dispatch, so other code can use the binding in between
+    template <typename T>
+    void bind(unsigned int binding, const ComputeBuffer<T>& buffer) {
+        buffers[binding] = buffer.ID;
+    }
+
+    void set(const std::string& name, unsigned int value);
+    void set(const std::string& name, int value);
+    void set(const std::string& name, float value);
+    void set(const std::string& name, glm::vec2 value);
+    void set(const std::string& name, glm::vec4 value);
+
+    // the caller puts the barrier for whatever reads the results next
+    void dispatch(glm::uvec3 groups);
+    glm::uvec3 localSize() const;
+
+    // the GLSL that goes in front of every kernel file
+    static const char* PRELUDE;
+
+private:
+    unsigned int ID;
+    std::map<unsigned int, unsigned int> buffers;
+};
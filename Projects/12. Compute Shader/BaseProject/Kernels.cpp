@@ -0,0 +1,227 @@
+#include "Kernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+// values the 1D kernels run on, not a multiple of any workgroup size
+const unsigned int VALIDATE_COUNT = (1 << 20) + 17;
+const unsigned int GRADIENT_WIDTH = 1001, GRADIENT_HEIGHT = 999;
+// float results may differ by rounding, fused multiply-adds and the like
+const float VALIDATE_TOLERANCE = 1e-5f;
+
+
+static unsigned int groupsFor(unsigned int count, unsigned int size) {
+    return (count + size - 1) / size;
+}
+
+static bool sameFloats(const float* a, const float* b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (std::abs(a[i] - b[i]) > VALIDATE_TOLERANCE * std::max(1.0f, std::abs(b[i])))
+            return false;
+    }
+    return true;
+}
+
+static double cpuMilliseconds(const std::function<void()>& run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double gpuMilliseconds(unsigned int query, const std::function<void()>& run) {
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    run();
+    // some drivers only start the work once something waits on it
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glEndQuery(GL_TIME_ELAPSED);
+    GLuint64 time;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time);
+    return time / 1e6;
+}
+
+template <typename T>
+static std::vector<T> readBuffer(ComputeBuffer<T>& buffer) {
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    buffer.readback();
+    return buffer.wait();
+}
+
+
+bool validateKernels(std::ostream& out, bool gpu) {
+    ThreadPool pool(std::thread::hardware_concurrency());
+    unsigned int query = 0;
+    if (gpu)
+        glGenQueries(1, &query);
+    bool allMatch = true;
+
+    // every kernel runs once on each backend for its results, then once more to be timed
+    out << "kernel,size,cpu_matches,gpu_matches,cpu_ms,gpu_ms\n";
+    auto report = [&](const char* name, size_t size, bool cpuMatches, bool gpuMatches, double cpuMs, double gpuMs) {
+        out << name << ',' << size << ',' << (cpuMatches ? "yes" : "no") << ',';
+        if (gpu)
+            out << (gpuMatches ? "yes" : "no") << ',' << cpuMs << ',' << gpuMs << '\n';
+        else
+            out << "-," << cpuMs << ",-\n";
+        allMatch = allMatch && cpuMatches && (!gpu || gpuMatches);
+    };
+
+    // xorshift inputs
+    const unsigned int count = VALIDATE_COUNT;
+    std::vector<float> x(count), y(count);
+    std::vector<uint32_t> values(count);
+    uint32_t state = 2463534242u;
+    for (unsigned int i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        values[i] = state;
+        x[i] = (state >> 8) / 16777216.0f;
+        y[i] = (state & 0xFFFF) / 65536.0f - 0.5f;
+    }
+
+    {
+        const float a = 2.5f;
+        std::vector<float> expected(count);
+        for (unsigned int i = 0; i < count; i++)
+            expected[i] = a * x[i] + y[i];
+        glm::uvec3 groups(groupsFor(count, 256), 1, 1);
+
+        std::vector<float> cpuY = y;
+        CpuKernel<kernels::Saxpy> cpu(pool);
+        cpu.bind(0, x);
+        cpu.bind(1, cpuY);
+        cpu.set("a", a);
+        cpu.set("count", count);
+        cpu.dispatch(groups);
+        bool cpuMatches = sameFloats(cpuY.data(), expected.data(), count);
+        double cpuMs = cpuMilliseconds([&] { cpu.dispatch(groups); });
+
+        bool gpuMatches = false;
+        double gpuMs = 0.0;
+        if (gpu) {
+            ComputeBuffer<float> gpuX(x), gpuY(y);
+            GpuKernel kernel("shaders/kernels/saxpy.kernel");
+            kernel.bind(0, gpuX);
+            kernel.bind(1, gpuY);
+            kernel.set("a", a);
+            kernel.set("count", count);
+            kernel.dispatch(groups);
+            gpuMatches = sameFloats(readBuffer(gpuY).data(), expected.data(), count);
+            gpuMs = gpuMilliseconds(query, [&] { kernel.dispatch(groups); });
+        }
+        report("saxpy", count, cpuMatches, gpuMatches, cpuMs, gpuMs);
+    }
+
+    {
+        const int radius = 4;
+        std::vector<float> expected(count);
+        for (int i = 0; i < (int) count; i++) {
+            float sum = 0.0f;
+            for (int k = -radius; k <= radius; k++)
+                sum += x[std::min(std::max(i + k, 0), (int) count - 1)];
+            expected[i] = sum / float(2 * radius + 1);
+        }
+        glm::uvec3 groups(groupsFor(count, 256), 1, 1);
+
+        std::vector<float> cpuResult(count);
+        CpuKernel<kernels::BoxBlur> cpu(pool);
+        cpu.bind(0, x);
+        cpu.bind(1, cpuResult);
+        cpu.set("count", count);
+        cpu.dispatch(groups);
+        bool cpuMatches = sameFloats(cpuResult.data(), expected.data(), count);
+        double cpuMs = cpuMilliseconds([&] { cpu.dispatch(groups); });
+
+        bool gpuMatches = false;
+        double gpuMs = 0.0;
+        if (gpu) {
+            ComputeBuffer<float> source(x), result(count);
+            GpuKernel kernel("shaders/kernels/box_blur.kernel");
+            kernel.bind(0, source);
+            kernel.bind(1, result);
+            kernel.set("count", count);
+            kernel.dispatch(groups);
+            gpuMatches = sameFloats(readBuffer(result).data(), expected.data(), count);
+            gpuMs = gpuMilliseconds(query, [&] { kernel.dispatch(groups); });
+        }
+        report("box_blur", count, cpuMatches, gpuMatches, cpuMs, gpuMs);
+    }
+
+    {
+        const unsigned int tile = 256;
+        unsigned int blocks = groupsFor(count, tile);
+        std::vector<uint32_t> expected(blocks, 0);
+        uint32_t expectedTotal = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            expected[i / tile] += values[i];
+            expectedTotal += values[i];
+        }
+        glm::uvec3 groups(blocks, 1, 1);
+
+        std::vector<uint32_t> cpuSums(blocks), cpuTotal(1, 0);
+        CpuKernel<kernels::BlockSum> cpu(pool);
+        cpu.bind(0, values);
+        cpu.bind(1, cpuSums);
+        cpu.bind(2, cpuTotal);
+        cpu.set("count", count);
+        cpu.dispatch(groups);
+        bool cpuMatches = cpuSums == expected && cpuTotal[0] == expectedTotal;
+        double cpuMs = cpuMilliseconds([&] { cpu.dispatch(groups); });
+
+        bool gpuMatches = false;
+        double gpuMs = 0.0;
+        if (gpu) {
+            ComputeBuffer<uint32_t> source(values), sums(blocks), total(cpuTotal.size());
+            uint32_t zero = 0;
+            total.update(0, &zero, 1);
+            GpuKernel kernel("shaders/kernels/block_sum.kernel");
+            kernel.bind(0, source);
+            kernel.bind(1, sums);
+            kernel.bind(2, total);
+            kernel.set("count", count);
+            kernel.dispatch(groups);
+            gpuMatches = readBuffer(sums) == expected && readBuffer(total)[0] == expectedTotal;
+            gpuMs = gpuMilliseconds(query, [&] { kernel.dispatch(groups); });
+        }
+        report("block_sum", count, cpuMatches, gpuMatches, cpuMs, gpuMs);
+    }
+
+    {
+        const unsigned int width = GRADIENT_WIDTH, height = GRADIENT_HEIGHT;
+        std::vector<glm::vec4> expected(width * height);
+        for (unsigned int row = 0; row < height; row++) {
+            for (unsigned int column = 0; column < width; column++)
+                expected[row * width + column] = glm::vec4(float(column) / float(width), float(row) / float(height), 0.0f, 1.0f);
+        }
+        glm::uvec3 groups(groupsFor(width, 8), groupsFor(height, 8), 1);
+
+        std::vector<glm::vec4> cpuPixels(width * height);
+        CpuKernel<kernels::Gradient> cpu(pool);
+        cpu.bind(0, cpuPixels);
+        cpu.set("width", width);
+        cpu.set("height", height);
+        cpu.dispatch(groups);
+        bool cpuMatches = sameFloats(&cpuPixels[0].x, &expected[0].x, expected.size() * 4);
+        double cpuMs = cpuMilliseconds([&] { cpu.dispatch(groups); });
+
+        bool gpuMatches = false;
+        double gpuMs = 0.0;
+        if (gpu) {
+            ComputeBuffer<glm::vec4> pixels(width * height);
+            GpuKernel kernel("shaders/kernels/gradient.kernel");
+            kernel.bind(0, pixels);
+            kernel.set("width", width);
+            kernel.set("height", height);
+            kernel.dispatch(groups);
+            gpuMatches = sameFloats(&readBuffer(pixels)[0].x, &expected[0].x, expected.size() * 4);
+            gpuMs = gpuMilliseconds(query, [&] { kernel.dispatch(groups); });
+        }
+        report("gradient", (size_t) width * height, cpuMatches, gpuMatches, cpuMs, gpuMs);
+    }
+
+    if (gpu)
+        glDeleteQueries(1, &query);
+    return allMatch;
+}
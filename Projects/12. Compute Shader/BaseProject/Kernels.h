@@ -0,0 +1,35 @@
+#pragma once
+#include <ostream>
+
+#include "Kernel.h"
+
+// The CPU side of every kernel in shaders/kernels/, for CpuKernel<kernels::Name>. The GPU side is
+// GpuKernel("shaders/kernels/name.kernel")
+namespace kernels {
+    using namespace glm;
+
+    struct Saxpy : KernelBase {
+        using KernelBase::KernelBase;
+#include "shaders/kernels/saxpy.kernel"
+    };
+
+    struct BoxBlur : KernelBase {
+        using KernelBase::KernelBase;
+#include "shaders/kernels/box_blur.kernel"
+    };
+
+    struct BlockSum : KernelBase {
+        using KernelBase::KernelBase;
+#include "shaders/kernels/block_sum.kernel"
+    };
+
+    struct Gradient : KernelBase {
+        using KernelBase::KernelBase;
+#include "shaders/kernels/gradient.kernel"
+    };
+}
+
+// Runs every kernel on the CPU backend and compares it with a plain C++ loop, and when gpu is set
+// runs it as GLSL too and compares that the same way. One row per kernel with the time each backend
+// took. Returns false if anything didn't match
+bool validateKernels(std::ostream& out, bool gpu);
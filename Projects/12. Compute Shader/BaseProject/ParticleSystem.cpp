@@ -0,0 +1,113 @@
+#include "ParticleSystem.h"
+#include "Compute.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+// largest distance between a GPU and a CPU body checkParticles accepts, relative to the galaxy's size
+const float CHECK_TOLERANCE = 1e-3f;
+
+
+ParticleSystem::ParticleSystem(const std::vector<glm::vec4>& positions, const std::vector<glm::vec4>& velocities,
+                               const std::string& shaderDirectory)
+    : count(positions.size()),
+      drawShader((shaderDirectory + "particle.vs").c_str(), (shaderDirectory + "particle.fs").c_str()) {
+    std::stringstream defines;
+    defines << "#define WORKGROUP_SIZE " << WORKGROUP_SIZE << "\n";
+    nbodyProgram = loadComputeProgram(shaderDirectory + "nbody.cs", defines.str());
+
+    buffers[0].reset(new ComputeBuffer<glm::vec4>(positions));
+    buffers[1].reset(new ComputeBuffer<glm::vec4>(count));
+    velocityBuffer.reset(new ComputeBuffer<glm::vec4>(velocities));
+
+    // core profile draws need a VAO bound even when the vertex shader has no attributes
+    glGenVertexArrays(1, &VAO);
+}
+
+ParticleSystem::~ParticleSystem() {
+    glDeleteProgram(nbodyProgram);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void ParticleSystem::step(const ParticleSettings& settings) {
+    if (count == 0)
+        return;
+    glUseProgram(nbodyProgram);
+    glProgramUniform1ui(nbodyProgram, glGetUniformLocation(nbodyProgram, "count"), (GLuint) count);
+    glProgramUniform1f(nbodyProgram, glGetUniformLocation(nbodyProgram, "dt"), settings.dt);
+    glProgramUniform1f(nbodyProgram, glGetUniformLocation(nbodyProgram, "gravity"), settings.gravity);
+    glProgramUniform1f(nbodyProgram, glGetUniformLocation(nbodyProgram, "softening2"), settings.softening * settings.softening);
+    positions().bind(0);
+    nextPositions().bind(1);
+    velocities().bind(2);
+    glDispatchCompute((GLuint) ((count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+    current = 1 - current;
+}
+
+void ParticleSystem::draw(const glm::mat4& viewProjection, float size) {
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    drawShader.use();
+    drawShader.setMat4("viewProjection", viewProjection);
+    drawShader.setFloat("size", size);
+    positions().bind(0);
+    glBindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei) count);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
+
+
+bool checkParticles(std::ostream& out, size_t count, int steps) {
+    ParticleSettings settings;
+    std::vector<glm::vec4> positions, velocities;
+    makeGalaxy(count, 0, positions, velocities);
+
+    // one untimed step each first, drivers often compile the kernel on its first dispatch
+    ParticleSystem gpu(positions, velocities);
+    gpu.step(settings);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    unsigned int query;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (int i = 0; i < steps; i++) {
+        gpu.step(settings);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    GLuint64 time;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time);
+    glDeleteQueries(1, &query);
+    double gpuSeconds = time / 1e9;
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    gpu.positions().readback();
+    std::vector<glm::vec4> gpuPositions = gpu.positions().wait();
+
+    CpuParticles cpu(positions, velocities);
+    cpu.step(settings);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++)
+        cpu.step(settings);
+    double cpuSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::vector<glm::vec4> cpuPositions = cpu.positions();
+
+    // the two sum the forces in a different order, so they only agree up to rounding
+    float extent = 0.0f, largest = 0.0f, total = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float distance = glm::length(glm::vec3(gpuPositions[i]) - glm::vec3(cpuPositions[i]));
+        extent = std::max(extent, glm::length(glm::vec3(cpuPositions[i])));
+        largest = std::max(largest, distance);
+        total += distance;
+    }
+    bool matches = largest <= CHECK_TOLERANCE * std::max(extent, 1.0f);
+
+    double pairs = (double) count * count * steps;
+    out << count << " bodies, " << steps + 1 << " steps (" << steps << " timed), " << cpu.threadCount() << " CPU threads\n";
+    out << "  GPU: " << gpuSeconds * 1000.0 << " ms, " << pairs / gpuSeconds / 1e6 << " M pairs/s\n";
+    out << "  CPU: " << cpuSeconds * 1000.0 << " ms, " << pairs / cpuSeconds / 1e6 << " M pairs/s\n";
+    out << "  difference: largest " << largest << ", mean " << (count > 0 ? total / count : 0.0f) << " in a galaxy of radius "
+        << extent << ", " << (matches ? "matches" : "DOESN'T MATCH") << "\n";
+    return matches;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shaders/shader.h>
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ComputeBuffer.h"
+#include "CpuParticles.h"
+
+// N-body gravity that stays on the GPU. Positions (mass in w) and velocities live in storage
+// buffers, step() integrates them with one dispatch of shaders/particles/nbody.cs and draw()
+// renders one instanced quad per body straight from the position buffer, nothing is read back.
+// The positions ping-pong between two buffers since every body reads every other body's old position
+class ParticleSystem {
+public:
+    // bodies the kernel loads into shared memory per tile, one per invocation
+    static const unsigned int WORKGROUP_SIZE = 256;
+
+    ParticleSystem(const std::vector<glm::vec4>& positions, const std::vector<glm::vec4>& velocities,
+                   const std::string& shaderDirectory = "shaders/particles/");
+    ~ParticleSystem();
+
+    void step(const ParticleSettings& settings);
+    // additive blended quads of size (in clip space at distance 1) around each body
+    void draw(const glm::mat4& viewProjection, float size);
+
+    size_t size() const { return count; }
+    // the buffer the last step wrote, and the one the next step writes
+    ComputeBuffer<glm::vec4>& positions() { return *buffers[current]; }
+    ComputeBuffer<glm::vec4>& nextPositions() { return *buffers[1 - current]; }
+    ComputeBuffer<glm::vec4>& velocities() { return *velocityBuffer; }
+
+private:
+    size_t count;
+    unsigned int current = 0;
+    unsigned int nbodyProgram, VAO;
+    Shader drawShader;
+    std::unique_ptr<ComputeBuffer<glm::vec4>> buffers[2];
+    std::unique_ptr<ComputeBuffer<glm::vec4>> velocityBuffer;
+};
+
+// Runs the same galaxy on the GPU and on the CPU for a number of steps, prints how far apart the
+// bodies ended up and the throughput of both in body pairs per second. Returns false if they drifted
+// further apart than float rounding explains
+bool checkParticles(std::ostream& out, size_t count, int steps);
@@ -0,0 +1,185 @@
+#include "PassGraph.h"
+
+#include <algorithm>
+
+// every bit the graph can issue, in the order they're reported
+const struct {
+    GLbitfield bit;
+    const char* name;
+} BARRIER_BITS[] = {
+    { GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, "SHADER_IMAGE_ACCESS" },
+    { GL_SHADER_STORAGE_BARRIER_BIT,      "SHADER_STORAGE" },
+    { GL_ATOMIC_COUNTER_BARRIER_BIT,      "ATOMIC_COUNTER" },
+    { GL_TEXTURE_FETCH_BARRIER_BIT,       "TEXTURE_FETCH" },
+    { GL_UNIFORM_BARRIER_BIT,             "UNIFORM" },
+    { GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT, "VERTEX_ATTRIB_ARRAY" },
+    { GL_ELEMENT_ARRAY_BARRIER_BIT,       "ELEMENT_ARRAY" },
+    { GL_COMMAND_BARRIER_BIT,             "COMMAND" },
+    { GL_BUFFER_UPDATE_BARRIER_BIT,       "BUFFER_UPDATE" },
+    { GL_TEXTURE_UPDATE_BARRIER_BIT,      "TEXTURE_UPDATE" },
+    { GL_FRAMEBUFFER_BARRIER_BIT,         "FRAMEBUFFER" },
+};
+const size_t BARRIER_BIT_COUNT = sizeof(BARRIER_BITS) / sizeof(BARRIER_BITS[0]);
+
+
+// writes GL doesn't order with later commands by itself
+static bool isIncoherent(Access_Type access) {
+    return access == ACCESS_IMAGE || access == ACCESS_STORAGE || access == ACCESS_ATOMIC_COUNTER;
+}
+
+size_t PassGraph::addPass(const std::string& name, std::function<void()> run) {
+    return addLazyPass(name, [run] {
+        run();
+        return true;
+    });
+}
+
+size_t PassGraph::addLazyPass(const std::string& name, std::function<bool()> run) {
+    passes.push_back({ name, run, {}, {}, {}, false });
+    compiled = false;
+    return passes.size() - 1;
+}
+
+void PassGraph::reads(size_t pass, PassResource resource, Access_Type access) {
+    passes[pass].accesses.push_back({ resource, access, false });
+    compiled = false;
+}
+
+void PassGraph::writes(size_t pass, PassResource resource, Access_Type access) {
+    passes[pass].accesses.push_back({ resource, access, true });
+    compiled = false;
+}
+
+bool PassGraph::dependsOn(const Pass& earlier, const Pass& later, GLbitfield* bits) {
+    bool dependent = false;
+    *bits = 0;
+    for (const Access& before : earlier.accesses) {
+        for (const Access& after : later.accesses) {
+            if (!(before.resource == after.resource) || !(before.write || after.write))
+                continue;
+            dependent = true;
+            // incoherent write then anything, or an incoherent read overwritten incoherently
+            if ((before.write && isIncoherent(before.type)) || (isIncoherent(before.type) && isIncoherent(after.type)))
+                *bits |= barrierBit(after.type);
+        }
+    }
+    return dependent;
+}
+
+void PassGraph::compile() {
+    // level of each pass: past the level of everything it depends on, one further if that
+    // dependency needs a barrier
+    std::vector<size_t> level(passes.size(), 0);
+    for (size_t p = 0; p < passes.size(); p++) {
+        passes[p].waits.clear();
+        passes[p].carried.clear();
+        for (size_t q = 0; q < passes.size(); q++) {
+            GLbitfield bits = 0;
+            if (!dependsOn(passes[q], passes[p], &bits))
+                continue;
+            // q at or after p ran before p in the previous execute(), it only needs the barrier
+            if (q >= p) {
+                if (bits != 0)
+                    passes[p].carried.push_back({ q, bits });
+                continue;
+            }
+            level[p] = std::max(level[p], level[q] + (bits != 0 ? 1 : 0));
+            if (bits != 0)
+                passes[p].waits.push_back({ q, bits });
+        }
+    }
+
+    levels.clear();
+    for (size_t p = 0; p < passes.size(); p++) {
+        if (level[p] >= levels.size())
+            levels.resize(level[p] + 1);
+        levels[level[p]].passes.push_back(p);
+        // the barrier in front of the pass's level covers dependencies from any earlier level, and
+        // from the previous execute()
+        for (const Dependency& wait : passes[p].waits)
+            levels[level[p]].barrier |= wait.bits;
+        for (const Dependency& wait : passes[p].carried)
+            levels[level[p]].barrier |= wait.bits;
+    }
+    totals.bitCounts.resize(BARRIER_BIT_COUNT, 0);
+    compiled = true;
+}
+
+void PassGraph::execute() {
+    if (!compiled)
+        compile();
+
+    for (const Level& stage : levels) {
+        // only the bits of the writers that actually ran this time. The carried writers haven't run
+        // yet this time, so their ran is still from the previous execute()
+        GLbitfield barrier = 0;
+        for (size_t p : stage.passes) {
+            for (const Dependency& wait : passes[p].waits) {
+                if (passes[wait.pass].ran)
+                    barrier |= wait.bits;
+            }
+            for (const Dependency& wait : passes[p].carried) {
+                if (passes[wait.pass].ran)
+                    barrier |= wait.bits;
+            }
+        }
+        if (barrier != 0) {
+            glMemoryBarrier(barrier);
+            totals.barriers++;
+            for (size_t i = 0; i < BARRIER_BIT_COUNT; i++) {
+                if (barrier & BARRIER_BITS[i].bit)
+                    totals.bitCounts[i]++;
+            }
+        }
+        else if (stage.barrier != 0)
+            totals.barriersSkipped++;
+        for (size_t p : stage.passes)
+            passes[p].ran = passes[p].run();
+    }
+    totals.executions++;
+    totals.passes += passes.size();
+    totals.naiveBarriers += passes.size();
+}
+
+void PassGraph::report(std::ostream& out) const {
+    out << "pass graph: " << totals.executions << " executions of " << passes.size() << " passes, " << totals.barriers
+        << " barriers issued (" << totals.barriersSkipped << " skipped with their writers) instead of " << totals.naiveBarriers
+        << " GL_ALL_BARRIER_BITS barriers\n";
+    for (size_t i = 0; i < totals.bitCounts.size(); i++) {
+        if (totals.bitCounts[i] > 0)
+            out << "  " << BARRIER_BITS[i].name << ": " << totals.bitCounts[i] << "\n";
+    }
+    out << "schedule:\n";
+    for (const Level& stage : levels) {
+        if (stage.barrier != 0)
+            out << "  barrier " << barrierNames(stage.barrier) << "\n";
+        for (size_t p : stage.passes)
+            out << "  " << passes[p].name << "\n";
+    }
+}
+
+GLbitfield PassGraph::barrierBit(Access_Type access) {
+    switch (access) {
+    case ACCESS_IMAGE:          return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    case ACCESS_STORAGE:        return GL_SHADER_STORAGE_BARRIER_BIT;
+    case ACCESS_ATOMIC_COUNTER: return GL_ATOMIC_COUNTER_BARRIER_BIT;
+    case ACCESS_TEXTURE:        return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case ACCESS_UNIFORM:        return GL_UNIFORM_BARRIER_BIT;
+    case ACCESS_VERTEX:         return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+    case ACCESS_INDEX:          return GL_ELEMENT_ARRAY_BARRIER_BIT;
+    case ACCESS_INDIRECT:       return GL_COMMAND_BARRIER_BIT;
+    case ACCESS_BUFFER_UPDATE:  return GL_BUFFER_UPDATE_BARRIER_BIT;
+    case ACCESS_TEXTURE_UPDATE: return GL_TEXTURE_UPDATE_BARRIER_BIT;
+    case ACCESS_FRAMEBUFFER:    return GL_FRAMEBUFFER_BARRIER_BIT;
+    }
+    return GL_ALL_BARRIER_BITS;
+}
+
+std::string PassGraph::barrierNames(GLbitfield bits) {
+    std::string names;
+    for (size_t i = 0; i < BARRIER_BIT_COUNT; i++) {
+        if (bits & BARRIER_BITS[i].bit)
+            names += (names.empty() ? "" : " | ") + std::string(BARRIER_BITS[i].name);
+    }
+    return names;
+}
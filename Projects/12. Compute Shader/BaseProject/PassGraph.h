@@ -0,0 +1,109 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+// How a pass touches a resource. Shader image, storage buffer and atomic counter writes are
+// incoherent: whatever reads or overwrites them next needs a glMemoryBarrier with the bit of that
+// *next* access. Every other write (draws into a framebuffer, glBufferSubData, ...) is ordered
+// with later commands by GL itself.
+enum Access_Type {
+    ACCESS_IMAGE,           // imageLoad / imageStore
+    ACCESS_STORAGE,         // shader storage buffer
+    ACCESS_ATOMIC_COUNTER,
+    ACCESS_TEXTURE,         // sampled through a sampler
+    ACCESS_UNIFORM,         // uniform buffer
+    ACCESS_VERTEX,          // vertex attributes
+    ACCESS_INDEX,           // element array
+    ACCESS_INDIRECT,        // draw / dispatch indirect arguments
+    ACCESS_BUFFER_UPDATE,   // glBufferSubData, glCopyBufferSubData, ComputeBuffer::readback
+    ACCESS_TEXTURE_UPDATE,  // glTexSubImage, glGetTexImage
+    ACCESS_FRAMEBUFFER      // rendered to or blitted from
+};
+
+// A texture or a buffer, GL names of the two kinds can collide
+struct PassResource {
+    bool isBuffer;
+    unsigned int id;
+
+    static PassResource texture(unsigned int id) { return { false, id }; }
+    static PassResource buffer(unsigned int id) { return { true, id }; }
+    bool operator==(const PassResource& other) const { return isBuffer == other.isBuffer && id == other.id; }
+};
+
+struct PassGraphStats {
+    uint64_t executions = 0;
+    uint64_t passes = 0;
+    uint64_t barriers = 0;           // glMemoryBarrier calls issued
+    uint64_t barriersSkipped = 0;    // not needed because the passes they waited on skipped their work
+    uint64_t naiveBarriers = 0;      // GL_ALL_BARRIER_BITS after every pass, as ComputeShader::wait does
+    std::vector<uint64_t> bitCounts; // barriers that carried each of BARRIER_BITS
+};
+
+// Compute and draw passes that declare what they read and write. compile() works out which
+// pairs of passes actually depend on each other and the barrier bits each dependency needs, then
+// groups the passes into levels: a pass only moves past a barrier if something it depends on
+// needs one, so independent passes share a single barrier and every barrier carries only the bits
+// its consumers need. Writes carry over from one execute() to the next, so a pass reading what a
+// later pass wrote last time gets its barrier too. GL work outside the graph isn't tracked and
+// needs its own.
+class PassGraph {
+public:
+    // passes run in the order they're added unless they're independent
+    size_t addPass(const std::string& name, std::function<void()> run);
+    // a pass that may skip its work (ComputeShader::update), run returns false when it did.
+    // Barriers that only wait on skipped passes aren't issued
+    size_t addLazyPass(const std::string& name, std::function<bool()> run);
+    void reads(size_t pass, PassResource resource, Access_Type access);
+    void writes(size_t pass, PassResource resource, Access_Type access);
+
+    // works out the schedule, called by execute() whenever passes or accesses changed
+    void compile();
+    // runs every pass with the minimal barriers between them
+    void execute();
+
+    const PassGraphStats& stats() const { return totals; }
+    // barriers and bits issued against the naive approach, plus the schedule
+    void report(std::ostream& out) const;
+
+    static GLbitfield barrierBit(Access_Type access);
+    static std::string barrierNames(GLbitfield bits);
+
+private:
+    struct Access {
+        PassResource resource;
+        Access_Type type;
+        bool write;
+    };
+    struct Dependency {
+        size_t pass;
+        GLbitfield bits;
+    };
+    struct Pass {
+        std::string name;
+        std::function<bool()> run;
+        std::vector<Access> accesses;
+        std::vector<Dependency> waits;    // earlier passes whose writes need a barrier first
+        std::vector<Dependency> carried;  // this and later passes, whose writes in the previous execute() do
+        bool ran;                         // in the last execute() it was run in
+    };
+    // one barrier (possibly none) followed by passes that don't depend on each other's incoherent writes
+    struct Level {
+        GLbitfield barrier = 0;
+        std::vector<size_t> passes;
+    };
+
+    std::vector<Pass> passes;
+    std::vector<Level> levels;
+    bool compiled = false;
+    PassGraphStats totals;
+
+    // whether later has to run after earlier, and the barrier bits it needs then
+    static bool dependsOn(const Pass& earlier, const Pass& later, GLbitfield* bits);
+};
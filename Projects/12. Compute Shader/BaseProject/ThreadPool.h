@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class TaskGroup;
+
+// A work-stealing pool. Every worker owns a deque: it pushes and pops its own work at the back
+// and idle workers steal from the front of everyone else's. A pool of N threads starts N - 1
+// workers; the thread that waits on a TaskGroup is the N-th and runs tasks while it waits.
+// Threads outside the pool all share queue 0, so while waiting they only run tasks of the group
+// they wait on and never get stuck inside another outside thread's work.
+class ThreadPool {
+public:
+    ThreadPool(unsigned int threads);
+    ~ThreadPool();
+
+    unsigned int size() const;
+    void submit(std::function<void()> task, const TaskGroup* group = nullptr);
+    // runs one queued task on the calling thread, a pool thread any task and an outside thread only
+    // one of group's. Returns false if there was nothing it could run
+    bool runPending(const TaskGroup* group = nullptr);
+
+    // index of the pool thread running the caller, 0 for threads outside any pool
+    static unsigned int currentWorker();
+
+private:
+    struct Task {
+        std::function<void()> run;
+        const TaskGroup* group;
+    };
+
+    struct TaskQueue {
+        std::deque<Task> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<int> pending;
+    bool stopping = false;
+
+    unsigned int queueIndex() const;
+    // the group to take tasks of, nullptr for any
+    bool popTask(unsigned int index, const TaskGroup* group, Task& task);
+    void workerLoop(unsigned int index);
+};
+
+
+// Fork/join helper: run() queues work on the pool, wait() helps out until all of it is done
+class TaskGroup {
+public:
+    TaskGroup(ThreadPool& pool);
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> outstanding;
+};
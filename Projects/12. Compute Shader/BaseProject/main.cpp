@@ -8,8 +8,16 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 #include "Compute.h"
+#include "PassGraph.h"
+#include "GpuPrimitives.h"
+#include "ParticleSystem.h"
+#include "Kernels.h"
+#include "ImageFilters.h"
 
 // Handles Window size changes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -17,15 +25,38 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 // Handles user input
 void handleInput(GLFWwindow* window);
 
+// Render loop of the default mode, the compute shader's gradient on a quad
+int runGradient(GLFWwindow* window);
+
+// Render loop of `BaseProject --particles`
+int runParticles(GLFWwindow* window, size_t count);
+
+// Render loop of `BaseProject --filters-view`
+int runFilters(GLFWwindow* window, const char* imagePath);
+
 
 const unsigned int WIDTH  = 1000;
 const unsigned int HEIGHT = 1000;
 
-int main() {
+// bodies and steps of the particle modes when no count is given
+const size_t PARTICLE_COUNT = 16384;
+const int PARTICLE_CHECK_STEPS = 10;
+
+int main(int argc, char** argv) {
+    size_t particleCount = argc > 2 ? (size_t) std::strtoull(argv[2], nullptr, 10) : PARTICLE_COUNT;
+    // `BaseProject --particles-cpu [count]` times the CPU integrator alone, no GPU needed
+    if (argc > 1 && strcmp(argv[1], "--particles-cpu") == 0) {
+        benchmarkCpuParticles(std::cout, particleCount, PARTICLE_CHECK_STEPS);
+        return 0;
+    }
+    // `BaseProject --kernels-cpu` checks the CPU backend of the kernels against plain C++, no GPU needed
+    if (argc > 1 && strcmp(argv[1], "--kernels-cpu") == 0)
+        return validateKernels(std::cout, false) ? 0 : -1;
+
     // GLFW WINDOW HINTS
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);  // supported version for GLSLv4.3
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);  // GLSLv4.3 compute shaders, 4.4 immutable buffer storage
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     // GLFW WINDOW CREATION
@@ -44,7 +75,62 @@ int main() {
     }
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
+    // `BaseProject --primitives` checks the GPU primitives against their references and times them
+    if (argc > 1 && strcmp(argv[1], "--primitives") == 0) {
+        bool matches = checkGpuPrimitives(std::cout);
+        if (!matches)
+            std::cout << "ERROR a GPU primitive didn't match its reference\n";
+        glfwTerminate();
+        return matches ? 0 : -1;
+    }
+
+    // `BaseProject --kernels` runs every kernel on both backends and compares them
+    if (argc > 1 && strcmp(argv[1], "--kernels") == 0) {
+        bool matches = validateKernels(std::cout, true);
+        if (!matches)
+            std::cout << "ERROR a kernel's backends didn't agree\n";
+        glfwTerminate();
+        return matches ? 0 : -1;
+    }
+
+    // `BaseProject --filters [image]` times every image filter as compute and as fragment shaders
+    if (argc > 1 && strcmp(argv[1], "--filters") == 0) {
+        bool matches = benchmarkFilters(std::cout, argc > 2 ? argv[2] : "gigachad.jpg");
+        if (!matches)
+            std::cout << "ERROR a filter's compute and fragment versions didn't agree\n";
+        glfwTerminate();
+        return matches ? 0 : -1;
+    }
+
+    // `BaseProject --filters-view [image]` shows the filters, 0-5 pick one and F switches compute / fragment
+    if (argc > 1 && strcmp(argv[1], "--filters-view") == 0) {
+        int result = runFilters(window, argc > 2 ? argv[2] : "gigachad.jpg");
+        glfwTerminate();
+        return result;
+    }
+
+    // `BaseProject --particles-check [count]` runs the same bodies on the GPU and the CPU and compares them
+    if (argc > 1 && strcmp(argv[1], "--particles-check") == 0) {
+        bool matches = checkParticles(std::cout, particleCount, PARTICLE_CHECK_STEPS);
+        glfwTerminate();
+        return matches ? 0 : -1;
+    }
+
+    // `BaseProject --particles [count]` simulates and draws a galaxy instead of the gradient
+    if (argc > 1 && strcmp(argv[1], "--particles") == 0) {
+        int result = runParticles(window, particleCount);
+        glfwTerminate();
+        return result;
+    }
+
+    // everything GL is made and deleted in there, while the context is still around
+    int result = runGradient(window);
+    glfwTerminate();
+    return result;
+}
+
 
+int runGradient(GLFWwindow* window) {
     // COMPILE AND CREATE SHADERS
     Shader textureShader = Shader("shaders/position.vs", "shaders/texture.fs");
 
@@ -90,18 +176,20 @@ int main() {
 
     // Credit: https://learnopengl.com/Guest-Articles/2022/Compute-Shaders/Introduction
     ComputeShader compute_shader("shaders/compute.cs", 10, 10, GL_TEXTURE0);
-
-    // RENDER LOOP
-    while (!glfwWindowShouldClose(window)) {
-        
+    // picks the fastest workgroup size once per device, later runs read it from workgroups.cache
+    compute_shader.autotune();
+
+    // Each frame: compute the texture, then sample it onto the quad. The graph only puts a
+    // texture fetch barrier between the two instead of flushing everything after the dispatch
+    PassGraph frame;
+    // the gradient has no inputs that change, so it's computed once and skipped from then on
+    size_t gradientPass = frame.addLazyPass("gradient", [&] {
         // Computing texture using cs
-        compute_shader.use();
-        compute_shader.dispatch();
-        compute_shader.wait();
-
-        // Key Input
-        handleInput(window);
+        return compute_shader.update();
+    });
+    frame.writes(gradientPass, PassResource::texture(compute_shader.texture), ACCESS_IMAGE);
 
+    size_t quadPass = frame.addPass("quad", [&] {
         // Rendering
         glClearColor(0.1f, 0.3f, 0.6f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -113,16 +201,130 @@ int main() {
         // Draw triangle
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
+    });
+    frame.reads(quadPass, PassResource::texture(compute_shader.texture), ACCESS_TEXTURE);
+    frame.writes(quadPass, PassResource::texture(0), ACCESS_FRAMEBUFFER);  // 0 stands in for the default framebuffer
+
+    // RENDER LOOP
+    while (!glfwWindowShouldClose(window)) {
+
+        // Key Input
+        handleInput(window);
+
+        frame.execute();
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    glfwTerminate();
+    frame.report(std::cout);
+    std::cout << "gradient: " << compute_shader.dispatchesRun << " dispatches, " << compute_shader.dispatchesSkipped << " skipped\n";
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
     return 0;
 }
 
 
+int runParticles(GLFWwindow* window, size_t count) {
+    std::vector<glm::vec4> positions, velocities;
+    makeGalaxy(count, 0, positions, velocities);
+    ParticleSystem particles(positions, velocities);
+    ParticleSettings settings;
+
+    // Each frame: one step, then the draw reads the positions the step wrote. Both position
+    // buffers are declared since they swap roles every step
+    PassGraph frame;
+    size_t stepPass = frame.addPass("nbody", [&] {
+        particles.step(settings);
+    });
+    size_t drawPass = frame.addPass("particles", [&] {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        float time = (float) glfwGetTime();
+        glm::mat4 projection = glm::perspective(45.0f, (float) width / std::max(height, 1), 0.1f, 100.0f);
+        // orbits slowly around the galaxy, a little above its plane
+        glm::mat4 view = glm::lookAt(glm::vec3(3.0f * std::sin(time * 0.1f), 1.2f, 3.0f * std::cos(time * 0.1f)), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glClearColor(0.0f, 0.0f, 0.02f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        particles.draw(projection * view, 0.01f);
+    });
+    for (ComputeBuffer<glm::vec4>* buffer : { &particles.positions(), &particles.nextPositions() }) {
+        frame.reads(stepPass, PassResource::buffer(buffer->ID), ACCESS_STORAGE);
+        frame.writes(stepPass, PassResource::buffer(buffer->ID), ACCESS_STORAGE);
+        frame.reads(drawPass, PassResource::buffer(buffer->ID), ACCESS_STORAGE);
+    }
+    frame.reads(stepPass, PassResource::buffer(particles.velocities().ID), ACCESS_STORAGE);
+    frame.writes(stepPass, PassResource::buffer(particles.velocities().ID), ACCESS_STORAGE);
+    frame.writes(drawPass, PassResource::texture(0), ACCESS_FRAMEBUFFER);
+
+    // RENDER LOOP
+    while (!glfwWindowShouldClose(window)) {
+
+        // Key Input
+        handleInput(window);
+
+        frame.execute();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    frame.report(std::cout);
+    return 0;
+}
+
+int runFilters(GLFWwindow* window, const char* imagePath) {
+    int width, height;
+    unsigned int image = loadImage(imagePath, &width, &height);
+    if (image == 0)
+        return -1;
+    ImageFilters filters(width, height);
+    int filter = -1;  // none
+    bool fragment = false, fWasPressed = false;
+    auto setTitle = [&] {
+        std::string title = std::string(filter < 0 ? "none" : ImageFilters::name((Filter_Type) filter)) + (fragment ? " (fragment)" : " (compute)");
+        glfwSetWindowTitle(window, title.c_str());
+    };
+    setTitle();
+
+    // RENDER LOOP
+    while (!glfwWindowShouldClose(window)) {
+
+        // Key Input
+        handleInput(window);
+        for (int key = GLFW_KEY_0; key <= GLFW_KEY_0 + FILTER_COUNT; key++) {
+            if (glfwGetKey(window, key) == GLFW_PRESS && filter != key - GLFW_KEY_1) {
+                filter = key - GLFW_KEY_1;
+                setTitle();
+            }
+        }
+        bool fPressed = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+        if (fPressed && !fWasPressed) {
+            fragment = !fragment;
+            setTitle();
+        }
+        fWasPressed = fPressed;
+
+        unsigned int shown = image;
+        if (filter >= 0 && fragment)
+            shown = filters.applyFragment((Filter_Type) filter, image);
+        else if (filter >= 0) {
+            shown = filters.applyCompute((Filter_Type) filter, image);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
+        glClear(GL_COLOR_BUFFER_BIT);
+        filters.present(shown);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteTextures(1, &image);
+    return 0;
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
@@ -1,14 +1,18 @@
 #version 430 core
-// a local size of 1 lets us execute a GPU thread for each pixel in our texture
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+// LOCAL_SIZE_X / LOCAL_SIZE_Y are defined by ComputeShader, which dispatches enough workgroups to cover the texture
+layout(local_size_x = LOCAL_SIZE_X, local_size_y = LOCAL_SIZE_Y, local_size_z = 1) in;
 layout(rgba32f, binding = 0) uniform image2D outImage;
 
 void main() {
     vec4 value = vec4(0.0, 0.0, 0.0, 1.0);
     ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(outImage);
+    // the last row and column of workgroups can hang over the edge of the texture
+    if (texelCoord.x >= size.x || texelCoord.y >= size.y)
+        return;
 	
-    value.x = float(texelCoord.x)/(gl_NumWorkGroups.x);
-    value.y = float(texelCoord.y)/(gl_NumWorkGroups.y);
+    value.x = float(texelCoord.x)/(size.x);
+    value.y = float(texelCoord.y)/(size.y);
 	
     imageStore(outImage, texelCoord, value);
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#version 430 core
+// TILE and MAX_BILATERAL_RADIUS are defined by ImageFilters
+layout(local_size_x = TILE, local_size_y = TILE) in;
+layout(binding = 0) uniform sampler2D source;
+layout(binding = 0) writeonly uniform image2D result;
+
+uniform int radius;
+uniform float spatialSigma;
+uniform float rangeSigma;
+
+const int CACHE_SIZE = TILE + 2 * MAX_BILATERAL_RADIUS;
+shared vec4 cache[CACHE_SIZE][CACHE_SIZE];
+
+// Edge preserving blur: neighbours are weighted by distance and by how close their colour is.
+// Every pixel reads (2 * radius + 1)^2 neighbours, so the tile and its apron are cached first
+void main() {
+    ivec2 size = textureSize(source, 0);
+    int span = TILE + 2 * radius;
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE - radius;
+    for (int k = int(gl_LocalInvocationIndex); k < span * span; k += TILE * TILE) {
+        ivec2 offset = ivec2(k % span, k / span);
+        cache[offset.y][offset.x] = texelFetch(source, clamp(origin + offset, ivec2(0), size - 1), 0);
+    }
+    barrier();
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+    ivec2 c = ivec2(gl_LocalInvocationID.xy) + radius;
+    vec4 centre = cache[c.y][c.x];
+    vec4 sum = vec4(0.0);
+    float total = 0.0;
+    for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+            vec4 colour = cache[c.y + y][c.x + x];
+            vec3 difference = colour.rgb - centre.rgb;
+            float weight = exp(-float(x * x + y * y) / (2.0 * spatialSigma * spatialSigma)
+                               - dot(difference, difference) / (2.0 * rangeSigma * rangeSigma));
+            sum += colour * weight;
+            total += weight;
+        }
+    }
+    imageStore(result, texel, sum / total);
+}
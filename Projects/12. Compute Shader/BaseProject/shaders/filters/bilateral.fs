@@ -0,0 +1,28 @@
+#version 430 core
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform int radius;
+uniform float spatialSigma;
+uniform float rangeSigma;
+
+// Edge preserving blur: neighbours are weighted by distance and by how close their colour is
+void main()
+{
+    ivec2 size = textureSize(source, 0);
+    ivec2 c = ivec2(gl_FragCoord.xy);
+    vec4 centre = texelFetch(source, c, 0);
+    vec4 sum = vec4(0.0);
+    float total = 0.0;
+    for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+            vec4 colour = texelFetch(source, clamp(c + ivec2(x, y), ivec2(0), size - 1), 0);
+            vec3 difference = colour.rgb - centre.rgb;
+            float weight = exp(-float(x * x + y * y) / (2.0 * spatialSigma * spatialSigma)
+                               - dot(difference, difference) / (2.0 * rangeSigma * rangeSigma));
+            sum += colour * weight;
+            total += weight;
+        }
+    }
+    FragColor = sum / total;
+}
@@ -0,0 +1,10 @@
+#version 430 core
+out vec2 TexCoord;
+
+// One triangle covering the viewport, no vertex buffer needed
+void main()
+{
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
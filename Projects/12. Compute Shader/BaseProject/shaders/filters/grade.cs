@@ -0,0 +1,26 @@
+#version 430 core
+// TILE is defined by ImageFilters
+layout(local_size_x = TILE, local_size_y = TILE) in;
+layout(binding = 0) uniform sampler2D source;
+layout(binding = 0) writeonly uniform image2D result;
+
+uniform float exposure;    // stops
+uniform float contrast;    // around mid grey, 1 keeps it
+uniform float saturation;  // 0 is grey, 1 keeps it
+uniform vec3 lift;
+uniform vec3 gamma;
+uniform vec3 gain;
+
+// Colour grading. Each pixel only reads itself so there's nothing worth caching in shared memory
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = textureSize(source, 0);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+    vec4 colour = texelFetch(source, texel, 0);
+    vec3 graded = colour.rgb * exp2(exposure);
+    graded = (graded - 0.5) * contrast + 0.5;
+    graded = mix(vec3(dot(graded, vec3(0.2126, 0.7152, 0.0722))), graded, saturation);
+    graded = pow(clamp(gain * (graded + lift * (1.0 - graded)), 0.0, 1.0), 1.0 / gamma);
+    imageStore(result, texel, vec4(graded, colour.a));
+}
@@ -0,0 +1,21 @@
+#version 430 core
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform float exposure;    // stops
+uniform float contrast;    // around mid grey, 1 keeps it
+uniform float saturation;  // 0 is grey, 1 keeps it
+uniform vec3 lift;
+uniform vec3 gamma;
+uniform vec3 gain;
+
+// Colour grading
+void main()
+{
+    vec4 colour = texelFetch(source, ivec2(gl_FragCoord.xy), 0);
+    vec3 graded = colour.rgb * exp2(exposure);
+    graded = (graded - 0.5) * contrast + 0.5;
+    graded = mix(vec3(dot(graded, vec3(0.2126, 0.7152, 0.0722))), graded, saturation);
+    graded = pow(clamp(gain * (graded + lift * (1.0 - graded)), 0.0, 1.0), 1.0 / gamma);
+    FragColor = vec4(graded, colour.a);
+}
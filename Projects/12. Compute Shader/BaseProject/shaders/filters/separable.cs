@@ -0,0 +1,37 @@
+#version 430 core
+// LINE_TILE and MAX_RADIUS are defined by ImageFilters
+layout(local_size_x = LINE_TILE) in;
+layout(binding = 0) uniform sampler2D source;
+layout(binding = 0) writeonly uniform image2D result;
+
+uniform ivec2 direction;  // (1, 0) along rows, (0, 1) along columns
+uniform int radius;
+uniform float weights[MAX_RADIUS + 1];  // centre first, the same either side
+
+shared vec4 cache[LINE_TILE + 2 * MAX_RADIUS];
+
+// One pass of a separable blur (Gaussian or box, it's only the weights). Each workgroup filters
+// LINE_TILE pixels of one row or column. It first caches them plus radius pixels either side (the
+// apron) in shared memory, so each pixel is fetched about once instead of 2 * radius + 1 times
+void main() {
+    ivec2 size = textureSize(source, 0);
+    int extent = direction.x != 0 ? size.x : size.y;
+    int line = int(gl_WorkGroupID.y);
+    int local = int(gl_LocalInvocationID.x);
+    int first = int(gl_WorkGroupID.x) * LINE_TILE;
+
+    // the edges are clamped, like GL_CLAMP_TO_EDGE
+    for (int k = local; k < LINE_TILE + 2 * radius; k += LINE_TILE) {
+        int along = clamp(first - radius + k, 0, extent - 1);
+        cache[k] = texelFetch(source, direction.x != 0 ? ivec2(along, line) : ivec2(line, along), 0);
+    }
+    barrier();
+
+    int along = first + local;
+    if (along >= extent)
+        return;
+    vec4 sum = cache[local + radius] * weights[0];
+    for (int k = 1; k <= radius; k++)
+        sum += (cache[local + radius - k] + cache[local + radius + k]) * weights[k];
+    imageStore(result, direction.x != 0 ? ivec2(along, line) : ivec2(line, along), sum);
+}
@@ -0,0 +1,23 @@
+#version 430 core
+out vec4 FragColor;
+
+const int MAX_RADIUS = 8;  // ImageFilters::MAX_RADIUS
+
+uniform sampler2D source;
+uniform ivec2 direction;  // (1, 0) along rows, (0, 1) along columns
+uniform int radius;
+uniform float weights[MAX_RADIUS + 1];  // centre first, the same either side
+
+// One pass of a separable blur, every tap fetched from the texture
+void main()
+{
+    ivec2 size = textureSize(source, 0);
+    ivec2 centre = ivec2(gl_FragCoord.xy);
+    vec4 sum = texelFetch(source, centre, 0) * weights[0];
+    for (int k = 1; k <= radius; k++) {
+        ivec2 before = clamp(centre - direction * k, ivec2(0), size - 1);
+        ivec2 after = clamp(centre + direction * k, ivec2(0), size - 1);
+        sum += (texelFetch(source, before, 0) + texelFetch(source, after, 0)) * weights[k];
+    }
+    FragColor = sum;
+}
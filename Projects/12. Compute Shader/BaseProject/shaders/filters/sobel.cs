@@ -0,0 +1,31 @@
+#version 430 core
+// TILE is defined by ImageFilters
+layout(local_size_x = TILE, local_size_y = TILE) in;
+layout(binding = 0) uniform sampler2D source;
+layout(binding = 0) writeonly uniform image2D result;
+
+// only the luminance of the tile and a 1 pixel apron around it is needed
+shared float cache[TILE + 2][TILE + 2];
+
+// Sobel edge magnitude of the luminance, in grey
+void main() {
+    ivec2 size = textureSize(source, 0);
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE - 1;
+    int local = int(gl_LocalInvocationIndex);
+    for (int k = local; k < (TILE + 2) * (TILE + 2); k += TILE * TILE) {
+        ivec2 offset = ivec2(k % (TILE + 2), k / (TILE + 2));
+        vec3 colour = texelFetch(source, clamp(origin + offset, ivec2(0), size - 1), 0).rgb;
+        cache[offset.y][offset.x] = dot(colour, vec3(0.2126, 0.7152, 0.0722));
+    }
+    barrier();
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+    ivec2 c = ivec2(gl_LocalInvocationID.xy) + 1;
+    float gx = cache[c.y - 1][c.x + 1] + 2.0 * cache[c.y][c.x + 1] + cache[c.y + 1][c.x + 1]
+             - cache[c.y - 1][c.x - 1] - 2.0 * cache[c.y][c.x - 1] - cache[c.y + 1][c.x - 1];
+    float gy = cache[c.y + 1][c.x - 1] + 2.0 * cache[c.y + 1][c.x] + cache[c.y + 1][c.x + 1]
+             - cache[c.y - 1][c.x - 1] - 2.0 * cache[c.y - 1][c.x] - cache[c.y - 1][c.x + 1];
+    imageStore(result, texel, vec4(vec3(length(vec2(gx, gy))), 1.0));
+}
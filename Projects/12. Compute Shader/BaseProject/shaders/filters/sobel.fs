@@ -0,0 +1,21 @@
+#version 430 core
+out vec4 FragColor;
+
+uniform sampler2D source;
+
+float luminance(ivec2 texel)
+{
+    ivec2 size = textureSize(source, 0);
+    return dot(texelFetch(source, clamp(texel, ivec2(0), size - 1), 0).rgb, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Sobel edge magnitude of the luminance, in grey
+void main()
+{
+    ivec2 c = ivec2(gl_FragCoord.xy);
+    float gx = luminance(c + ivec2(1, -1)) + 2.0 * luminance(c + ivec2(1, 0)) + luminance(c + ivec2(1, 1))
+             - luminance(c + ivec2(-1, -1)) - 2.0 * luminance(c + ivec2(-1, 0)) - luminance(c + ivec2(-1, 1));
+    float gy = luminance(c + ivec2(-1, 1)) + 2.0 * luminance(c + ivec2(0, 1)) + luminance(c + ivec2(1, 1))
+             - luminance(c + ivec2(-1, -1)) - 2.0 * luminance(c + ivec2(0, -1)) - luminance(c + ivec2(1, -1));
+    FragColor = vec4(vec3(length(vec2(gx, gy))), 1.0);
+}
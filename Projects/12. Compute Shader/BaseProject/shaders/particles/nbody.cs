@@ -0,0 +1,48 @@
+#version 430 core
+// WORKGROUP_SIZE is defined by ParticleSystem
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) readonly buffer Current { vec4 current[]; };  // xyz position, w mass
+layout(std430, binding = 1) writeonly buffer Next { vec4 next[]; };
+layout(std430, binding = 2) buffer Velocities { vec4 velocities[]; };
+
+uniform uint count;
+uniform float dt;
+uniform float gravity;
+uniform float softening2;
+
+shared vec4 tile[WORKGROUP_SIZE];
+
+// One body per invocation. The bodies are visited a tile at a time: every invocation of the
+// workgroup loads one body of the tile into shared memory, then all of them read the whole tile
+// from there, so each body is fetched from the buffer once per workgroup instead of once per invocation
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    uint local = gl_LocalInvocationID.x;
+    // invocations past the end still help load tiles
+    vec3 position = current[min(i, count - 1u)].xyz;
+
+    vec3 acceleration = vec3(0.0);
+    for (uint start = 0u; start < count; start += WORKGROUP_SIZE) {
+        uint j = start + local;
+        // massless padding past the end adds nothing
+        tile[local] = j < count ? current[j] : vec4(0.0);
+        barrier();
+
+        for (uint k = 0u; k < WORKGROUP_SIZE; k++) {
+            vec4 other = tile[k];
+            // the body itself is 0 away and adds nothing
+            vec3 r = other.xyz - position;
+            float inverse = inversesqrt(dot(r, r) + softening2);
+            acceleration += other.w * inverse * inverse * inverse * r;
+        }
+        // everyone is done with the tile before it's overwritten
+        barrier();
+    }
+
+    if (i >= count)
+        return;
+    // semi-implicit Euler, the same as CpuParticles
+    vec3 velocity = velocities[i].xyz + gravity * dt * acceleration;
+    velocities[i] = vec4(velocity, 0.0);
+    next[i] = vec4(position + velocity * dt, current[i].w);
+}
@@ -0,0 +1,10 @@
+#version 430 core
+out vec4 FragColor;
+in vec2 Corner;
+
+void main()
+{
+    // a soft round dot, drawn additively so dense regions glow
+    float falloff = max(0.0, 1.0 - dot(Corner, Corner));
+    FragColor = vec4(vec3(1.0, 0.7, 0.4) * falloff * falloff * 0.5, 1.0);
+}
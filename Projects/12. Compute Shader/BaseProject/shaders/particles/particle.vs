@@ -0,0 +1,20 @@
+#version 430 core
+// Positions come straight from the simulation's storage buffer, one instance per body
+layout(std430, binding = 0) readonly buffer Positions { vec4 positions[]; };
+
+uniform mat4 viewProjection;
+uniform float size;
+
+out vec2 Corner;
+
+// two triangles, no vertex buffer needed
+const vec2 CORNERS[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    Corner = CORNERS[gl_VertexID];
+    vec4 centre = viewProjection * vec4(positions[gl_InstanceID].xyz, 1.0);
+    // offset in clip space, so the quad faces the camera and shrinks with distance
+    gl_Position = centre + vec4(Corner * size, 0.0, 0.0);
+}
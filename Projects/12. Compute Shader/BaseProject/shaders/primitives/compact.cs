@@ -0,0 +1,29 @@
+#version 430 core
+// WORKGROUP_SIZE is defined by GpuPrimitives
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) readonly buffer Input { uint values[]; };
+layout(std430, binding = 1) buffer Flags { uint flags[]; };         // 1 per kept value, then their exclusive scan
+layout(std430, binding = 2) writeonly buffer Output { uint result[]; };
+layout(std430, binding = 3) writeonly buffer Total { uint total; };
+
+uniform uint count;
+uniform uint threshold;  // values below it are kept
+uniform bool scatter;    // false: write the flags, true: flags hold their scan, move the kept values
+
+// Stream compaction in two dispatches around an exclusive scan of the flags. Grid-stride loops
+// so any count fits in the dispatch limits
+void main() {
+    uint stride = gl_NumWorkGroups.x * WORKGROUP_SIZE;
+    for (uint i = gl_GlobalInvocationID.x; i < count; i += stride) {
+        uint value = values[i];
+        bool keep = value < threshold;
+        if (!scatter) {
+            flags[i] = keep ? 1u : 0u;
+            continue;
+        }
+        if (keep)
+            result[flags[i]] = value;
+        if (i == count - 1u)
+            total = flags[i] + (keep ? 1u : 0u);
+    }
+}
\ No newline at end of file
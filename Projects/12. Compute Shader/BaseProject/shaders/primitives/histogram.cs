@@ -0,0 +1,30 @@
+#version 430 core
+// WORKGROUP_SIZE and MAX_BINS are defined by GpuPrimitives
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) readonly buffer Input { uint values[]; };
+layout(std430, binding = 1) buffer Bins { uint bins[]; };
+
+uniform uint count;
+uniform uint shift;    // value >> shift picks the bin ...
+uniform uint binMask;  // ... masked to the bin count (a power of two)
+
+shared uint localBins[MAX_BINS];
+
+// Every workgroup counts into shared memory first, so the global atomics are one per bin per
+// workgroup instead of one per value
+void main() {
+    uint binCount = binMask + 1u;
+    for (uint bin = gl_LocalInvocationID.x; bin < binCount; bin += WORKGROUP_SIZE)
+        localBins[bin] = 0u;
+    barrier();
+
+    uint stride = gl_NumWorkGroups.x * WORKGROUP_SIZE;
+    for (uint i = gl_GlobalInvocationID.x; i < count; i += stride)
+        atomicAdd(localBins[(values[i] >> shift) & binMask], 1u);
+    barrier();
+
+    for (uint bin = gl_LocalInvocationID.x; bin < binCount; bin += WORKGROUP_SIZE) {
+        if (localBins[bin] != 0u)
+            atomicAdd(bins[bin], localBins[bin]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 430 core
+// WORKGROUP_SIZE is defined by GpuPrimitives
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) readonly buffer Input { uint values[]; };
+layout(std430, binding = 1) writeonly buffer Output { uint sums[]; };
+
+uniform uint count;
+
+shared uint partial[WORKGROUP_SIZE];
+
+// Each workgroup sums 2 * WORKGROUP_SIZE consecutive values into sums[workgroup]
+void main() {
+    uint local = gl_LocalInvocationID.x;
+    uint i = gl_WorkGroupID.x * WORKGROUP_SIZE * 2u + local;
+
+    // the first add happens while loading so no invocation starts out idle, neighbouring
+    // invocations read neighbouring values
+    uint sum = i < count ? values[i] : 0u;
+    if (i + WORKGROUP_SIZE < count)
+        sum += values[i + WORKGROUP_SIZE];
+    partial[local] = sum;
+    barrier();
+
+    // sequential addressing: the active invocations stay packed at the front so whole
+    // subgroups go idle together, and there are no shared memory bank conflicts
+    for (uint stride = WORKGROUP_SIZE / 2u; stride > 0u; stride >>= 1) {
+        if (local < stride)
+            partial[local] += partial[local + stride];
+        barrier();
+    }
+    if (local == 0u)
+        sums[gl_WorkGroupID.x] = partial[0];
+}
\ No newline at end of file
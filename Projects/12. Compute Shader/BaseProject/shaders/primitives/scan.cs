@@ -0,0 +1,62 @@
+#version 430 core
+// WORKGROUP_SIZE is defined by GpuPrimitives
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) readonly buffer Input { uint values[]; };
+layout(std430, binding = 1) writeonly buffer Output { uint result[]; };
+layout(std430, binding = 2) writeonly buffer BlockSums { uint blockSums[]; };
+
+uniform uint count;
+uniform bool inclusive;
+
+// one padding word every 32 keeps the tree's strided accesses off the same shared memory bank
+#define PAD(i) ((i) + ((i) >> 5))
+shared uint temp[PAD(2 * WORKGROUP_SIZE)];
+
+// Work-efficient (Blelloch) scan of 2 * WORKGROUP_SIZE values per workgroup: an up-sweep builds
+// partial sums in place, a down-sweep turns them into an exclusive scan. The block's total goes
+// to blockSums so the blocks can be offset by a scan of the totals.
+void main() {
+    uint local = gl_LocalInvocationID.x;
+    uint base = gl_WorkGroupID.x * 2u * WORKGROUP_SIZE;
+    uint a = local, b = local + WORKGROUP_SIZE;
+    uint valueA = base + a < count ? values[base + a] : 0u;
+    uint valueB = base + b < count ? values[base + b] : 0u;
+    temp[PAD(a)] = valueA;
+    temp[PAD(b)] = valueB;
+
+    uint offset = 1u;
+    for (uint d = WORKGROUP_SIZE; d > 0u; d >>= 1) {
+        barrier();
+        if (local < d) {
+            uint ai = offset * (2u * local + 1u) - 1u;
+            uint bi = offset * (2u * local + 2u) - 1u;
+            temp[PAD(bi)] += temp[PAD(ai)];
+        }
+        offset <<= 1;
+    }
+
+    barrier();
+    if (local == 0u) {
+        uint last = PAD(2u * WORKGROUP_SIZE - 1u);
+        blockSums[gl_WorkGroupID.x] = temp[last];
+        temp[last] = 0u;
+    }
+
+    for (uint d = 1u; d <= WORKGROUP_SIZE; d <<= 1) {
+        offset >>= 1;
+        barrier();
+        if (local < d) {
+            uint ai = offset * (2u * local + 1u) - 1u;
+            uint bi = offset * (2u * local + 2u) - 1u;
+            uint t = temp[PAD(ai)];
+            temp[PAD(ai)] = temp[PAD(bi)];
+            temp[PAD(bi)] += t;
+        }
+    }
+    barrier();
+
+    if (base + a < count)
+        result[base + a] = temp[PAD(a)] + (inclusive ? valueA : 0u);
+    if (base + b < count)
+        result[base + b] = temp[PAD(b)] + (inclusive ? valueB : 0u);
+}
\ No newline at end of file
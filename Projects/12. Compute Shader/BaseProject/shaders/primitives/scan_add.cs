@@ -0,0 +1,17 @@
+#version 430 core
+// WORKGROUP_SIZE is defined by GpuPrimitives
+layout(local_size_x = WORKGROUP_SIZE) in;
+layout(std430, binding = 0) buffer Result { uint result[]; };
+layout(std430, binding = 1) readonly buffer Offsets { uint offsets[]; };
+
+uniform uint count;
+
+// Adds the scanned block totals to every block scan.cs produced, same workgroup layout
+void main() {
+    uint i = gl_WorkGroupID.x * 2u * WORKGROUP_SIZE + gl_LocalInvocationID.x;
+    uint offset = offsets[gl_WorkGroupID.x];
+    if (i < count)
+        result[i] += offset;
+    if (i + WORKGROUP_SIZE < count)
+        result[i + WORKGROUP_SIZE] += offset;
+}
\ No newline at end of file
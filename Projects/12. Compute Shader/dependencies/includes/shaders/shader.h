@@ -96,6 +96,30 @@ public:
             glDeleteShader(geometry);
 
     }
+    // owns the program, so it can be moved but not copied
+    // ------------------------------------------------------------------------
+    ~Shader()
+    {
+        if (ID != 0)
+            glDeleteProgram(ID);
+    }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader&& other) noexcept : ID(other.ID)
+    {
+        other.ID = 0;
+    }
+    Shader& operator=(Shader&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (ID != 0)
+                glDeleteProgram(ID);
+            ID = other.ID;
+            other.ID = 0;
+        }
+        return *this;
+    }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()